@@ -1,13 +1,18 @@
+#include <vtkm/Assert.h>
+
 #include <vtkm/cont/ArrayHandle.h>
 #include <vtkm/cont/ArrayPortalToIterators.h>
 #include <vtkm/cont/DeviceAdapter.h>
 #include <vtkm/cont/StorageBasic.h>
 
+#include <vtkm/cont/internal/ArrayPortalFromIterators.h>
+
 #include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/cont/testing/Testing.h>
 
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 namespace {
@@ -187,6 +192,219 @@ void CheckSafeDataLoad()
   CheckArrayValues(inputArray);
 }
 
+} // anonymous namespace
+
+////
+//// BEGIN-EXAMPLE StorageOwnedBuffer.cxx
+////
+struct StorageTagOwnedBuffer {  };
+
+namespace vtkm {
+namespace cont {
+namespace internal {
+
+// Storage that takes ownership of a buffer allocated elsewhere. The buffer is
+// released with the deleter given when the last reference goes away.
+template<typename T>
+class Storage<T, StorageTagOwnedBuffer>
+{
+public:
+  typedef T ValueType;
+
+  typedef vtkm::cont::internal::ArrayPortalFromIterators<ValueType*>
+      PortalType;
+  typedef vtkm::cont::internal::ArrayPortalFromIterators<const ValueType*>
+      PortalConstType;
+
+  VTKM_CONT
+  Storage() : NumberOfValues(0) {  }
+
+  template<typename Deleter>
+  VTKM_CONT
+  Storage(ValueType *array, vtkm::Id numberOfValues, Deleter deleter)
+    : Buffer(array, deleter), NumberOfValues(numberOfValues) {  }
+
+  VTKM_CONT
+  PortalType GetPortal() {
+    return PortalType(this->Buffer.get(),
+                      this->Buffer.get() + this->NumberOfValues);
+  }
+
+  VTKM_CONT
+  PortalConstType GetPortalConst() const {
+    return PortalConstType(this->Buffer.get(),
+                           this->Buffer.get() + this->NumberOfValues);
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfValues() const { return this->NumberOfValues; }
+
+  VTKM_CONT
+  void Allocate(vtkm::Id numberOfValues) {
+    this->Buffer.reset(new ValueType[static_cast<std::size_t>(numberOfValues)],
+                       std::default_delete<ValueType[]>());
+    this->NumberOfValues = numberOfValues;
+  }
+
+  VTKM_CONT
+  void Shrink(vtkm::Id numberOfValues) {
+    VTKM_ASSERT(numberOfValues <= this->NumberOfValues);
+    this->NumberOfValues = numberOfValues;
+  }
+
+  VTKM_CONT
+  void ReleaseResources() {
+    this->Buffer.reset();
+    this->NumberOfValues = 0;
+  }
+
+private:
+  std::shared_ptr<ValueType> Buffer;
+  vtkm::Id NumberOfValues;
+};
+
+}
+}
+} // namespace vtkm::cont::internal
+////
+//// END-EXAMPLE StorageOwnedBuffer.cxx
+////
+
+namespace {
+
+////
+//// BEGIN-EXAMPLE ArrayHandleMove.cxx
+////
+template<typename T>
+class ArrayHandleOwned
+    : public vtkm::cont::ArrayHandle<T, StorageTagOwnedBuffer>
+{
+private:
+  typedef vtkm::cont::internal::Storage<T, StorageTagOwnedBuffer>
+      StorageType;
+
+public:
+  VTKM_ARRAY_HANDLE_SUBCLASS(
+      ArrayHandleOwned,
+      (ArrayHandleOwned<T>),
+      (vtkm::cont::ArrayHandle<T, StorageTagOwnedBuffer>));
+
+  template<typename Deleter>
+  VTKM_CONT
+  ArrayHandleOwned(T *array, vtkm::Id numberOfValues, Deleter deleter)
+    : Superclass(StorageType(array, numberOfValues, deleter)) {  }
+};
+
+// Deletes the std::vector that a moved buffer came from.
+template<typename T>
+struct MovedVectorDeleter
+{
+  std::vector<T> *Vector;
+
+  VTKM_CONT
+  MovedVectorDeleter(std::vector<T> *vector) : Vector(vector) {  }
+
+  VTKM_CONT
+  void operator()(T *) const { delete this->Vector; }
+};
+
+// Takes ownership of the given array, which is freed with deleter.
+template<typename T, typename Deleter>
+VTKM_CONT
+ArrayHandleOwned<T>
+make_ArrayHandleAdopt(T *array, vtkm::Id numberOfValues, Deleter deleter)
+{
+  return ArrayHandleOwned<T>(array, numberOfValues, deleter);
+}
+
+// Takes ownership of the memory in the vector without copying it.
+template<typename T>
+VTKM_CONT
+ArrayHandleOwned<T> make_ArrayHandleMove(std::vector<T> &&vector)
+{
+  std::vector<T> *ownedVector = new std::vector<T>(std::move(vector));
+  return ArrayHandleOwned<T>(ownedVector->data(),
+                             static_cast<vtkm::Id>(ownedVector->size()),
+                             MovedVectorDeleter<T>(ownedVector));
+}
+////
+//// END-EXAMPLE ArrayHandleMove.cxx
+////
+
+////
+//// BEGIN-EXAMPLE MoveDataLoad.cxx
+////
+VTKM_CONT
+ArrayHandleOwned<vtkm::Float32> MoveDataLoad()
+{
+  std::vector<vtkm::Float32> dataBuffer;
+  // Populate dataBuffer with meaningful data. Perhaps read data from a file.
+  //// PAUSE-EXAMPLE
+  dataBuffer.resize(50);
+  for (vtkm::Id index = 0; index < 50; index++)
+  {
+    dataBuffer[index] = TestValue(index);
+  }
+  //// RESUME-EXAMPLE
+
+  // The array handle takes the memory of dataBuffer, which is left empty. No
+  // data are copied.
+  return make_ArrayHandleMove(std::move(dataBuffer));
+  // This is safe.
+}
+////
+//// END-EXAMPLE MoveDataLoad.cxx
+////
+
+struct CountingDeleter
+{
+  vtkm::IdComponent *Count;
+
+  CountingDeleter(vtkm::IdComponent *count) : Count(count) {  }
+
+  void operator()(vtkm::Float32 *array) const
+  {
+    delete[] array;
+    (*this->Count)++;
+  }
+};
+
+void CheckOwnedArrays()
+{
+  ArrayHandleOwned<vtkm::Float32> movedArray = MoveDataLoad();
+  vtkm::cont::ArrayHandle<vtkm::Float32> copiedArray;
+  vtkm::cont::DeviceAdapterAlgorithm<VTKM_DEFAULT_DEVICE_ADAPTER_TAG>::Copy(
+        movedArray, copiedArray);
+  CheckArrayValues(copiedArray);
+
+  // Check that moving does not copy the buffer.
+  std::vector<vtkm::Float32> buffer(50);
+  const vtkm::Float32 *bufferPointer = buffer.data();
+  ArrayHandleOwned<vtkm::Float32> noCopyArray =
+      make_ArrayHandleMove(std::move(buffer));
+  VTKM_TEST_ASSERT(
+        noCopyArray.GetPortalConstControl().GetIteratorBegin() == bufferPointer,
+        "Vector memory was copied.");
+
+  // Check that an adopted buffer is deleted once and only once.
+  vtkm::IdComponent deleteCount = 0;
+  {
+    vtkm::Float32 *rawBuffer = new vtkm::Float32[50];
+    for (vtkm::Id index = 0; index < 50; index++)
+    {
+      rawBuffer[index] = TestValue(index);
+    }
+    ArrayHandleOwned<vtkm::Float32> adoptedArray =
+        make_ArrayHandleAdopt(rawBuffer, 50, CountingDeleter(&deleteCount));
+    ArrayHandleOwned<vtkm::Float32> sharedArray = adoptedArray;
+    vtkm::cont::DeviceAdapterAlgorithm<VTKM_DEFAULT_DEVICE_ADAPTER_TAG>::Copy(
+          sharedArray, copiedArray);
+    CheckArrayValues(copiedArray);
+    VTKM_TEST_ASSERT(deleteCount == 0, "Buffer deleted too soon.");
+  }
+  VTKM_TEST_ASSERT(deleteCount == 1, "Buffer not deleted exactly once.");
+}
+
 ////
 //// BEGIN-EXAMPLE SimpleArrayPortal.cxx
 ////
@@ -368,6 +586,203 @@ void TestExecutionPortalsExample()
   CheckArrayValues(outputArray, 2);
 }
 
+////
+//// BEGIN-EXAMPLE CopyOnWriteArray.cxx
+////
+// Shares an ArrayHandle between shallow copies until one of them asks to write
+// to it. The writer then gets its own deep copy.
+template<typename T>
+class CopyOnWriteArray
+{
+public:
+  typedef vtkm::cont::ArrayHandle<T> ArrayHandleType;
+  typedef typename ArrayHandleType::PortalControl PortalControl;
+  typedef typename ArrayHandleType::PortalConstControl PortalConstControl;
+
+  template<typename Device>
+  struct ExecutionTypes
+  {
+    typedef typename ArrayHandleType::
+        template ExecutionTypes<Device>::Portal Portal;
+    typedef typename ArrayHandleType::
+        template ExecutionTypes<Device>::PortalConst PortalConst;
+  };
+
+  VTKM_CONT
+  CopyOnWriteArray() : Array(new ArrayHandleType), External(false) {  }
+
+  // The wrapped handle still belongs to the caller, so it counts as shared
+  // until the first write gives this wrapper its own copy.
+  VTKM_CONT
+  CopyOnWriteArray(const ArrayHandleType &array)
+    : Array(new ArrayHandleType(array)), External(true) {  }
+
+  // Returns an array that shares this array's buffer. No data are copied.
+  VTKM_CONT
+  CopyOnWriteArray ShallowCopy() const { return *this; }
+
+  VTKM_CONT
+  bool IsShared() const
+  {
+    return this->External || (this->Array.use_count() > 1);
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfValues() const
+  {
+    return this->Array->GetNumberOfValues();
+  }
+
+  // Read access never copies.
+  VTKM_CONT
+  const ArrayHandleType &GetReadArray() const { return *this->Array; }
+
+  VTKM_CONT
+  PortalConstControl GetPortalConstControl() const
+  {
+    return this->Array->GetPortalConstControl();
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  typename ExecutionTypes<Device>::PortalConst PrepareForInput(Device) const
+  {
+    return this->Array->PrepareForInput(Device());
+  }
+
+  // Write access makes a deep copy first if the buffer is shared.
+  VTKM_CONT
+  PortalControl GetPortalControl()
+  {
+    this->Detach(VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+    return this->Array->GetPortalControl();
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  typename ExecutionTypes<Device>::Portal PrepareForInPlace(Device)
+  {
+    this->Detach(Device());
+    return this->Array->PrepareForInPlace(Device());
+  }
+
+  // Output overwrites everything, so a shared buffer is dropped, not copied.
+  template<typename Device>
+  VTKM_CONT
+  typename ExecutionTypes<Device>::Portal
+  PrepareForOutput(vtkm::Id numberOfValues, Device)
+  {
+    if (this->IsShared())
+    {
+      this->Array.reset(new ArrayHandleType);
+      this->External = false;
+    }
+    return this->Array->PrepareForOutput(numberOfValues, Device());
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  ArrayHandleType &GetWriteArray(Device)
+  {
+    this->Detach(Device());
+    return *this->Array;
+  }
+
+private:
+  template<typename Device>
+  VTKM_CONT
+  void Detach(Device)
+  {
+    if (this->IsShared())
+    {
+      std::shared_ptr<ArrayHandleType> copy(new ArrayHandleType);
+      vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(*this->Array, *copy);
+      this->Array = copy;
+      this->External = false;
+    }
+  }
+
+  std::shared_ptr<ArrayHandleType> Array;
+  bool External;
+};
+////
+//// END-EXAMPLE CopyOnWriteArray.cxx
+////
+
+template<typename T, typename Device>
+struct ScaleInPlaceFunctor : public vtkm::exec::FunctorBase
+{
+  typedef typename CopyOnWriteArray<T>::
+      template ExecutionTypes<Device>::Portal PortalType;
+
+  PortalType Portal;
+  T Factor;
+
+  VTKM_CONT
+  ScaleInPlaceFunctor(const PortalType &portal, T factor)
+    : Portal(portal), Factor(factor) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id index) const
+  {
+    this->Portal.Set(index, this->Factor*this->Portal.Get(index));
+  }
+};
+
+void TestCopyOnWrite()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  ////
+  //// BEGIN-EXAMPLE UsingCopyOnWriteArray.cxx
+  ////
+  CopyOnWriteArray<vtkm::Float32> inputField(SafeDataLoad());
+
+  // Passing a field through to a later stage shares the buffer.
+  CopyOnWriteArray<vtkm::Float32> passedField = inputField.ShallowCopy();
+  //// PAUSE-EXAMPLE
+  VTKM_TEST_ASSERT(passedField.IsShared(), "Shallow copy not shared.");
+  //// RESUME-EXAMPLE
+
+  // The first write to the shared buffer makes a private copy, so inputField
+  // is unchanged.
+  ScaleInPlaceFunctor<vtkm::Float32, Device> functor(
+        passedField.PrepareForInPlace(Device()), 2.0f);
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(
+        functor, passedField.GetNumberOfValues());
+  ////
+  //// END-EXAMPLE UsingCopyOnWriteArray.cxx
+  ////
+
+  VTKM_TEST_ASSERT(!passedField.IsShared(), "Write did not detach array.");
+  CheckArrayValues(inputField.GetReadArray());
+  CheckArrayValues(passedField.GetReadArray(), 2);
+
+  // Writing through a wrapped ArrayHandle does not change the caller's array.
+  vtkm::cont::ArrayHandle<vtkm::Float32> externalArray = SafeDataLoad();
+  CopyOnWriteArray<vtkm::Float32> wrappedField(externalArray);
+  VTKM_TEST_ASSERT(wrappedField.IsShared(), "Wrapped array not shared.");
+  wrappedField.GetPortalControl().Set(0, 5.0f);
+  VTKM_TEST_ASSERT(!wrappedField.IsShared(), "Write did not detach array.");
+  VTKM_TEST_ASSERT(wrappedField.GetPortalConstControl().Get(0) == 5.0f,
+                   "Write through wrapper lost.");
+  CheckArrayValues(externalArray);
+
+  // Writing to an array that is not shared does not copy.
+  vtkm::cont::ArrayHandle<vtkm::Float32> writeArray =
+      passedField.GetWriteArray(Device());
+  passedField.GetPortalControl().Set(0, 5.0f);
+  VTKM_TEST_ASSERT(writeArray.GetPortalConstControl().Get(0) == 5.0f,
+                   "Unshared array was copied.");
+
+  // Output to a shared array does not disturb the other copy.
+  CopyOnWriteArray<vtkm::Float32> outputField = inputField.ShallowCopy();
+  outputField.PrepareForOutput(10, Device());
+  VTKM_TEST_ASSERT(outputField.GetNumberOfValues() == 10,
+                   "Output array wrong size.");
+  CheckArrayValues(inputField.GetReadArray());
+}
+
 void Test()
 {
   BasicConstruction();
@@ -375,9 +790,11 @@ void Test()
   ArrayHandleFromVector();
   AllocateAndFillArrayHandle();
   CheckSafeDataLoad();
+  CheckOwnedArrays();
   TestArrayPortalVectors();
   TestControlPortalsExample();
   TestExecutionPortalsExample();
+  TestCopyOnWrite();
 }
 
 } // anonymous namespace
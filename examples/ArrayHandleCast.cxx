@@ -1,4 +1,8 @@
 #include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayHandleIndex.h>
+#include <vtkm/cont/DeviceAdapter.h>
+
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vector>
 
@@ -56,6 +60,141 @@ void Foo(const std::vector<T> &inputData)
         );
 }
 
+////
+//// BEGIN-EXAMPLE CopyCastArray.cxx
+////
+template<typename InPortalType, typename OutPortalType>
+struct ConvertChunkFunctor : public vtkm::exec::FunctorBase
+{
+  typedef typename OutPortalType::ValueType OutValueType;
+
+  // Each invocation converts a contiguous chunk of values. The tight loop
+  // over a contiguous range lets the compiler turn the casts into vector
+  // conversion instructions.
+  static const vtkm::Id CHUNK_SIZE = 1024;
+
+  InPortalType InPortal;
+  OutPortalType OutPortal;
+
+  VTKM_CONT
+  ConvertChunkFunctor(const InPortalType &inPortal,
+                      const OutPortalType &outPortal)
+    : InPortal(inPortal), OutPortal(outPortal) {  }
+
+  VTKM_CONT
+  static vtkm::Id GetNumberOfChunks(vtkm::Id numValues)
+  {
+    return (numValues + CHUNK_SIZE - 1)/CHUNK_SIZE;
+  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id chunkIndex) const
+  {
+    vtkm::Id begin = chunkIndex*CHUNK_SIZE;
+    vtkm::Id end = begin + CHUNK_SIZE;
+    if (end > this->InPortal.GetNumberOfValues())
+    {
+      end = this->InPortal.GetNumberOfValues();
+    }
+    for (vtkm::Id index = begin; index < end; index++)
+    {
+      this->OutPortal.Set(
+            index, static_cast<OutValueType>(this->InPortal.Get(index)));
+    }
+  }
+};
+
+// Generic version falls back to a regular copy through the array portals.
+template<typename T, typename InArrayHandleType, typename Device>
+VTKM_CONT
+void CopyCast(const InArrayHandleType &source,
+              vtkm::cont::ArrayHandle<T> &destination,
+              Device)
+{
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(source, destination);
+}
+
+// Specialized version for a cast of a basic array converts directly from the
+// original values in chunks.
+template<typename T, typename SourceT, typename Device>
+VTKM_CONT
+void CopyCast(
+    const vtkm::cont::ArrayHandleCast<T, vtkm::cont::ArrayHandle<SourceT> >
+      &source,
+    vtkm::cont::ArrayHandle<T> &destination,
+    Device)
+{
+  vtkm::cont::ArrayHandle<SourceT> originalArray =
+      source.GetStorage().GetArray();
+  vtkm::Id numValues = originalArray.GetNumberOfValues();
+
+  typedef typename vtkm::cont::ArrayHandle<SourceT>::
+      template ExecutionTypes<Device>::PortalConst InPortalType;
+  typedef typename vtkm::cont::ArrayHandle<T>::
+      template ExecutionTypes<Device>::Portal OutPortalType;
+  typedef ConvertChunkFunctor<InPortalType, OutPortalType> FunctorType;
+
+  FunctorType functor(originalArray.PrepareForInput(Device()),
+                      destination.PrepareForOutput(numValues, Device()));
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(
+        functor, FunctorType::GetNumberOfChunks(numValues));
+}
+////
+//// END-EXAMPLE CopyCastArray.cxx
+////
+
+void TryCopyCast()
+{
+  std::cout << "Trying copy of cast array." << std::endl;
+
+  // Use enough values to span several chunks, including a partial one.
+  const vtkm::Id ARRAY_SIZE = 5000;
+  std::vector<vtkm::Float32> inputData(static_cast<std::size_t>(ARRAY_SIZE));
+  for (vtkm::Id index = 0; index < ARRAY_SIZE; index++)
+  {
+    inputData[static_cast<std::size_t>(index)] =
+        TestValue(index, vtkm::Float32());
+  }
+
+  ////
+  //// BEGIN-EXAMPLE UsingCopyCast.cxx
+  ////
+  vtkm::cont::ArrayHandle<vtkm::Float32> singleArray =
+      vtkm::cont::make_ArrayHandle(inputData);
+
+  vtkm::cont::ArrayHandle<vtkm::Float64> doubleArray;
+  CopyCast(vtkm::cont::make_ArrayHandleCast<vtkm::Float64>(singleArray),
+           doubleArray,
+           VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+  ////
+  //// END-EXAMPLE UsingCopyCast.cxx
+  ////
+
+  VTKM_TEST_ASSERT(doubleArray.GetNumberOfValues() == ARRAY_SIZE,
+                   "Converted array has wrong size.");
+  vtkm::cont::ArrayHandle<vtkm::Float64>::PortalConstControl doublePortal =
+      doubleArray.GetPortalConstControl();
+  for (vtkm::Id index = 0; index < ARRAY_SIZE; index++)
+  {
+    VTKM_TEST_ASSERT(
+          doublePortal.Get(index) ==
+            static_cast<vtkm::Float64>(TestValue(index, vtkm::Float32())),
+          "Converted array has wrong value.");
+  }
+
+  // Casts of arrays that are not basic go through the generic version.
+  vtkm::cont::ArrayHandle<vtkm::Float64> genericArray;
+  CopyCast(vtkm::cont::make_ArrayHandleCast<vtkm::Float64>(
+             vtkm::cont::ArrayHandleIndex(ARRAY_SIZE)),
+           genericArray,
+           VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+  VTKM_TEST_ASSERT(genericArray.GetNumberOfValues() == ARRAY_SIZE,
+                   "Copied array has wrong size.");
+  VTKM_TEST_ASSERT(test_equal(genericArray.GetPortalConstControl().Get(7),
+                              7.0),
+                   "Copied array has wrong value.");
+}
+
 void Test()
 {
   const std::size_t ARRAY_SIZE = 50;
@@ -66,6 +205,8 @@ void Test()
   }
 
   Foo(inputData);
+
+  TryCopyCast();
 }
 
 } // anonymous namespace
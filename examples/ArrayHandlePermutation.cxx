@@ -1,4 +1,8 @@
 #include <vtkm/cont/ArrayHandlePermutation.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/ErrorBadValue.h>
+
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/cont/testing/Testing.h>
 
@@ -46,6 +50,318 @@ void CheckArray2(const ArrayHandleType array)
                    "Permuted array has wrong value.");
 }
 
+////
+//// BEGIN-EXAMPLE CheckPermutationIndexOrder.cxx
+////
+enum PermutationIndexOrder
+{
+  PERMUTATION_INDICES_CONTIGUOUS,
+  PERMUTATION_INDICES_SORTED,
+  PERMUTATION_INDICES_UNSORTED
+};
+
+template<typename IndexPortalType, typename FlagPortalType>
+struct CheckIndexOrderFunctor : public vtkm::exec::FunctorBase
+{
+  IndexPortalType Indices;
+  FlagPortalType Flags;
+
+  VTKM_CONT
+  CheckIndexOrderFunctor(const IndexPortalType &indices,
+                         const FlagPortalType &flags)
+    : Indices(indices), Flags(flags) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id index) const
+  {
+    // Component 0 flags a step backward. Component 1 flags any step that is
+    // not exactly one.
+    vtkm::Id step = this->Indices.Get(index+1) - this->Indices.Get(index);
+    this->Flags.Set(index, vtkm::Id2((step < 0) ? 1 : 0, (step != 1) ? 1 : 0));
+  }
+};
+
+template<typename IndexArrayType, typename Device>
+VTKM_CONT
+PermutationIndexOrder
+GetPermutationIndexOrder(const IndexArrayType &indexArray, Device)
+{
+  typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+
+  vtkm::Id numIndices = indexArray.GetNumberOfValues();
+  if (numIndices < 2)
+  {
+    return PERMUTATION_INDICES_CONTIGUOUS;
+  }
+
+  typedef typename IndexArrayType::
+      template ExecutionTypes<Device>::PortalConst IndexPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id2>::
+      template ExecutionTypes<Device>::Portal FlagPortalType;
+
+  vtkm::cont::ArrayHandle<vtkm::Id2> flags;
+  CheckIndexOrderFunctor<IndexPortalType, FlagPortalType> functor(
+        indexArray.PrepareForInput(Device()),
+        flags.PrepareForOutput(numIndices-1, Device()));
+  Algorithm::Schedule(functor, numIndices-1);
+
+  vtkm::Id2 flagCounts = Algorithm::Reduce(flags, vtkm::Id2(0, 0));
+  if (flagCounts[1] == 0)
+  {
+    return PERMUTATION_INDICES_CONTIGUOUS;
+  }
+  else if (flagCounts[0] == 0)
+  {
+    return PERMUTATION_INDICES_SORTED;
+  }
+  else
+  {
+    return PERMUTATION_INDICES_UNSORTED;
+  }
+}
+////
+//// END-EXAMPLE CheckPermutationIndexOrder.cxx
+////
+
+////
+//// BEGIN-EXAMPLE CachedPermutation.cxx
+////
+template<typename IndexArrayType, typename ValueArrayType>
+class CachedPermutation
+{
+public:
+  typedef typename ValueArrayType::ValueType ValueType;
+  typedef vtkm::cont::ArrayHandle<ValueType> DenseArrayType;
+
+  VTKM_CONT
+  CachedPermutation(const IndexArrayType &indexArray,
+                    const ValueArrayType &valueArray)
+    : IndexArray(indexArray),
+      ValueArray(valueArray),
+      IndexOrder(PERMUTATION_INDICES_UNSORTED),
+      Valid(false),
+      NumberOfMaterializations(0)
+  {  }
+
+  // Replacing either array invalidates the cached copy.
+  VTKM_CONT
+  void SetIndexArray(const IndexArrayType &indexArray)
+  {
+    if (indexArray != this->IndexArray)
+    {
+      this->IndexArray = indexArray;
+      this->Modified();
+    }
+  }
+
+  VTKM_CONT
+  void SetValueArray(const ValueArrayType &valueArray)
+  {
+    if (valueArray != this->ValueArray)
+    {
+      this->ValueArray = valueArray;
+      this->Modified();
+    }
+  }
+
+  // Array handles do not report when their contents are written, so call
+  // this after changing the values of either array in place.
+  VTKM_CONT
+  void Modified() { this->Valid = false; }
+
+  VTKM_CONT
+  vtkm::cont::ArrayHandlePermutation<IndexArrayType,ValueArrayType>
+  GetPermutation() const
+  {
+    return vtkm::cont::make_ArrayHandlePermutation(this->IndexArray,
+                                                   this->ValueArray);
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  const DenseArrayType &GetDenseArray(Device)
+  {
+    if (!this->Valid)
+    {
+      this->Materialize(Device());
+    }
+    return this->DenseArray;
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  PermutationIndexOrder GetIndexOrder(Device)
+  {
+    if (!this->Valid)
+    {
+      this->Materialize(Device());
+    }
+    return this->IndexOrder;
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfMaterializations() const
+  {
+    return this->NumberOfMaterializations;
+  }
+
+private:
+  template<typename Device>
+  VTKM_CONT
+  void Materialize(Device)
+  {
+    typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+
+    this->IndexOrder = GetPermutationIndexOrder(this->IndexArray, Device());
+    vtkm::Id numValues = this->IndexArray.GetNumberOfValues();
+    if ((this->IndexOrder == PERMUTATION_INDICES_CONTIGUOUS) &&
+        (numValues > 0))
+    {
+      // The permutation is a window of the values. Copy it as a stream with
+      // no gather at all.
+      // CopySubRange quietly shortens a range that runs past the end of the
+      // values, so check the end here.
+      vtkm::Id firstIndex = this->IndexArray.GetPortalConstControl().Get(0);
+      this->DenseArray.Allocate(numValues);
+      if ((firstIndex + numValues > this->ValueArray.GetNumberOfValues()) ||
+          !Algorithm::CopySubRange(
+            this->ValueArray, firstIndex, numValues, this->DenseArray))
+      {
+        throw vtkm::cont::ErrorBadValue("Permutation index out of range.");
+      }
+    }
+    else
+    {
+      // Sorted indices gather with a forward stride that hardware prefetching
+      // handles well. Unsorted indices pay for random access, but only once.
+      Algorithm::Copy(this->GetPermutation(), this->DenseArray);
+    }
+    this->Valid = true;
+    this->NumberOfMaterializations++;
+  }
+
+  IndexArrayType IndexArray;
+  ValueArrayType ValueArray;
+  DenseArrayType DenseArray;
+  PermutationIndexOrder IndexOrder;
+  bool Valid;
+  vtkm::Id NumberOfMaterializations;
+};
+////
+//// END-EXAMPLE CachedPermutation.cxx
+////
+
+template<typename ArrayHandleType>
+void CheckDenseArray(const ArrayHandleType &denseArray,
+                     const vtkm::cont::ArrayHandle<vtkm::Id> &indexArray)
+{
+  typedef typename ArrayHandleType::ValueType ValueType;
+
+  VTKM_TEST_ASSERT(
+        denseArray.GetNumberOfValues() == indexArray.GetNumberOfValues(),
+        "Dense array has wrong size.");
+  for (vtkm::Id index = 0; index < denseArray.GetNumberOfValues(); index++)
+  {
+    vtkm::Id sourceIndex = indexArray.GetPortalConstControl().Get(index);
+    VTKM_TEST_ASSERT(test_equal(denseArray.GetPortalConstControl().Get(index),
+                                TestValue(sourceIndex, ValueType())),
+                     "Dense array has wrong value.");
+  }
+}
+
+void TryCachedPermutation()
+{
+  std::cout << "Trying cached permutation." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  typedef vtkm::cont::ArrayHandle<vtkm::Id> IdArrayType;
+  typedef vtkm::cont::ArrayHandle<vtkm::Float64> ValueArrayType;
+
+  const vtkm::Id NUM_VALUES = 100;
+  ValueArrayType valueArray;
+  valueArray.Allocate(NUM_VALUES);
+  for (vtkm::Id index = 0; index < NUM_VALUES; index++)
+  {
+    valueArray.GetPortalControl().Set(index, TestValue(index, vtkm::Float64()));
+  }
+
+  const vtkm::Id NUM_INDICES = 20;
+  IdArrayType contiguousIndices;
+  IdArrayType sortedIndices;
+  IdArrayType unsortedIndices;
+  contiguousIndices.Allocate(NUM_INDICES);
+  sortedIndices.Allocate(NUM_INDICES);
+  unsortedIndices.Allocate(NUM_INDICES);
+  for (vtkm::Id index = 0; index < NUM_INDICES; index++)
+  {
+    contiguousIndices.GetPortalControl().Set(index, index + 10);
+    sortedIndices.GetPortalControl().Set(index, (3*index)/2);
+    unsortedIndices.GetPortalControl().Set(index, (7*index) % NUM_VALUES);
+  }
+
+  CachedPermutation<IdArrayType,ValueArrayType>
+      cache(contiguousIndices, valueArray);
+  VTKM_TEST_ASSERT(cache.GetIndexOrder(Device()) ==
+                     PERMUTATION_INDICES_CONTIGUOUS,
+                   "Wrong index order.");
+  CheckDenseArray(cache.GetDenseArray(Device()), contiguousIndices);
+
+  // Getting the array again should not compute it again.
+  CheckDenseArray(cache.GetDenseArray(Device()), contiguousIndices);
+  VTKM_TEST_ASSERT(cache.GetNumberOfMaterializations() == 1,
+                   "Permutation not cached.");
+
+  cache.SetIndexArray(sortedIndices);
+  VTKM_TEST_ASSERT(cache.GetIndexOrder(Device()) ==
+                     PERMUTATION_INDICES_SORTED,
+                   "Wrong index order.");
+  CheckDenseArray(cache.GetDenseArray(Device()), sortedIndices);
+  VTKM_TEST_ASSERT(cache.GetNumberOfMaterializations() == 2,
+                   "Permutation not updated.");
+
+  cache.SetIndexArray(unsortedIndices);
+  VTKM_TEST_ASSERT(cache.GetIndexOrder(Device()) ==
+                     PERMUTATION_INDICES_UNSORTED,
+                   "Wrong index order.");
+  CheckDenseArray(cache.GetDenseArray(Device()), unsortedIndices);
+
+  // Setting the same array should keep the cache.
+  cache.SetValueArray(valueArray);
+  cache.GetDenseArray(Device());
+  VTKM_TEST_ASSERT(cache.GetNumberOfMaterializations() == 3,
+                   "Permutation recomputed needlessly.");
+
+  // Changing values in place requires flagging the modification.
+  valueArray.GetPortalControl().Set(0, 0.0);
+  cache.Modified();
+  VTKM_TEST_ASSERT(
+        test_equal(cache.GetDenseArray(Device()).GetPortalConstControl().Get(0),
+                   0.0),
+        "Permutation not updated.");
+  VTKM_TEST_ASSERT(cache.GetNumberOfMaterializations() == 4,
+                   "Permutation not updated.");
+
+  // A contiguous window that runs past the end of the values is an error
+  // rather than a short copy.
+  IdArrayType overrunIndices;
+  overrunIndices.Allocate(NUM_INDICES);
+  for (vtkm::Id index = 0; index < NUM_INDICES; index++)
+  {
+    overrunIndices.GetPortalControl().Set(index, NUM_VALUES - 5 + index);
+  }
+  cache.SetIndexArray(overrunIndices);
+  bool threw = false;
+  try
+  {
+    cache.GetDenseArray(Device());
+  }
+  catch (vtkm::cont::ErrorBadValue &)
+  {
+    threw = true;
+  }
+  VTKM_TEST_ASSERT(threw, "Out of range permutation did not throw.");
+}
+
 void Test()
 {
   ////
@@ -107,6 +423,8 @@ void Test()
   //// END-EXAMPLE MakeArrayHandlePermutation.cxx
   ////
   );
+
+  TryCachedPermutation();
 }
 
 } // anonymous namespace
@@ -0,0 +1,73 @@
+#ifndef vtkm_examples_BenchmarkHelpers_h
+#define vtkm_examples_BenchmarkHelpers_h
+
+// Helpers shared by the examples that time one way of doing something
+// against another. They are not part of any listing.
+
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DataSetBuilderExplicit.h>
+#include <vtkm/cont/Timer.h>
+
+#include <vtkm/CellShape.h>
+
+#include <vector>
+
+namespace benchmark {
+
+// Calls operation once so that its arrays are moved to the device and
+// allocated, then returns the average time of numRepeats more calls.
+template<typename Operation, typename Device>
+VTKM_CONT
+vtkm::Float64 AverageTime(const Operation &operation,
+                          Device,
+                          vtkm::Id numRepeats = 10)
+{
+  operation();
+
+  vtkm::cont::Timer<Device> timer;
+  for (vtkm::Id repeat = 0; repeat < numRepeats; repeat++)
+  {
+    operation();
+  }
+  return timer.GetElapsedTime()/static_cast<vtkm::Float64>(numRepeats);
+}
+
+// Makes a dim by dim grid of squares in the z = 0 plane, each split along its
+// diagonal into a lower right triangle (even cell ids) and an upper left
+// triangle (odd cell ids).
+VTKM_CONT
+inline vtkm::cont::DataSet MakeTriangleGrid(vtkm::Id dim)
+{
+  std::vector<vtkm::Vec<vtkm::Float32,3> > coords;
+  for (vtkm::Id j = 0; j <= dim; ++j)
+  {
+    for (vtkm::Id i = 0; i <= dim; ++i)
+    {
+      coords.push_back(vtkm::make_Vec(static_cast<vtkm::Float32>(i),
+                                      static_cast<vtkm::Float32>(j),
+                                      0.0f));
+    }
+  }
+
+  std::vector<vtkm::Id> connectivity;
+  for (vtkm::Id j = 0; j < dim; ++j)
+  {
+    for (vtkm::Id i = 0; i < dim; ++i)
+    {
+      vtkm::Id corner = j*(dim+1) + i;
+      connectivity.push_back(corner);
+      connectivity.push_back(corner+1);
+      connectivity.push_back(corner+dim+2);
+      connectivity.push_back(corner);
+      connectivity.push_back(corner+dim+2);
+      connectivity.push_back(corner+dim+1);
+    }
+  }
+
+  return vtkm::cont::DataSetBuilderExplicit().Create(
+        coords, vtkm::CellShapeTagTriangle(), 3, connectivity);
+}
+
+} // namespace benchmark
+
+#endif //vtkm_examples_BenchmarkHelpers_h
@@ -1,20 +1,199 @@
+#include "ScatterCountingFused.h"
+
+#include <vtkm/Math.h>
+
 #include <vtkm/exec/CellEdge.h>
 #include <vtkm/exec/CellFace.h>
 
+#include <vtkm/worklet/DispatcherMapField.h>
 #include <vtkm/worklet/DispatcherMapTopology.h>
 #include <vtkm/worklet/ScatterCounting.h>
+#include <vtkm/worklet/WorkletMapField.h>
 #include <vtkm/worklet/WorkletMapTopology.h>
 
 #include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayHandleCounting.h>
 #include <vtkm/cont/ArrayHandleGroupVec.h>
 #include <vtkm/cont/ArrayHandleGroupVecVariable.h>
 #include <vtkm/cont/CellSetSingleType.h>
+#include <vtkm/cont/CellSetStructured.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/ErrorBadValue.h>
+
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/cont/testing/MakeTestDataSet.h>
 #include <vtkm/cont/testing/Testing.h>
 
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
 namespace {
 
+////
+//// BEGIN-EXAMPLE ParallelNumComponentsToOffsets.cxx
+////
+const vtkm::Id OFFSETS_CHUNK_SIZE = 4096;
+
+template<typename CountPortalType, typename ChunkSumPortalType>
+struct OffsetsChunkSumFunctor : public vtkm::exec::FunctorBase
+{
+  CountPortalType Counts;
+  ChunkSumPortalType ChunkSums;
+
+  VTKM_CONT
+  OffsetsChunkSumFunctor(const CountPortalType &counts,
+                         const ChunkSumPortalType &chunkSums)
+    : Counts(counts), ChunkSums(chunkSums) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id chunkIndex) const
+  {
+    vtkm::Id begin = chunkIndex*OFFSETS_CHUNK_SIZE;
+    vtkm::Id end = vtkm::Min(begin + OFFSETS_CHUNK_SIZE,
+                             this->Counts.GetNumberOfValues());
+    vtkm::Id sum = 0;
+    for (vtkm::Id index = begin; index < end; index++)
+    {
+      sum += static_cast<vtkm::Id>(this->Counts.Get(index));
+    }
+    this->ChunkSums.Set(chunkIndex, sum);
+  }
+};
+
+template<typename CountPortalType,
+         typename ChunkOffsetPortalType,
+         typename OffsetPortalType>
+struct OffsetsChunkScanFunctor : public vtkm::exec::FunctorBase
+{
+  CountPortalType Counts;
+  ChunkOffsetPortalType ChunkOffsets;
+  OffsetPortalType Offsets;
+
+  VTKM_CONT
+  OffsetsChunkScanFunctor(const CountPortalType &counts,
+                          const ChunkOffsetPortalType &chunkOffsets,
+                          const OffsetPortalType &offsets)
+    : Counts(counts), ChunkOffsets(chunkOffsets), Offsets(offsets) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id chunkIndex) const
+  {
+    vtkm::Id begin = chunkIndex*OFFSETS_CHUNK_SIZE;
+    vtkm::Id end = vtkm::Min(begin + OFFSETS_CHUNK_SIZE,
+                             this->Offsets.GetNumberOfValues());
+    vtkm::Id runningOffset = this->ChunkOffsets.Get(chunkIndex);
+    for (vtkm::Id index = begin; index < end; index++)
+    {
+      // Read the count before writing the offset so that the counts and
+      // offsets can be the same array.
+      vtkm::Id count = static_cast<vtkm::Id>(this->Counts.Get(index));
+      this->Offsets.Set(index, runningOffset);
+      runningOffset += count;
+    }
+  }
+};
+
+template<typename CountPortalType, typename OffsetPortalType, typename Device>
+VTKM_CONT
+vtkm::Id ScanOffsetChunks(const CountPortalType &countPortal,
+                          const OffsetPortalType &offsetPortal,
+                          vtkm::Id numValues,
+                          Device)
+{
+  typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal ChunkPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::PortalConst ChunkConstPortalType;
+
+  vtkm::Id numChunks =
+      (numValues + OFFSETS_CHUNK_SIZE - 1)/OFFSETS_CHUNK_SIZE;
+
+  // Sum each chunk, then scan the (much smaller) array of chunk sums. The
+  // scan also gives the total number of components.
+  vtkm::cont::ArrayHandle<vtkm::Id> chunkSums;
+  OffsetsChunkSumFunctor<CountPortalType,ChunkPortalType>
+      sumFunctor(countPortal, chunkSums.PrepareForOutput(numChunks, Device()));
+  Algorithm::Schedule(sumFunctor, numChunks);
+
+  vtkm::cont::ArrayHandle<vtkm::Id> chunkOffsets;
+  vtkm::Id totalSize = Algorithm::ScanExclusive(chunkSums, chunkOffsets);
+
+  OffsetsChunkScanFunctor<CountPortalType,ChunkConstPortalType,OffsetPortalType>
+      scanFunctor(countPortal,
+                  chunkOffsets.PrepareForInput(Device()),
+                  offsetPortal);
+  Algorithm::Schedule(scanFunctor, numChunks);
+
+  return totalSize;
+}
+
+// Fills offsets and returns the expected size of the source array.
+template<typename CountArrayType, typename Device>
+VTKM_CONT
+vtkm::Id ParallelNumComponentsToOffsets(const CountArrayType &counts,
+                                        vtkm::cont::ArrayHandle<vtkm::Id> &offsets,
+                                        Device)
+{
+  vtkm::Id numValues = counts.GetNumberOfValues();
+  return ScanOffsetChunks(counts.PrepareForInput(Device()),
+                          offsets.PrepareForOutput(numValues, Device()),
+                          numValues,
+                          Device());
+}
+
+// Replaces an array of counts with the offsets. No second array is
+// allocated.
+template<typename Device>
+VTKM_CONT
+vtkm::Id ParallelNumComponentsToOffsetsInPlace(
+    vtkm::cont::ArrayHandle<vtkm::Id> &countsAndOffsets,
+    Device)
+{
+  typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal portal =
+        countsAndOffsets.PrepareForInPlace(Device());
+  return ScanOffsetChunks(portal,
+                          portal,
+                          countsAndOffsets.GetNumberOfValues(),
+                          Device());
+}
+////
+//// END-EXAMPLE ParallelNumComponentsToOffsets.cxx
+////
+
+////
+//// BEGIN-EXAMPLE BuildGroupVecVariableOutput.cxx
+////
+// Builds the offsets from the counts and allocates the source array with the
+// total size computed in the same pass.
+template<typename ComponentType, typename CountArrayType, typename Device>
+VTKM_CONT
+vtkm::cont::ArrayHandleGroupVecVariable<
+    vtkm::cont::ArrayHandle<ComponentType>,
+    vtkm::cont::ArrayHandle<vtkm::Id> >
+BuildGroupVecVariableOutput(const CountArrayType &counts,
+                            vtkm::cont::ArrayHandle<ComponentType> &components,
+                            vtkm::cont::ArrayHandle<vtkm::Id> &offsets,
+                            Device)
+{
+  vtkm::Id componentsSize =
+      ParallelNumComponentsToOffsets(counts, offsets, Device());
+
+  // Allocate directly in the execution environment, which is where the
+  // components are going to be written.
+  components.PrepareForOutput(componentsSize, Device());
+
+  return vtkm::cont::make_ArrayHandleGroupVecVariable(components, offsets);
+}
+////
+//// END-EXAMPLE BuildGroupVecVariableOutput.cxx
+////
+
 struct ExtractEdges {
   ////
   //// BEGIN-EXAMPLE CellEdge.cxx
@@ -123,6 +302,251 @@ void TryExtractEdges()
                    "Output has wrong number of cells");
 }
 
+////
+//// BEGIN-EXAMPLE ExtractUniqueEdges.cxx
+////
+// Packs the two point indices of an edge into one 64-bit key with the smaller
+// index in the high bits, so every cell sharing an edge produces the same key.
+// An 8-byte key sorts faster and takes half the memory of a pair of Ids. The
+// indices are widened to 64 bits before shifting, so this works whether
+// vtkm::Id is 32 or 64 bits, as long as each index fits in 32 bits.
+VTKM_EXEC_CONT
+vtkm::UInt64 MakeEdgeKey(vtkm::Id point1, vtkm::Id point2)
+{
+  vtkm::UInt64 first = static_cast<vtkm::UInt64>(vtkm::Min(point1, point2));
+  vtkm::UInt64 second = static_cast<vtkm::UInt64>(vtkm::Max(point1, point2));
+  return (first << 32) | second;
+}
+
+struct ExtractUniqueEdges
+{
+  struct EdgesExtractKeys : vtkm::worklet::WorkletMapPointToCell
+  {
+    typedef void ControlSignature(CellSetIn,
+                                  FieldOutCell<> edgeKeys);
+    typedef _2 ExecutionSignature(CellShape, PointIndices, VisitIndex);
+    typedef _1 InputDomain;
+
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
+    VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
+
+    VTKM_CONT
+    EdgesExtractKeys(const ScatterType &scatter)
+      : Scatter(scatter) {  }
+
+    template<typename CellShapeTag, typename PointIndexVecType>
+    VTKM_EXEC
+    vtkm::UInt64 operator()(CellShapeTag shape,
+                            const PointIndexVecType &pointIndices,
+                            vtkm::IdComponent visitIndex) const
+    {
+      vtkm::Vec<vtkm::IdComponent,2> localEdgeIndices =
+          vtkm::exec::CellEdgeLocalIndices(pointIndices.GetNumberOfComponents(),
+                                           visitIndex,
+                                           shape,
+                                           *this);
+      return MakeEdgeKey(pointIndices[localEdgeIndices[0]],
+                         pointIndices[localEdgeIndices[1]]);
+    }
+
+  private:
+    ScatterType Scatter;
+  };
+
+  struct EdgeKeyToIndices : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<> edgeKeys,
+                                  FieldOut<> edgeIndices);
+    typedef void ExecutionSignature(_1, _2);
+    typedef _1 InputDomain;
+
+    template<typename EdgeIndexVecType>
+    VTKM_EXEC
+    void operator()(vtkm::UInt64 edgeKey, EdgeIndexVecType &edgeIndices) const
+    {
+      edgeIndices[0] = static_cast<vtkm::Id>(edgeKey >> 32);
+      edgeIndices[1] = static_cast<vtkm::Id>(edgeKey & 0xFFFFFFFF);
+    }
+  };
+
+  typedef vtkm::cont::ArrayHandleGroupVecVariable<
+      vtkm::cont::ArrayHandle<vtkm::Id>,
+      vtkm::cont::ArrayHandle<vtkm::Id> > CellToEdgeMapType;
+
+  VTKM_CONT
+  ExtractUniqueEdges() : ComputeCellToEdgeMap(false) {  }
+
+  // When on, Run also records, for each input cell, the indices of its edges
+  // in the output cell set.
+  VTKM_CONT
+  void SetComputeCellToEdgeMap(bool flag) { this->ComputeCellToEdgeMap = flag; }
+
+  VTKM_CONT
+  CellToEdgeMapType GetCellToEdgeMap() const
+  {
+    return CellToEdgeMapType(this->CellToEdgeIndices, this->CellToEdgeOffsets);
+  }
+
+  template<typename CellSetInType, typename Device>
+  VTKM_CONT
+  vtkm::cont::CellSetSingleType<>
+  Run(const CellSetInType &cellSetIn, Device)
+  {
+    typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+
+    // Compare as 64-bit values. Shifting a 32-bit vtkm::Id by 32 overflows.
+    if (static_cast<vtkm::UInt64>(cellSetIn.GetNumberOfPoints()) >
+        (vtkm::UInt64(1) << 32))
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Too many points to pack edges into 64-bit keys.");
+    }
+
+    // Count how many edges each cell has
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> edgeCounts;
+    vtkm::worklet::DispatcherMapTopology<ExtractEdges::EdgesCount,Device>
+        countDispatcher;
+    countDispatcher.Invoke(cellSetIn, edgeCounts);
+
+    // Get a key for every edge of every cell
+    vtkm::worklet::ScatterCountingFused scatter(edgeCounts, Device());
+    vtkm::cont::ArrayHandle<vtkm::UInt64> cellEdgeKeys;
+    vtkm::worklet::DispatcherMapTopology<EdgesExtractKeys,Device>
+        extractDispatcher(scatter);
+    extractDispatcher.Invoke(cellSetIn, cellEdgeKeys);
+
+    // Sorting brings the copies of each shared edge together so that Unique
+    // can remove them. Sort in place unless the per-cell keys are still
+    // needed for the cell to edge map.
+    vtkm::cont::ArrayHandle<vtkm::UInt64> uniqueEdgeKeys;
+    if (this->ComputeCellToEdgeMap)
+    {
+      Algorithm::Copy(cellEdgeKeys, uniqueEdgeKeys);
+    }
+    else
+    {
+      uniqueEdgeKeys = cellEdgeKeys;
+    }
+    Algorithm::Sort(uniqueEdgeKeys);
+    Algorithm::Unique(uniqueEdgeKeys);
+
+    if (this->ComputeCellToEdgeMap)
+    {
+      // The position of a key in the sorted unique keys is the index of the
+      // edge in the output.
+      Algorithm::LowerBounds(uniqueEdgeKeys,
+                             cellEdgeKeys,
+                             this->CellToEdgeIndices);
+      ParallelNumComponentsToOffsets(edgeCounts,
+                                     this->CellToEdgeOffsets,
+                                     Device());
+    }
+
+    vtkm::cont::ArrayHandle<vtkm::Id> edgeIndices;
+    vtkm::worklet::DispatcherMapField<EdgeKeyToIndices,Device>
+        unpackDispatcher;
+    unpackDispatcher.Invoke(
+          uniqueEdgeKeys,
+          vtkm::cont::make_ArrayHandleGroupVec<2>(edgeIndices));
+
+    // Construct the resulting cell set and return
+    vtkm::cont::CellSetSingleType<> cellSetOut(cellSetIn.GetName());
+    cellSetOut.Fill(cellSetIn.GetNumberOfPoints(),
+                    vtkm::CELL_SHAPE_LINE,
+                    2,
+                    edgeIndices);
+    return cellSetOut;
+  }
+
+private:
+  bool ComputeCellToEdgeMap;
+  vtkm::cont::ArrayHandle<vtkm::Id> CellToEdgeIndices;
+  vtkm::cont::ArrayHandle<vtkm::Id> CellToEdgeOffsets;
+};
+////
+//// END-EXAMPLE ExtractUniqueEdges.cxx
+////
+
+void TryExtractUniqueEdges()
+{
+  std::cout << "Trying extract unique edges." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  vtkm::cont::DataSet dataSet =
+      vtkm::cont::testing::MakeTestDataSet().Make3DExplicitDataSet5();
+  vtkm::cont::CellSetExplicit<> cellSet;
+  dataSet.GetCellSet().CopyTo(cellSet);
+
+  // Find the expected edges by removing duplicates from the per-cell edges.
+  ExtractEdges extractEdges;
+  vtkm::cont::CellSetSingleType<> allEdgeCells =
+      extractEdges.Run(cellSet, Device());
+  std::set<std::pair<vtkm::Id,vtkm::Id> > expectedEdges;
+  for (vtkm::Id cellIndex = 0;
+       cellIndex < allEdgeCells.GetNumberOfCells();
+       cellIndex++)
+  {
+    vtkm::Id2 edge;
+    allEdgeCells.GetIndices(cellIndex, edge);
+    expectedEdges.insert(std::make_pair(vtkm::Min(edge[0], edge[1]),
+                                        vtkm::Max(edge[0], edge[1])));
+  }
+
+  ExtractUniqueEdges extractUniqueEdges;
+  extractUniqueEdges.SetComputeCellToEdgeMap(true);
+  vtkm::cont::CellSetSingleType<> edgeCells =
+      extractUniqueEdges.Run(cellSet, Device());
+
+  VTKM_TEST_ASSERT(edgeCells.GetNumberOfPoints() == 11,
+                   "Output has wrong number of points");
+  VTKM_TEST_ASSERT(edgeCells.GetNumberOfCells() ==
+                   static_cast<vtkm::Id>(expectedEdges.size()),
+                   "Output has wrong number of cells");
+  VTKM_TEST_ASSERT(edgeCells.GetNumberOfCells() < 35,
+                   "Shared edges not removed");
+
+  // Every edge of every cell should map to an output edge with the same
+  // points.
+  ExtractUniqueEdges::CellToEdgeMapType cellToEdges =
+      extractUniqueEdges.GetCellToEdgeMap();
+  VTKM_TEST_ASSERT(cellToEdges.GetNumberOfValues() ==
+                   cellSet.GetNumberOfCells(),
+                   "Cell to edge map has wrong size");
+  vtkm::Id cellEdgeIndex = 0;
+  for (vtkm::Id cellIndex = 0;
+       cellIndex < cellSet.GetNumberOfCells();
+       cellIndex++)
+  {
+    ExtractUniqueEdges::CellToEdgeMapType::PortalConstControl::ValueType
+        cellEdges =
+        cellToEdges.GetPortalConstControl().Get(cellIndex);
+    for (vtkm::IdComponent localIndex = 0;
+         localIndex < cellEdges.GetNumberOfComponents();
+         localIndex++)
+    {
+      vtkm::Id2 edge;
+      edgeCells.GetIndices(cellEdges[localIndex], edge);
+      vtkm::Id2 cellEdge;
+      allEdgeCells.GetIndices(cellEdgeIndex, cellEdge);
+      VTKM_TEST_ASSERT(MakeEdgeKey(edge[0], edge[1]) ==
+                       MakeEdgeKey(cellEdge[0], cellEdge[1]),
+                       "Cell to edge map points to wrong edge");
+      cellEdgeIndex++;
+    }
+  }
+  VTKM_TEST_ASSERT(cellEdgeIndex == 35, "Cell to edge map missing edges");
+
+  // In a grid of hexahedra each interior edge is shared by 4 cells.
+  vtkm::cont::CellSetStructured<3> hexCells("cells");
+  hexCells.SetPointDimensions(vtkm::Id3(11, 11, 11));
+  ExtractUniqueEdges extractHexEdges;
+  vtkm::cont::CellSetSingleType<> hexEdges =
+      extractHexEdges.Run(hexCells, Device());
+  VTKM_TEST_ASSERT(hexEdges.GetNumberOfCells() == 3*10*11*11,
+                   "Wrong number of unique hexahedron edges");
+}
+
 struct ExtractFaces {
   ////
   //// BEGIN-EXAMPLE CellFace.cxx
@@ -151,7 +575,7 @@ struct ExtractFaces {
     typedef void ExecutionSignature(CellShape, VisitIndex, _2, _3);
     typedef _1 InputDomain;
 
-    typedef vtkm::worklet::ScatterCounting ScatterType;
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
     VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
 
     VTKM_CONT
@@ -186,7 +610,7 @@ struct ExtractFaces {
     typedef void ExecutionSignature(CellShape, PointIndices, VisitIndex, _2);
     typedef _1 InputDomain;
 
-    typedef vtkm::worklet::ScatterCounting ScatterType;
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
     VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
 
     VTKM_CONT
@@ -235,8 +659,10 @@ struct ExtractFaces {
     vtkm::worklet::DispatcherMapTopology<FacesCount,Device> countDispatcher;
     countDispatcher.Invoke(cellSetIn, faceCounts);
 
-    // Set up a "scatter" to create an output entry for each face in the input
-    vtkm::worklet::ScatterCounting scatter(faceCounts, Device());
+    // Set up a "scatter" to create an output entry for each face in the input.
+    // The same scatter is used by two dispatchers, and copies of it share its
+    // arrays, so it is only built once.
+    vtkm::worklet::ScatterCountingFused scatter(faceCounts, Device());
 
     // Count how many points each face has. Also get the shape of each face.
     vtkm::cont::ArrayHandle<vtkm::IdComponent> pointsPerFace;
@@ -246,25 +672,22 @@ struct ExtractFaces {
     countPointsDispatcher.Invoke(cellSetIn, pointsPerFace, faceShapes);
 
     // To construct an ArrayHandleGroupVecVariable, we need to convert
-    // pointsPerFace to an array of offsets
-    vtkm::Id faceIndicesSize;
-    vtkm::cont::ArrayHandle<vtkm::Id> faceIndexOffsets =
-        vtkm::cont::ConvertNumComponentsToOffsets(pointsPerFace,
-                                                  faceIndicesSize);
-
-    // We need to preallocate the array for faceIndices (because that is the
-    // way ArrayHandleGroupVecVariable works). We use the value previously
-    // returned from ConvertNumComponentsToOffsets.
+    // pointsPerFace to an array of offsets. We also need to preallocate the
+    // array for faceIndices (because that is the way
+    // ArrayHandleGroupVecVariable works). BuildGroupVecVariableOutput does
+    // both at once.
+    vtkm::cont::ArrayHandle<vtkm::Id> faceIndexOffsets;
     vtkm::cont::ArrayHandle<vtkm::Id> faceIndices;
-    faceIndices.Allocate(faceIndicesSize);
 
     // Get the cell index array for all the faces
     vtkm::worklet::DispatcherMapTopology<FacesExtract,Device>
         extractDispatcher(scatter);
     extractDispatcher.Invoke(
           cellSetIn,
-          vtkm::cont::make_ArrayHandleGroupVecVariable(faceIndices,
-                                                       faceIndexOffsets));
+          BuildGroupVecVariableOutput(pointsPerFace,
+                                      faceIndices,
+                                      faceIndexOffsets,
+                                      Device()));
 
     // Construct the resulting cell set and return
     vtkm::cont::CellSetExplicit<> cellSetOut(cellSetIn.GetName());
@@ -309,10 +732,597 @@ void TryExtractFaces()
                    "Face wrong");
 }
 
+////
+//// BEGIN-EXAMPLE ExtractExternalFaces.cxx
+////
+// Faces in the supported cell shapes have at most 4 points.
+static const vtkm::IdComponent MAX_FACE_POINTS = 4;
+
+// Gets the point indices of a face in ascending order. Unused entries are set
+// to -1 so that two faces match exactly when their arrays are equal.
+template<typename CellShapeTag,
+         typename PointIndexVecType,
+         typename WorkletType>
+VTKM_EXEC
+vtkm::Vec<vtkm::Id,MAX_FACE_POINTS>
+SortedFacePoints(CellShapeTag shape,
+                 const PointIndexVecType &pointIndices,
+                 vtkm::IdComponent faceIndex,
+                 const WorkletType &worklet)
+{
+  vtkm::VecCConst<vtkm::IdComponent> localFaceIndices =
+      vtkm::exec::CellFaceLocalIndices(faceIndex, shape, worklet);
+  vtkm::IdComponent numPoints = localFaceIndices.GetNumberOfComponents();
+  if (numPoints > MAX_FACE_POINTS)
+  {
+    worklet.RaiseError("Face has too many points.");
+    numPoints = MAX_FACE_POINTS;
+  }
+
+  vtkm::Vec<vtkm::Id,MAX_FACE_POINTS> sortedPoints(-1);
+  for (vtkm::IdComponent index = 0; index < numPoints; ++index)
+  {
+    // Insertion sort, which is fastest for a handful of values.
+    vtkm::Id pointIndex = pointIndices[localFaceIndices[index]];
+    vtkm::IdComponent insert = index;
+    while ((insert > 0) && (sortedPoints[insert-1] > pointIndex))
+    {
+      sortedPoints[insert] = sortedPoints[insert-1];
+      --insert;
+    }
+    sortedPoints[insert] = pointIndex;
+  }
+  return sortedPoints;
+}
+
+// FNV-1a hash of the sorted face points.
+VTKM_EXEC_CONT
+vtkm::UInt64 HashFacePoints(const vtkm::Vec<vtkm::Id,MAX_FACE_POINTS> &points)
+{
+  vtkm::UInt64 hash = 14695981039346656037ULL;
+  for (vtkm::IdComponent index = 0; index < MAX_FACE_POINTS; ++index)
+  {
+    hash ^= static_cast<vtkm::UInt64>(points[index]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+struct ExtractExternalFaces
+{
+  struct FaceHashes : vtkm::worklet::WorkletMapPointToCell
+  {
+    typedef void ControlSignature(CellSetIn,
+                                  FieldOutCell<> faceHashes);
+    typedef _2 ExecutionSignature(CellShape, PointIndices, VisitIndex);
+    typedef _1 InputDomain;
+
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
+    VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
+
+    VTKM_CONT
+    FaceHashes(const ScatterType &scatter)
+      : Scatter(scatter) {  }
+
+    template<typename CellShapeTag, typename PointIndexVecType>
+    VTKM_EXEC
+    vtkm::UInt64 operator()(CellShapeTag shape,
+                            const PointIndexVecType &pointIndices,
+                            vtkm::IdComponent visitIndex) const
+    {
+      return HashFacePoints(
+            SortedFacePoints(shape, pointIndices, visitIndex, *this));
+    }
+
+  private:
+    ScatterType Scatter;
+  };
+
+  // After sorting by hash, copies of the same face are next to each other.
+  // A face is external if no other face with the same hash has the same
+  // points. Comparing the points guards against hash collisions.
+  struct FaceIsExternal : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<> sortedIndex,
+                                  WholeArrayIn<> sortedHashes,
+                                  WholeArrayIn<> sortedFaces,
+                                  WholeArrayIn<> faceToCell,
+                                  WholeArrayIn<> faceToLocalFace,
+                                  WholeCellSetIn<> cellSet,
+                                  FieldOut<> isExternal);
+    typedef _7 ExecutionSignature(_1, _2, _3, _4, _5, _6);
+    typedef _1 InputDomain;
+
+    template<typename HashPortalType,
+             typename IdPortalType,
+             typename IdComponentPortalType,
+             typename CellSetType>
+    VTKM_EXEC
+    vtkm::IdComponent operator()(
+        vtkm::Id sortedIndex,
+        const HashPortalType &sortedHashes,
+        const IdPortalType &sortedFaces,
+        const IdPortalType &faceToCell,
+        const IdComponentPortalType &faceToLocalFace,
+        const CellSetType &cellSet) const
+    {
+      vtkm::UInt64 hash = sortedHashes.Get(sortedIndex);
+      vtkm::Vec<vtkm::Id,MAX_FACE_POINTS> points =
+          this->GetFacePoints(sortedFaces.Get(sortedIndex),
+                              faceToCell,
+                              faceToLocalFace,
+                              cellSet);
+
+      vtkm::Id numValues = sortedHashes.GetNumberOfValues();
+      for (vtkm::Id otherIndex = sortedIndex - 1;
+           (otherIndex >= 0) && (sortedHashes.Get(otherIndex) == hash);
+           --otherIndex)
+      {
+        if (points == this->GetFacePoints(sortedFaces.Get(otherIndex),
+                                          faceToCell,
+                                          faceToLocalFace,
+                                          cellSet))
+        {
+          return 0;
+        }
+      }
+      for (vtkm::Id otherIndex = sortedIndex + 1;
+           (otherIndex < numValues) && (sortedHashes.Get(otherIndex) == hash);
+           ++otherIndex)
+      {
+        if (points == this->GetFacePoints(sortedFaces.Get(otherIndex),
+                                          faceToCell,
+                                          faceToLocalFace,
+                                          cellSet))
+        {
+          return 0;
+        }
+      }
+      return 1;
+    }
+
+    template<typename IdPortalType,
+             typename IdComponentPortalType,
+             typename CellSetType>
+    VTKM_EXEC
+    vtkm::Vec<vtkm::Id,MAX_FACE_POINTS>
+    GetFacePoints(vtkm::Id face,
+                  const IdPortalType &faceToCell,
+                  const IdComponentPortalType &faceToLocalFace,
+                  const CellSetType &cellSet) const
+    {
+      vtkm::Id cellIndex = faceToCell.Get(face);
+      return SortedFacePoints(cellSet.GetCellShape(cellIndex),
+                              cellSet.GetIndices(cellIndex),
+                              faceToLocalFace.Get(face),
+                              *this);
+    }
+  };
+
+  struct ExternalFaceCountPoints : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<> face,
+                                  WholeArrayIn<> faceToCell,
+                                  WholeArrayIn<> faceToLocalFace,
+                                  WholeCellSetIn<> cellSet,
+                                  FieldOut<> numPointsInFace,
+                                  FieldOut<> faceShape);
+    typedef void ExecutionSignature(_1, _2, _3, _4, _5, _6);
+    typedef _1 InputDomain;
+
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
+    VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
+
+    VTKM_CONT
+    ExternalFaceCountPoints(const ScatterType &scatter)
+      : Scatter(scatter) {  }
+
+    template<typename IdPortalType,
+             typename IdComponentPortalType,
+             typename CellSetType>
+    VTKM_EXEC
+    void operator()(vtkm::Id face,
+                    const IdPortalType &faceToCell,
+                    const IdComponentPortalType &faceToLocalFace,
+                    const CellSetType &cellSet,
+                    vtkm::IdComponent &numPointsInFace,
+                    vtkm::UInt8 &faceShape) const
+    {
+      numPointsInFace =
+          vtkm::exec::CellFaceNumberOfPoints(
+            faceToLocalFace.Get(face),
+            cellSet.GetCellShape(faceToCell.Get(face)),
+            *this);
+      switch (numPointsInFace)
+      {
+        case 3: faceShape = vtkm::CELL_SHAPE_TRIANGLE; break;
+        case 4: faceShape = vtkm::CELL_SHAPE_QUAD; break;
+        default: faceShape = vtkm::CELL_SHAPE_POLYGON; break;
+      }
+    }
+
+  private:
+    ScatterType Scatter;
+  };
+
+  struct ExternalFaceExtract : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<> face,
+                                  WholeArrayIn<> faceToCell,
+                                  WholeArrayIn<> faceToLocalFace,
+                                  WholeCellSetIn<> cellSet,
+                                  FieldOut<> faceIndices);
+    typedef void ExecutionSignature(_1, _2, _3, _4, _5);
+    typedef _1 InputDomain;
+
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
+    VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
+
+    VTKM_CONT
+    ExternalFaceExtract(const ScatterType &scatter)
+      : Scatter(scatter) {  }
+
+    template<typename IdPortalType,
+             typename IdComponentPortalType,
+             typename CellSetType,
+             typename FaceIndexVecType>
+    VTKM_EXEC
+    void operator()(vtkm::Id face,
+                    const IdPortalType &faceToCell,
+                    const IdComponentPortalType &faceToLocalFace,
+                    const CellSetType &cellSet,
+                    FaceIndexVecType &faceIndices) const
+    {
+      // Take the points in the cell's order so that the face keeps its
+      // outward orientation.
+      vtkm::Id cellIndex = faceToCell.Get(face);
+      typename CellSetType::IndicesType pointIndices =
+          cellSet.GetIndices(cellIndex);
+      vtkm::VecCConst<vtkm::IdComponent> localFaceIndices =
+          vtkm::exec::CellFaceLocalIndices(faceToLocalFace.Get(face),
+                                           cellSet.GetCellShape(cellIndex),
+                                           *this);
+
+      vtkm::IdComponent numPoints = faceIndices.GetNumberOfComponents();
+      for (vtkm::IdComponent localPointIndex = 0;
+           localPointIndex < numPoints;
+           localPointIndex++)
+      {
+        faceIndices[localPointIndex] =
+            pointIndices[localFaceIndices[localPointIndex]];
+      }
+    }
+
+  private:
+    ScatterType Scatter;
+  };
+
+  template<typename CellSetInType, typename Device>
+  VTKM_CONT
+  vtkm::cont::CellSetExplicit<>
+  Run(const CellSetInType &cellSetIn, Device)
+  {
+    typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+
+    // Hash every face of every cell. The scatter arrays record the cell and
+    // local face of each face, so the face points never need to be stored.
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> faceCounts;
+    vtkm::worklet::DispatcherMapTopology<ExtractFaces::FacesCount,Device>
+        countDispatcher;
+    countDispatcher.Invoke(cellSetIn, faceCounts);
+
+    vtkm::worklet::ScatterCountingFused faceScatter(faceCounts, Device());
+    vtkm::cont::ArrayHandle<vtkm::UInt64> faceHashes;
+    vtkm::worklet::DispatcherMapTopology<FaceHashes,Device>
+        hashDispatcher(faceScatter);
+    hashDispatcher.Invoke(cellSetIn, faceHashes);
+
+    vtkm::Id numFaces = faceHashes.GetNumberOfValues();
+    vtkm::cont::ArrayHandle<vtkm::Id> faceToCell =
+        faceScatter.GetOutputToInputMap(numFaces);
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> faceToLocalFace =
+        faceScatter.GetVisitArray(numFaces);
+
+    // Bring matching faces together.
+    vtkm::cont::ArrayHandle<vtkm::Id> sortedFaces;
+    Algorithm::Copy(vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numFaces),
+                    sortedFaces);
+    Algorithm::SortByKey(faceHashes, sortedFaces);
+
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> isExternal;
+    vtkm::worklet::DispatcherMapField<FaceIsExternal,Device> externalDispatcher;
+    externalDispatcher.Invoke(
+          vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numFaces),
+          faceHashes,
+          sortedFaces,
+          faceToCell,
+          faceToLocalFace,
+          cellSetIn,
+          isExternal);
+
+    // Build the output from the faces seen only once.
+    vtkm::worklet::ScatterCountingFused externalScatter(isExternal, Device());
+
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> pointsPerFace;
+    vtkm::cont::ArrayHandle<vtkm::UInt8> faceShapes;
+    vtkm::worklet::DispatcherMapField<ExternalFaceCountPoints,Device>
+        countPointsDispatcher(externalScatter);
+    countPointsDispatcher.Invoke(sortedFaces,
+                                 faceToCell,
+                                 faceToLocalFace,
+                                 cellSetIn,
+                                 pointsPerFace,
+                                 faceShapes);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> faceIndexOffsets;
+    vtkm::cont::ArrayHandle<vtkm::Id> faceIndices;
+    vtkm::worklet::DispatcherMapField<ExternalFaceExtract,Device>
+        extractDispatcher(externalScatter);
+    extractDispatcher.Invoke(sortedFaces,
+                             faceToCell,
+                             faceToLocalFace,
+                             cellSetIn,
+                             BuildGroupVecVariableOutput(pointsPerFace,
+                                                         faceIndices,
+                                                         faceIndexOffsets,
+                                                         Device()));
+
+    vtkm::cont::CellSetExplicit<> cellSetOut(cellSetIn.GetName());
+    cellSetOut.Fill(cellSetIn.GetNumberOfPoints(),
+                    faceShapes,
+                    pointsPerFace,
+                    faceIndices,
+                    faceIndexOffsets);
+    return cellSetOut;
+  }
+
+  // The boundary of a structured grid is known without looking at any faces.
+  // Each boundary face is computed directly from its index.
+  struct StructuredBoundaryFaces : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<> boundaryFaceIndex,
+                                  FieldOut<> faceIndices);
+    typedef void ExecutionSignature(_1, _2);
+    typedef _1 InputDomain;
+
+    vtkm::Id3 PointDimensions;
+
+    VTKM_CONT
+    StructuredBoundaryFaces(const vtkm::Id3 &pointDimensions)
+      : PointDimensions(pointDimensions) {  }
+
+    template<typename FaceIndexVecType>
+    VTKM_EXEC
+    void operator()(vtkm::Id boundaryFaceIndex,
+                    FaceIndexVecType &faceIndices) const
+    {
+      vtkm::Id3 cellDims = this->PointDimensions - vtkm::Id3(1);
+
+      // Boundary faces are ordered by side: -x, +x, -y, +y, -z, +z. On each
+      // side they are ordered by the cells on that side.
+      vtkm::IdComponent axis = 0;
+      vtkm::Id sideSize = cellDims[1]*cellDims[2];
+      while (boundaryFaceIndex >= 2*sideSize)
+      {
+        boundaryFaceIndex -= 2*sideSize;
+        ++axis;
+        sideSize =
+            cellDims[(axis+1)%3]*cellDims[(axis+2)%3];
+      }
+      vtkm::IdComponent high = (boundaryFaceIndex >= sideSize) ? 1 : 0;
+      boundaryFaceIndex -= high*sideSize;
+
+      vtkm::Id3 cell;
+      cell[axis] = high ? cellDims[axis] - 1 : 0;
+      cell[(axis+1)%3] = boundaryFaceIndex%cellDims[(axis+1)%3];
+      cell[(axis+2)%3] = boundaryFaceIndex/cellDims[(axis+1)%3];
+
+      // Point indices of the hexahedron in VTK order.
+      vtkm::Vec<vtkm::Id,8> hexPoints;
+      for (vtkm::IdComponent localPoint = 0; localPoint < 8; ++localPoint)
+      {
+        vtkm::Id3 point = cell;
+        point[0] += ((localPoint+1)/2)%2;
+        point[1] += (localPoint/2)%2;
+        point[2] += localPoint/4;
+        hexPoints[localPoint] =
+            point[0] + this->PointDimensions[0]*
+            (point[1] + this->PointDimensions[1]*point[2]);
+      }
+
+      // Find the hexahedron face on this side so that the boundary face has
+      // the same points and orientation as the general algorithm gives.
+      vtkm::Id3 sidePoint = cell;
+      sidePoint[axis] += high;
+      for (vtkm::IdComponent face = 0; face < 6; ++face)
+      {
+        vtkm::VecCConst<vtkm::IdComponent> localFaceIndices =
+            vtkm::exec::CellFaceLocalIndices(
+              face, vtkm::CellShapeTagHexahedron(), *this);
+        bool onSide = true;
+        for (vtkm::IdComponent index = 0; index < 4; ++index)
+        {
+          vtkm::IdComponent localPoint = localFaceIndices[index];
+          vtkm::Id3 offset(((localPoint+1)/2)%2,
+                           (localPoint/2)%2,
+                           localPoint/4);
+          if (cell[axis] + offset[axis] != sidePoint[axis])
+          {
+            onSide = false;
+          }
+        }
+        if (onSide)
+        {
+          for (vtkm::IdComponent index = 0; index < 4; ++index)
+          {
+            faceIndices[index] = hexPoints[localFaceIndices[index]];
+          }
+          return;
+        }
+      }
+      this->RaiseError("Could not find boundary face.");
+    }
+  };
+
+  template<typename Device>
+  VTKM_CONT
+  vtkm::cont::CellSetSingleType<>
+  Run(const vtkm::cont::CellSetStructured<3> &cellSetIn, Device)
+  {
+    vtkm::Id3 pointDims = cellSetIn.GetPointDimensions();
+    vtkm::Id3 cellDims = pointDims - vtkm::Id3(1);
+    vtkm::Id numBoundaryFaces = 2*(cellDims[1]*cellDims[2] +
+                                   cellDims[2]*cellDims[0] +
+                                   cellDims[0]*cellDims[1]);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> faceIndices;
+    vtkm::worklet::DispatcherMapField<StructuredBoundaryFaces,Device>
+        dispatcher(StructuredBoundaryFaces(pointDims));
+    dispatcher.Invoke(
+          vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numBoundaryFaces),
+          vtkm::cont::make_ArrayHandleGroupVec<4>(faceIndices));
+
+    vtkm::cont::CellSetSingleType<> cellSetOut(cellSetIn.GetName());
+    cellSetOut.Fill(cellSetIn.GetNumberOfPoints(),
+                    vtkm::CELL_SHAPE_QUAD,
+                    4,
+                    faceIndices);
+    return cellSetOut;
+  }
+};
+////
+//// END-EXAMPLE ExtractExternalFaces.cxx
+////
+
+// Returns the sorted points of every face of the cell set, keyed so that
+// faces with the same points compare equal.
+template<typename CellSetType>
+std::multiset<std::vector<vtkm::Id> > FacePointSets(const CellSetType &cellSet)
+{
+  std::multiset<std::vector<vtkm::Id> > faces;
+  for (vtkm::Id cellIndex = 0;
+       cellIndex < cellSet.GetNumberOfCells();
+       cellIndex++)
+  {
+    vtkm::Vec<vtkm::Id,MAX_FACE_POINTS> facePoints;
+    cellSet.GetIndices(cellIndex, facePoints);
+    std::vector<vtkm::Id> points(
+          &facePoints[0], &facePoints[0] + cellSet.GetNumberOfIndices(cellIndex));
+    std::sort(points.begin(), points.end());
+    faces.insert(points);
+  }
+  return faces;
+}
+
+void TryExtractExternalFaces()
+{
+  std::cout << "Trying extract external faces." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  vtkm::cont::DataSet dataSet =
+      vtkm::cont::testing::MakeTestDataSet().Make3DExplicitDataSet5();
+  vtkm::cont::CellSetExplicit<> cellSet;
+  dataSet.GetCellSet().CopyTo(cellSet);
+
+  // The external faces are the faces that belong to only one cell.
+  ExtractFaces extractFaces;
+  std::multiset<std::vector<vtkm::Id> > allFaces =
+      FacePointSets(extractFaces.Run(cellSet, Device()));
+  std::multiset<std::vector<vtkm::Id> > expectedFaces;
+  for (std::multiset<std::vector<vtkm::Id> >::iterator face = allFaces.begin();
+       face != allFaces.end();
+       ++face)
+  {
+    if (allFaces.count(*face) == 1)
+    {
+      expectedFaces.insert(*face);
+    }
+  }
+
+  ExtractExternalFaces extractExternalFaces;
+  vtkm::cont::CellSetExplicit<> externalFaces =
+      extractExternalFaces.Run(cellSet, Device());
+  VTKM_TEST_ASSERT(externalFaces.GetNumberOfCells() < 20,
+                   "Internal faces not removed");
+  VTKM_TEST_ASSERT(FacePointSets(externalFaces) == expectedFaces,
+                   "Wrong external faces");
+
+  // The structured fast path should give the same faces as the general
+  // algorithm.
+  vtkm::cont::CellSetStructured<3> hexCells("cells");
+  hexCells.SetPointDimensions(vtkm::Id3(4, 5, 6));
+  vtkm::cont::CellSetSingleType<> structuredFaces =
+      extractExternalFaces.Run(hexCells, Device());
+  VTKM_TEST_ASSERT(structuredFaces.GetNumberOfCells() == 2*(4*5+5*3+3*4),
+                   "Wrong number of structured boundary faces");
+  vtkm::cont::CellSetExplicit<> generalFaces =
+      extractExternalFaces.Run(vtkm::cont::DynamicCellSet(hexCells), Device());
+  VTKM_TEST_ASSERT(FacePointSets(structuredFaces) ==
+                   FacePointSets(generalFaces),
+                   "Structured boundary differs from general external faces");
+}
+
+void TryParallelOffsets()
+{
+  std::cout << "Trying parallel conversion of counts to offsets." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  // Use enough values to span several chunks.
+  const vtkm::Id NUM_VALUES = 3*OFFSETS_CHUNK_SIZE + 10;
+  vtkm::cont::ArrayHandle<vtkm::IdComponent> counts;
+  counts.Allocate(NUM_VALUES);
+  for (vtkm::Id index = 0; index < NUM_VALUES; index++)
+  {
+    counts.GetPortalControl().Set(index,
+                                  static_cast<vtkm::IdComponent>(index%5));
+  }
+
+  vtkm::Id expectedSize;
+  vtkm::cont::ArrayHandle<vtkm::Id> expectedOffsets =
+      vtkm::cont::ConvertNumComponentsToOffsets(counts, expectedSize);
+
+  vtkm::cont::ArrayHandle<vtkm::Id> offsets;
+  vtkm::Id size = ParallelNumComponentsToOffsets(counts, offsets, Device());
+  VTKM_TEST_ASSERT(size == expectedSize, "Wrong source size.");
+  VTKM_TEST_ASSERT(offsets.GetNumberOfValues() == NUM_VALUES,
+                   "Wrong number of offsets.");
+
+  vtkm::cont::ArrayHandle<vtkm::Id> countsAndOffsets;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+        vtkm::cont::make_ArrayHandleCast<vtkm::Id>(counts), countsAndOffsets);
+  vtkm::Id inPlaceSize =
+      ParallelNumComponentsToOffsetsInPlace(countsAndOffsets, Device());
+  VTKM_TEST_ASSERT(inPlaceSize == expectedSize, "Wrong source size.");
+
+  for (vtkm::Id index = 0; index < NUM_VALUES; index++)
+  {
+    vtkm::Id expected = expectedOffsets.GetPortalConstControl().Get(index);
+    VTKM_TEST_ASSERT(offsets.GetPortalConstControl().Get(index) == expected,
+                     "Wrong offset.");
+    VTKM_TEST_ASSERT(
+          countsAndOffsets.GetPortalConstControl().Get(index) == expected,
+          "Wrong offset computed in place.");
+  }
+
+  vtkm::cont::ArrayHandle<vtkm::Id> components;
+  vtkm::cont::ArrayHandle<vtkm::Id> groupOffsets;
+  VTKM_TEST_ASSERT(
+        BuildGroupVecVariableOutput(counts, components, groupOffsets, Device())
+          .GetNumberOfValues() == NUM_VALUES,
+        "Wrong number of groups.");
+  VTKM_TEST_ASSERT(components.GetNumberOfValues() == expectedSize,
+                   "Components not allocated.");
+}
+
 void Run()
 {
+  TryParallelOffsets();
   TryExtractEdges();
+  TryExtractUniqueEdges();
   TryExtractFaces();
+  TryExtractExternalFaces();
 }
 
 } // anonymous namespace
@@ -1,10 +1,28 @@
+#include "BenchmarkHelpers.h"
+#include "CellSetExplicitIndex32.h"
+
 #include <vtkm/exec/CellDerivative.h>
 #include <vtkm/exec/CellInterpolate.h>
+#include <vtkm/exec/FunctorBase.h>
 #include <vtkm/exec/ParametricCoordinates.h>
 
 #include <vtkm/worklet/DispatcherMapTopology.h>
 #include <vtkm/worklet/WorkletMapTopology.h>
 
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayHandleCounting.h>
+#include <vtkm/cont/ArrayHandleZip.h>
+#include <vtkm/cont/CellSetSingleType.h>
+#include <vtkm/cont/DataSetBuilderExplicit.h>
+#include <vtkm/cont/DataSetFieldAdd.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/ErrorBadValue.h>
+#include <vtkm/cont/Timer.h>
+
+#include <vtkm/CellShape.h>
+
+#include <vector>
+
 #include <vtkm/cont/testing/MakeTestDataSet.h>
 #include <vtkm/cont/testing/Testing.h>
 
@@ -61,6 +79,190 @@ void TryCellCenters()
   VTKM_TEST_ASSERT(test_equal(60.1875, centers.GetPortalConstControl().Get(0)),
                    "Bad first value.");
 }
+
+// Makes a grid of hexahedra in which every other hexahedron is split into
+// two wedges, so the cell shapes alternate.
+vtkm::cont::DataSet MakeMixedShapeDataSet(vtkm::Id dim)
+{
+  vtkm::Id pointDim = dim + 1;
+
+  std::vector<vtkm::Vec<vtkm::Float32,3> > coords;
+  std::vector<vtkm::Float32> pointvar;
+  for (vtkm::Id k = 0; k < pointDim; k++)
+  {
+    for (vtkm::Id j = 0; j < pointDim; j++)
+    {
+      for (vtkm::Id i = 0; i < pointDim; i++)
+      {
+        coords.push_back(vtkm::make_Vec(static_cast<vtkm::Float32>(i),
+                                        static_cast<vtkm::Float32>(j),
+                                        static_cast<vtkm::Float32>(k)));
+        pointvar.push_back(static_cast<vtkm::Float32>(i + 2*j*j + 3*k));
+      }
+    }
+  }
+
+  std::vector<vtkm::UInt8> shapes;
+  std::vector<vtkm::IdComponent> numIndices;
+  std::vector<vtkm::Id> connectivity;
+  for (vtkm::Id k = 0; k < dim; k++)
+  {
+    for (vtkm::Id j = 0; j < dim; j++)
+    {
+      for (vtkm::Id i = 0; i < dim; i++)
+      {
+        vtkm::Id p0 = (k*pointDim + j)*pointDim + i;
+        vtkm::Id p1 = p0 + 1;
+        vtkm::Id p2 = p0 + pointDim + 1;
+        vtkm::Id p3 = p0 + pointDim;
+        vtkm::Id p4 = p0 + pointDim*pointDim;
+        vtkm::Id p5 = p1 + pointDim*pointDim;
+        vtkm::Id p6 = p2 + pointDim*pointDim;
+        vtkm::Id p7 = p3 + pointDim*pointDim;
+        if ((i+j+k)%2 == 0)
+        {
+          shapes.push_back(vtkm::CELL_SHAPE_HEXAHEDRON);
+          numIndices.push_back(8);
+          vtkm::Id hex[8] = { p0, p1, p2, p3, p4, p5, p6, p7 };
+          connectivity.insert(connectivity.end(), hex, hex+8);
+        }
+        else
+        {
+          shapes.push_back(vtkm::CELL_SHAPE_WEDGE);
+          numIndices.push_back(6);
+          vtkm::Id wedge1[6] = { p0, p1, p2, p4, p5, p6 };
+          connectivity.insert(connectivity.end(), wedge1, wedge1+6);
+          shapes.push_back(vtkm::CELL_SHAPE_WEDGE);
+          numIndices.push_back(6);
+          vtkm::Id wedge2[6] = { p0, p2, p3, p4, p6, p7 };
+          connectivity.insert(connectivity.end(), wedge2, wedge2+6);
+        }
+      }
+    }
+  }
+
+  vtkm::cont::DataSet dataSet =
+      vtkm::cont::DataSetBuilderExplicit().Create(
+        coords, shapes, numIndices, connectivity);
+  vtkm::cont::DataSetFieldAdd().AddPointField(dataSet, "pointvar", pointvar);
+  return dataSet;
+}
+
+void TryCellCentersIndexWidth()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  vtkm::cont::DataSet dataSet64 = MakeMixedShapeDataSet(64);
+  vtkm::cont::DataSet dataSet32 =
+      vtkm::cont::ConvertToIndex32(dataSet64, Device());
+
+  vtkm::cont::CellSetExplicit<> cellSet64;
+  dataSet64.GetCellSet().CopyTo(cellSet64);
+  vtkm::cont::CellSetExplicitIndex32 cellSet32;
+  dataSet32.GetCellSet().CopyTo(cellSet32);
+  vtkm::Id numCells = cellSet64.GetNumberOfCells();
+
+  std::cout << "Comparing CellCenters with 64-bit and 32-bit connectivity on "
+            << numCells << " hexahedra and wedges." << std::endl;
+
+  typedef vtkm::cont::ArrayHandle<vtkm::Float32> ArrayType;
+  ArrayType field =
+      dataSet32.GetField("pointvar").GetData().Cast<ArrayType>();
+
+  vtkm::worklet::DispatcherMapTopology<CellCenters,Device> dispatcher;
+  ArrayType centers64;
+  vtkm::Float64 time64 = benchmark::AverageTime(
+        [&]() { dispatcher.Invoke(cellSet64, field, centers64); }, Device());
+  ArrayType centers32;
+  vtkm::Float64 time32 = benchmark::AverageTime(
+        [&]() { dispatcher.Invoke(cellSet32, field, centers32); }, Device());
+
+  std::cout << "  64-bit indices: " << time64 << " s" << std::endl;
+  std::cout << "  32-bit indices: " << time32 << " s" << std::endl;
+
+  VTKM_TEST_ASSERT(centers32.GetNumberOfValues() == numCells,
+                   "Bad number of cells.");
+  ArrayType::PortalConstControl portal64 = centers64.GetPortalConstControl();
+  ArrayType::PortalConstControl portal32 = centers32.GetPortalConstControl();
+  for (vtkm::Id cellIndex = 0; cellIndex < numCells; cellIndex++)
+  {
+    VTKM_TEST_ASSERT(test_equal(portal32.Get(cellIndex),
+                                portal64.Get(cellIndex)),
+                     "Index widths give different centers.");
+  }
+}
+
+bool BuilderIndex32Throws(
+    const std::vector<vtkm::Vec<vtkm::Float32,3> > &coords,
+    const std::vector<vtkm::UInt8> &shapes,
+    const std::vector<vtkm::IdComponent> &numIndices,
+    const std::vector<vtkm::Int32> &connectivity)
+{
+  try
+  {
+    vtkm::cont::DataSetBuilderExplicitIndex32::Create(
+          coords, shapes, numIndices, connectivity);
+  }
+  catch (vtkm::cont::ErrorBadValue &)
+  {
+    return true;
+  }
+  return false;
+}
+
+void TryDataSetBuilderExplicitIndex32()
+{
+  std::cout << "Trying DataSetBuilderExplicitIndex32." << std::endl;
+
+  // A triangle and a quadrilateral sharing an edge.
+  std::vector<vtkm::Vec<vtkm::Float32,3> > coords;
+  coords.push_back(vtkm::make_Vec(0.0f, 0.0f, 0.0f));
+  coords.push_back(vtkm::make_Vec(1.0f, 0.0f, 0.0f));
+  coords.push_back(vtkm::make_Vec(1.0f, 1.0f, 0.0f));
+  coords.push_back(vtkm::make_Vec(0.0f, 1.0f, 0.0f));
+  coords.push_back(vtkm::make_Vec(2.0f, 0.5f, 0.0f));
+  std::vector<vtkm::UInt8> shapes;
+  shapes.push_back(vtkm::CELL_SHAPE_QUAD);
+  shapes.push_back(vtkm::CELL_SHAPE_TRIANGLE);
+  std::vector<vtkm::IdComponent> numIndices;
+  numIndices.push_back(4);
+  numIndices.push_back(3);
+  vtkm::Int32 connectivityBuffer[7] = { 0, 1, 2, 3, 1, 4, 2 };
+  std::vector<vtkm::Int32> connectivity(connectivityBuffer,
+                                        connectivityBuffer+7);
+
+  vtkm::cont::DataSet dataSet =
+      vtkm::cont::DataSetBuilderExplicitIndex32::Create(
+        coords, shapes, numIndices, connectivity);
+  vtkm::cont::CellSetExplicitIndex32 cellSet;
+  dataSet.GetCellSet().CopyTo(cellSet);
+  VTKM_TEST_ASSERT(cellSet.GetNumberOfCells() == 2, "Bad number of cells.");
+  VTKM_TEST_ASSERT(cellSet.GetNumberOfPoints() == 5, "Bad number of points.");
+  VTKM_TEST_ASSERT(cellSet.GetNumberOfPointsInCell(1) == 3,
+                   "Bad number of points in cell.");
+
+  std::vector<vtkm::IdComponent> badNumIndices(numIndices);
+  badNumIndices[1] = 4;
+  VTKM_TEST_ASSERT(BuilderIndex32Throws(coords,
+                                        shapes,
+                                        badNumIndices,
+                                        connectivity),
+                   "Bad number of indices did not throw.");
+
+  std::vector<vtkm::Int32> badConnectivity(connectivity);
+  badConnectivity[5] = 5;
+  VTKM_TEST_ASSERT(BuilderIndex32Throws(coords,
+                                        shapes,
+                                        numIndices,
+                                        badConnectivity),
+                   "Point index out of range did not throw.");
+  badConnectivity[5] = -1;
+  VTKM_TEST_ASSERT(BuilderIndex32Throws(coords,
+                                        shapes,
+                                        numIndices,
+                                        badConnectivity),
+                   "Negative point index did not throw.");
+}
 ////
 //// BEGIN-EXAMPLE CellDerivatives.cxx
 ////
@@ -124,10 +326,540 @@ void TryCellDerivatives()
                    "Bad first value.");
 }
 
+////
+//// BEGIN-EXAMPLE ShapeSortedCells.cxx
+////
+// Cells are grouped by shape and number of points. Both are packed into a
+// single key so that polygons with different point counts land in different
+// groups.
+VTKM_EXEC_CONT
+inline vtkm::Id MakeShapeKey(vtkm::UInt8 shape, vtkm::IdComponent numPoints)
+{
+  return static_cast<vtkm::Id>(numPoints)*256 + static_cast<vtkm::Id>(shape);
+}
+
+template<typename Device>
+struct ShapeSortKeys : public vtkm::exec::FunctorBase
+{
+  typedef typename vtkm::cont::ArrayHandle<vtkm::UInt8>::
+      template ExecutionTypes<Device>::PortalConst ShapePortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::IdComponent>::
+      template ExecutionTypes<Device>::PortalConst NumIndicesPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal KeyPortalType;
+
+  ShapePortalType Shapes;
+  NumIndicesPortalType NumIndices;
+  KeyPortalType Keys;
+
+  VTKM_CONT
+  ShapeSortKeys(const ShapePortalType &shapes,
+                const NumIndicesPortalType &numIndices,
+                const KeyPortalType &keys)
+    : Shapes(shapes), NumIndices(numIndices), Keys(keys)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id cellIndex) const
+  {
+    this->Keys.Set(cellIndex, MakeShapeKey(this->Shapes.Get(cellIndex),
+                                           this->NumIndices.Get(cellIndex)));
+  }
+};
+
+// Copies the point indices of the cells in one group into a connectivity
+// array with a fixed number of points per cell.
+template<typename Device>
+struct GatherGroupConnectivity : public vtkm::exec::FunctorBase
+{
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::PortalConst IdPortalConstType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal IdPortalType;
+
+  IdPortalConstType CellIds;
+  IdPortalConstType Offsets;
+  IdPortalConstType Connectivity;
+  vtkm::IdComponent PointsPerCell;
+  IdPortalType GroupConnectivity;
+
+  VTKM_CONT
+  GatherGroupConnectivity(const IdPortalConstType &cellIds,
+                          const IdPortalConstType &offsets,
+                          const IdPortalConstType &connectivity,
+                          vtkm::IdComponent pointsPerCell,
+                          const IdPortalType &groupConnectivity)
+    : CellIds(cellIds),
+      Offsets(offsets),
+      Connectivity(connectivity),
+      PointsPerCell(pointsPerCell),
+      GroupConnectivity(groupConnectivity)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id groupCellIndex) const
+  {
+    vtkm::Id inIndex = this->Offsets.Get(this->CellIds.Get(groupCellIndex));
+    vtkm::Id outIndex = groupCellIndex*this->PointsPerCell;
+    for (vtkm::IdComponent pointIndex = 0;
+         pointIndex < this->PointsPerCell;
+         ++pointIndex)
+    {
+      this->GroupConnectivity.Set(outIndex + pointIndex,
+                                  this->Connectivity.Get(inIndex + pointIndex));
+    }
+  }
+};
+
+// Writes the values computed for one group back to the original cell order.
+template<typename T, typename Storage, typename Device>
+struct ScatterGroupValues : public vtkm::exec::FunctorBase
+{
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::PortalConst CellIdPortalType;
+  typedef typename vtkm::cont::ArrayHandle<T>::
+      template ExecutionTypes<Device>::PortalConst GroupPortalType;
+  typedef typename vtkm::cont::ArrayHandle<T,Storage>::
+      template ExecutionTypes<Device>::Portal CellPortalType;
+
+  CellIdPortalType CellIds;
+  GroupPortalType GroupValues;
+  CellPortalType CellValues;
+
+  VTKM_CONT
+  ScatterGroupValues(const CellIdPortalType &cellIds,
+                     const GroupPortalType &groupValues,
+                     const CellPortalType &cellValues)
+    : CellIds(cellIds), GroupValues(groupValues), CellValues(cellValues)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id groupCellIndex) const
+  {
+    this->CellValues.Set(this->CellIds.Get(groupCellIndex),
+                         this->GroupValues.Get(groupCellIndex));
+  }
+};
+
+// Splits a mixed explicit cell set into one CellSetSingleType for each
+// combination of shape and number of points. Building the groups sorts and
+// copies the topology, so build this once and keep it with the data set.
+class ShapeSortedCells
+{
+public:
+  VTKM_CONT
+  ShapeSortedCells() : NumberOfCells(0) {  }
+
+  template<typename Device>
+  VTKM_CONT
+  ShapeSortedCells(const vtkm::cont::CellSetExplicit<> &cellSet, Device)
+    : NumberOfCells(cellSet.GetNumberOfCells())
+  {
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    vtkm::cont::ArrayHandle<vtkm::UInt8> shapes =
+        cellSet.GetShapesArray(vtkm::TopologyElementTagPoint(),
+                               vtkm::TopologyElementTagCell());
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> numIndices =
+        cellSet.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                   vtkm::TopologyElementTagCell());
+    vtkm::cont::ArrayHandle<vtkm::Id> connectivity =
+        cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                     vtkm::TopologyElementTagCell());
+
+    vtkm::cont::ArrayHandle<vtkm::Id> keys;
+    Algorithm::Schedule(
+          ShapeSortKeys<Device>(shapes.PrepareForInput(Device()),
+                                numIndices.PrepareForInput(Device()),
+                                keys.PrepareForOutput(this->NumberOfCells,
+                                                      Device())),
+          this->NumberOfCells);
+
+    // Sorting the (key, cell id) pairs together orders the cells of each
+    // group by their original index, so only one sort is needed for all the
+    // groups and the cells in a group keep their original order.
+    vtkm::cont::ArrayHandle<vtkm::Id> sortedCellIds;
+    Algorithm::Copy(
+          vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, this->NumberOfCells),
+          sortedCellIds);
+    vtkm::cont::ArrayHandleZip<vtkm::cont::ArrayHandle<vtkm::Id>,
+                               vtkm::cont::ArrayHandle<vtkm::Id> >
+        keysAndCellIds(keys, sortedCellIds);
+    Algorithm::Sort(keysAndCellIds);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> uniqueKeys;
+    Algorithm::Copy(keys, uniqueKeys);
+    Algorithm::Unique(uniqueKeys);
+
+    // Each group is the range of sorted cells between the first and one past
+    // the last occurrence of its key.
+    vtkm::cont::ArrayHandle<vtkm::Id> groupBegins;
+    vtkm::cont::ArrayHandle<vtkm::Id> groupEnds;
+    Algorithm::LowerBounds(keys, uniqueKeys, groupBegins);
+    Algorithm::UpperBounds(keys, uniqueKeys, groupEnds);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> offsets;
+    Algorithm::ScanExclusive(
+          vtkm::cont::make_ArrayHandleCast<vtkm::Id>(numIndices), offsets);
+
+    vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl uniqueKeyPortal =
+        uniqueKeys.GetPortalConstControl();
+    vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl groupBeginPortal =
+        groupBegins.GetPortalConstControl();
+    vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl groupEndPortal =
+        groupEnds.GetPortalConstControl();
+    for (vtkm::Id groupIndex = 0;
+         groupIndex < uniqueKeys.GetNumberOfValues();
+         ++groupIndex)
+    {
+      vtkm::Id key = uniqueKeyPortal.Get(groupIndex);
+      vtkm::UInt8 shape = static_cast<vtkm::UInt8>(key%256);
+      vtkm::IdComponent pointsPerCell = static_cast<vtkm::IdComponent>(key/256);
+
+      Group group;
+      group.Shape = shape;
+      vtkm::Id groupBegin = groupBeginPortal.Get(groupIndex);
+      vtkm::Id numGroupCells = groupEndPortal.Get(groupIndex) - groupBegin;
+      if (!Algorithm::CopySubRange(sortedCellIds,
+                                   groupBegin,
+                                   numGroupCells,
+                                   group.CellIds))
+      {
+        throw vtkm::cont::ErrorBadValue("Bad range for cell shape group.");
+      }
+
+      vtkm::cont::ArrayHandle<vtkm::Id> groupConnectivity;
+      Algorithm::Schedule(
+            GatherGroupConnectivity<Device>(
+              group.CellIds.PrepareForInput(Device()),
+              offsets.PrepareForInput(Device()),
+              connectivity.PrepareForInput(Device()),
+              pointsPerCell,
+              groupConnectivity.PrepareForOutput(numGroupCells*pointsPerCell,
+                                                 Device())),
+            numGroupCells);
+
+      group.CellSet =
+          vtkm::cont::CellSetSingleType<>(cellSet.GetName());
+      group.CellSet.Fill(cellSet.GetNumberOfPoints(),
+                         shape,
+                         pointsPerCell,
+                         groupConnectivity);
+      this->Groups.push_back(group);
+    }
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfCells() const { return this->NumberOfCells; }
+
+  VTKM_CONT
+  vtkm::IdComponent GetNumberOfGroups() const
+  {
+    return static_cast<vtkm::IdComponent>(this->Groups.size());
+  }
+
+  VTKM_CONT
+  vtkm::UInt8 GetGroupShape(vtkm::IdComponent groupIndex) const
+  {
+    return this->Groups[static_cast<std::size_t>(groupIndex)].Shape;
+  }
+
+  VTKM_CONT
+  const vtkm::cont::CellSetSingleType<> &
+  GetGroupCellSet(vtkm::IdComponent groupIndex) const
+  {
+    return this->Groups[static_cast<std::size_t>(groupIndex)].CellSet;
+  }
+
+  // Copies values computed on the cells of one group into an array indexed
+  // by the cells of the original cell set. cellValues must already be
+  // allocated to the number of cells.
+  template<typename T, typename Storage, typename Device>
+  VTKM_CONT
+  void ScatterToCells(vtkm::IdComponent groupIndex,
+                      const vtkm::cont::ArrayHandle<T> &groupValues,
+                      vtkm::cont::ArrayHandle<T,Storage> &cellValues,
+                      Device) const
+  {
+    const Group &group = this->Groups[static_cast<std::size_t>(groupIndex)];
+    vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(
+          ScatterGroupValues<T,Storage,Device>(
+            group.CellIds.PrepareForInput(Device()),
+            groupValues.PrepareForInput(Device()),
+            cellValues.PrepareForInPlace(Device())),
+          group.CellIds.GetNumberOfValues());
+  }
+
+private:
+  struct Group
+  {
+    vtkm::UInt8 Shape;
+    vtkm::cont::ArrayHandle<vtkm::Id> CellIds;
+    vtkm::cont::CellSetSingleType<> CellSet;
+  };
+
+  vtkm::Id NumberOfCells;
+  std::vector<Group> Groups;
+};
+////
+//// END-EXAMPLE ShapeSortedCells.cxx
+////
+
+////
+//// BEGIN-EXAMPLE ShapeSortedCellCenters.cxx
+////
+// Same as CellCenters except that the cell shape is a template argument, so
+// every shape gets its own kernel with no switch on the shape.
+template<typename CellShapeTag>
+struct CellCentersOfShape : vtkm::worklet::WorkletMapPointToCell
+{
+  typedef void ControlSignature(CellSetIn,
+                                FieldInPoint<> inputField,
+                                FieldOutCell<> outputField);
+  typedef void ExecutionSignature(PointCount, _2, _3);
+  typedef _1 InputDomain;
+
+  template<typename FieldInVecType,typename FieldOutType>
+  VTKM_EXEC
+  void operator()(vtkm::IdComponent pointCount,
+                  const FieldInVecType &inputField,
+                  FieldOutType &outputField) const
+  {
+    vtkm::Vec<vtkm::FloatDefault,3> center =
+        vtkm::exec::ParametricCoordinatesCenter(pointCount,
+                                                CellShapeTag(),
+                                                *this);
+    outputField =
+        vtkm::exec::CellInterpolate(inputField, center, CellShapeTag(), *this);
+  }
+};
+
+template<typename CellShapeTag, typename Device>
+VTKM_CONT
+void RunCellCentersOfShape(CellShapeTag,
+                           const ShapeSortedCells &sortedCells,
+                           vtkm::IdComponent groupIndex,
+                           const vtkm::cont::ArrayHandle<vtkm::Float32> &field,
+                           vtkm::cont::ArrayHandle<vtkm::Float32> &centers,
+                           Device)
+{
+  vtkm::cont::ArrayHandle<vtkm::Float32> groupCenters;
+  vtkm::worklet::DispatcherMapTopology<CellCentersOfShape<CellShapeTag>,Device>
+      dispatcher;
+  dispatcher.Invoke(sortedCells.GetGroupCellSet(groupIndex),
+                    field,
+                    groupCenters);
+  sortedCells.ScatterToCells(groupIndex, groupCenters, centers, Device());
+}
+
+template<typename Device>
+VTKM_CONT
+vtkm::cont::ArrayHandle<vtkm::Float32>
+ShapeSortedCellCenters(const ShapeSortedCells &sortedCells,
+                       const vtkm::cont::ArrayHandle<vtkm::Float32> &field,
+                       Device)
+{
+  vtkm::cont::ArrayHandle<vtkm::Float32> centers;
+  centers.PrepareForOutput(sortedCells.GetNumberOfCells(), Device());
+
+  for (vtkm::IdComponent groupIndex = 0;
+       groupIndex < sortedCells.GetNumberOfGroups();
+       ++groupIndex)
+  {
+    switch (sortedCells.GetGroupShape(groupIndex))
+    {
+      vtkmGenericCellShapeMacro(
+            RunCellCentersOfShape(CellShapeTag(),
+                                  sortedCells,
+                                  groupIndex,
+                                  field,
+                                  centers,
+                                  Device()));
+      default:
+        throw vtkm::cont::ErrorBadValue("Unknown cell shape.");
+    }
+  }
+
+  return centers;
+}
+////
+//// END-EXAMPLE ShapeSortedCellCenters.cxx
+////
+
+template<typename CellShapeTag>
+struct CellDerivativesOfShape : vtkm::worklet::WorkletMapPointToCell
+{
+  typedef void ControlSignature(CellSetIn,
+                                FieldInPoint<> inputField,
+                                FieldInPoint<Vec3> pointCoordinates,
+                                FieldOutCell<> outputField);
+  typedef void ExecutionSignature(PointCount, _2, _3, _4);
+  typedef _1 InputDomain;
+
+  template<typename FieldInVecType,
+           typename PointCoordVecType,
+           typename FieldOutType>
+  VTKM_EXEC
+  void operator()(vtkm::IdComponent pointCount,
+                  const FieldInVecType &inputField,
+                  const PointCoordVecType &pointCoordinates,
+                  FieldOutType &outputField) const
+  {
+    vtkm::Vec<vtkm::FloatDefault,3> center =
+        vtkm::exec::ParametricCoordinatesCenter(pointCount,
+                                                CellShapeTag(),
+                                                *this);
+    outputField = vtkm::exec::CellDerivative(inputField,
+                                             pointCoordinates,
+                                             center,
+                                             CellShapeTag(),
+                                             *this);
+  }
+};
+
+template<typename CellShapeTag, typename CoordsType, typename Device>
+VTKM_CONT
+void RunCellDerivativesOfShape(
+    CellShapeTag,
+    const ShapeSortedCells &sortedCells,
+    vtkm::IdComponent groupIndex,
+    const vtkm::cont::ArrayHandle<vtkm::Float32> &field,
+    const CoordsType &coords,
+    vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > &derivatives,
+    Device)
+{
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > groupDerivatives;
+  vtkm::worklet::DispatcherMapTopology<CellDerivativesOfShape<CellShapeTag>,
+                                       Device> dispatcher;
+  dispatcher.Invoke(sortedCells.GetGroupCellSet(groupIndex),
+                    field,
+                    coords,
+                    groupDerivatives);
+  sortedCells.ScatterToCells(groupIndex,
+                             groupDerivatives,
+                             derivatives,
+                             Device());
+}
+
+template<typename CoordsType, typename Device>
+VTKM_CONT
+vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> >
+ShapeSortedCellDerivatives(const ShapeSortedCells &sortedCells,
+                           const vtkm::cont::ArrayHandle<vtkm::Float32> &field,
+                           const CoordsType &coords,
+                           Device)
+{
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > derivatives;
+  derivatives.PrepareForOutput(sortedCells.GetNumberOfCells(), Device());
+
+  for (vtkm::IdComponent groupIndex = 0;
+       groupIndex < sortedCells.GetNumberOfGroups();
+       ++groupIndex)
+  {
+    switch (sortedCells.GetGroupShape(groupIndex))
+    {
+      vtkmGenericCellShapeMacro(
+            RunCellDerivativesOfShape(CellShapeTag(),
+                                      sortedCells,
+                                      groupIndex,
+                                      field,
+                                      coords,
+                                      derivatives,
+                                      Device()));
+      default:
+        throw vtkm::cont::ErrorBadValue("Unknown cell shape.");
+    }
+  }
+
+  return derivatives;
+}
+
+template<typename T>
+void CheckSameValues(const vtkm::cont::ArrayHandle<T> &array1,
+                     const vtkm::cont::ArrayHandle<T> &array2)
+{
+  VTKM_TEST_ASSERT(array1.GetNumberOfValues() == array2.GetNumberOfValues(),
+                   "Arrays have different sizes.");
+  typename vtkm::cont::ArrayHandle<T>::PortalConstControl portal1 =
+      array1.GetPortalConstControl();
+  typename vtkm::cont::ArrayHandle<T>::PortalConstControl portal2 =
+      array2.GetPortalConstControl();
+  for (vtkm::Id index = 0; index < array1.GetNumberOfValues(); index++)
+  {
+    VTKM_TEST_ASSERT(test_equal(portal1.Get(index), portal2.Get(index)),
+                     "Shape sorted result differs from generic result.");
+  }
+}
+
+void TryShapeSortedCellOperations(const vtkm::cont::DataSet &dataSet)
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  typedef vtkm::cont::ArrayHandle<vtkm::Float32> ArrayType;
+  ArrayType field = dataSet.GetField("pointvar").GetData().Cast<ArrayType>();
+
+  vtkm::cont::CellSetExplicit<> cellSet;
+  dataSet.GetCellSet().CopyTo(cellSet);
+
+  vtkm::cont::Timer<Device> timer;
+  ShapeSortedCells sortedCells(cellSet, Device());
+  vtkm::Float64 sortTime = timer.GetElapsedTime();
+  std::cout << "  " << sortedCells.GetNumberOfGroups() << " shape groups for "
+            << sortedCells.GetNumberOfCells() << " cells, sorted in "
+            << sortTime << " s" << std::endl;
+
+  ArrayType genericCenters;
+  vtkm::worklet::DispatcherMapTopology<CellCenters,Device> centersDispatcher;
+  vtkm::Float64 genericTime = benchmark::AverageTime(
+        [&]() { centersDispatcher.Invoke(cellSet, field, genericCenters); },
+        Device());
+
+  ArrayType sortedCenters;
+  vtkm::Float64 sortedTime = benchmark::AverageTime(
+        [&]() {
+          sortedCenters = ShapeSortedCellCenters(sortedCells, field, Device());
+        },
+        Device());
+
+  std::cout << "  CellCenters generic: " << genericTime << " s" << std::endl;
+  std::cout << "  CellCenters shape sorted: " << sortedTime << " s"
+            << std::endl;
+  CheckSameValues(genericCenters, sortedCenters);
+
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > genericDerivatives;
+  vtkm::worklet::DispatcherMapTopology<CellDerivatives,Device>
+      derivativesDispatcher;
+  derivativesDispatcher.Invoke(cellSet,
+                               field,
+                               dataSet.GetCoordinateSystem().GetData(),
+                               genericDerivatives);
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > sortedDerivatives =
+      ShapeSortedCellDerivatives(sortedCells,
+                                 field,
+                                 dataSet.GetCoordinateSystem().GetData(),
+                                 Device());
+  CheckSameValues(genericDerivatives, sortedDerivatives);
+}
+
+void TryShapeSortedCellOperations()
+{
+  std::cout << "Trying shape sorted cell operations." << std::endl;
+
+  std::cout << "Mixed shape test data set." << std::endl;
+  TryShapeSortedCellOperations(
+        vtkm::cont::testing::MakeTestDataSet().Make3DExplicitDataSet5());
+
+  std::cout << "Grid of hexahedra and wedges." << std::endl;
+  TryShapeSortedCellOperations(MakeMixedShapeDataSet(48));
+}
+
 void Run()
 {
   TryCellCenters();
+  TryCellCentersIndexWidth();
+  TryDataSetBuilderExplicitIndex32();
   TryCellDerivatives();
+  TryShapeSortedCellOperations();
 }
 
 } // anonymous namespace
@@ -0,0 +1,305 @@
+#ifndef vtkm_examples_CellSetExplicitIndex32_h
+#define vtkm_examples_CellSetExplicitIndex32_h
+
+////
+//// BEGIN-EXAMPLE CellSetExplicitIndex32.cxx
+////
+#include "ReplaceCellSet.h"
+
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayPortalToIterators.h>
+#include <vtkm/cont/CellSetExplicit.h>
+#include <vtkm/cont/CellSetSingleType.h>
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/ErrorBadValue.h>
+
+#include <vtkm/ListTag.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace vtkm {
+namespace cont {
+
+// Index arrays that hold 32-bit values in memory but look like arrays of
+// vtkm::Id to the cell sets and worklets using them.
+using ArrayHandleIndex32 =
+    vtkm::cont::ArrayHandleCast<vtkm::Id,
+                                vtkm::cont::ArrayHandle<vtkm::Int32> >;
+using StorageTagIndex32 = ArrayHandleIndex32::StorageTag;
+
+// Explicit cell sets whose connectivity and offsets are stored with 32-bit
+// indices. They can hold meshes with fewer than 2^31 points and connectivity
+// entries.
+using CellSetExplicitIndex32 =
+    vtkm::cont::CellSetExplicit<vtkm::cont::StorageTagBasic,
+                                vtkm::cont::StorageTagBasic,
+                                StorageTagIndex32,
+                                StorageTagIndex32>;
+using CellSetSingleTypeIndex32 =
+    vtkm::cont::CellSetSingleType<StorageTagIndex32>;
+
+// Pass to DynamicCellSet::ResetCellSetList so that a dispatcher can find the
+// 32-bit cell sets.
+struct CellSetListTagIndex32
+    : vtkm::ListTagBase<CellSetExplicitIndex32, CellSetSingleTypeIndex32>
+{  };
+
+namespace detail {
+
+template<typename T>
+VTKM_CONT
+vtkm::cont::ArrayHandle<T> CopyToArrayHandle(const std::vector<T> &values)
+{
+  vtkm::cont::ArrayHandle<T> array;
+  array.Allocate(static_cast<vtkm::Id>(values.size()));
+  std::copy(values.begin(),
+            values.end(),
+            vtkm::cont::ArrayPortalToIteratorBegin(array.GetPortalControl()));
+  return array;
+}
+
+VTKM_CONT
+inline bool FitsInIndex32(vtkm::Id value)
+{
+  return value <= static_cast<vtkm::Id>(std::numeric_limits<vtkm::Int32>::max());
+}
+
+} // namespace detail
+
+// Like DataSetBuilderExplicit, but the connectivity is given and stored as
+// 32-bit indices.
+class DataSetBuilderExplicitIndex32
+{
+public:
+  template<typename T>
+  VTKM_CONT
+  static vtkm::cont::DataSet
+  Create(const std::vector<vtkm::Vec<T,3> > &coords,
+         const std::vector<vtkm::UInt8> &shapes,
+         const std::vector<vtkm::IdComponent> &numIndices,
+         const std::vector<vtkm::Int32> &connectivity,
+         const std::string &coordsName = "coords",
+         const std::string &cellSetName = "cells")
+  {
+    CheckSizes(coords.size(), connectivity.size());
+    if (shapes.size() != numIndices.size())
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Shapes and number of indices arrays differ in size.");
+    }
+
+    // The offsets are summed in a std::size_t and checked against the
+    // connectivity size, which CheckSizes has limited to 32 bits, so a bad
+    // numIndices array cannot overflow them.
+    std::vector<vtkm::Int32> offsets(numIndices.size());
+    std::size_t offset = 0;
+    for (std::size_t cellIndex = 0; cellIndex < numIndices.size(); ++cellIndex)
+    {
+      if ((numIndices[cellIndex] < 0) || (offset > connectivity.size()))
+      {
+        throw vtkm::cont::ErrorBadValue(
+              "Number of indices does not match connectivity size.");
+      }
+      offsets[cellIndex] = static_cast<vtkm::Int32>(offset);
+      offset += static_cast<std::size_t>(numIndices[cellIndex]);
+    }
+    if (offset != connectivity.size())
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Number of indices does not match connectivity size.");
+    }
+    CheckIndices(coords.size(), connectivity);
+
+    vtkm::cont::CellSetExplicitIndex32 cellSet(cellSetName);
+    cellSet.Fill(static_cast<vtkm::Id>(coords.size()),
+                 detail::CopyToArrayHandle(shapes),
+                 detail::CopyToArrayHandle(numIndices),
+                 vtkm::cont::make_ArrayHandleCast<vtkm::Id>(
+                   detail::CopyToArrayHandle(connectivity)),
+                 vtkm::cont::make_ArrayHandleCast<vtkm::Id>(
+                   detail::CopyToArrayHandle(offsets)));
+
+    vtkm::cont::DataSet dataSet;
+    dataSet.AddCoordinateSystem(
+          vtkm::cont::CoordinateSystem(coordsName,
+                                       detail::CopyToArrayHandle(coords)));
+    dataSet.AddCellSet(cellSet);
+    return dataSet;
+  }
+
+  template<typename T>
+  VTKM_CONT
+  static vtkm::cont::DataSet
+  Create(const std::vector<vtkm::Vec<T,3> > &coords,
+         vtkm::UInt8 shape,
+         vtkm::IdComponent numberOfPointsPerCell,
+         const std::vector<vtkm::Int32> &connectivity,
+         const std::string &coordsName = "coords",
+         const std::string &cellSetName = "cells")
+  {
+    CheckSizes(coords.size(), connectivity.size());
+    if ((numberOfPointsPerCell < 1) ||
+        ((connectivity.size() %
+          static_cast<std::size_t>(numberOfPointsPerCell)) != 0))
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Connectivity size is not a multiple of the points per cell.");
+    }
+    CheckIndices(coords.size(), connectivity);
+
+    vtkm::cont::CellSetSingleTypeIndex32 cellSet(cellSetName);
+    cellSet.Fill(static_cast<vtkm::Id>(coords.size()),
+                 shape,
+                 numberOfPointsPerCell,
+                 vtkm::cont::make_ArrayHandleCast<vtkm::Id>(
+                   detail::CopyToArrayHandle(connectivity)));
+
+    vtkm::cont::DataSet dataSet;
+    dataSet.AddCoordinateSystem(
+          vtkm::cont::CoordinateSystem(coordsName,
+                                       detail::CopyToArrayHandle(coords)));
+    dataSet.AddCellSet(cellSet);
+    return dataSet;
+  }
+
+private:
+  VTKM_CONT
+  static void CheckSizes(std::size_t numPoints, std::size_t connectivitySize)
+  {
+    if (!detail::FitsInIndex32(static_cast<vtkm::Id>(numPoints)) ||
+        !detail::FitsInIndex32(static_cast<vtkm::Id>(connectivitySize)))
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Mesh too large for 32-bit connectivity indices.");
+    }
+  }
+
+  VTKM_CONT
+  static void CheckIndices(std::size_t numPoints,
+                           const std::vector<vtkm::Int32> &connectivity)
+  {
+    for (std::size_t index = 0; index < connectivity.size(); ++index)
+    {
+      if ((connectivity[index] < 0) ||
+          (static_cast<std::size_t>(connectivity[index]) >= numPoints))
+      {
+        throw vtkm::cont::ErrorBadValue("Connectivity index out of range.");
+      }
+    }
+  }
+};
+
+// Returns the 32-bit equivalent of a CellSetExplicit<> or
+// CellSetSingleType<>. Shapes and point counts are shared with the original.
+// Other cell sets, and cell sets too large for 32-bit indices, are returned
+// unchanged.
+template<typename Device>
+VTKM_CONT
+vtkm::cont::DynamicCellSet
+ConvertCellSetToIndex32(const vtkm::cont::DynamicCellSet &dynamicCellSet,
+                        Device)
+{
+  using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+  if (dynamicCellSet.IsType<vtkm::cont::CellSetSingleType<> >())
+  {
+    vtkm::cont::CellSetSingleType<> cellSetIn;
+    dynamicCellSet.CopyTo(cellSetIn);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> connectivity =
+        cellSetIn.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                       vtkm::TopologyElementTagCell());
+    if (!detail::FitsInIndex32(cellSetIn.GetNumberOfPoints()) ||
+        !detail::FitsInIndex32(connectivity.GetNumberOfValues()) ||
+        (cellSetIn.GetNumberOfCells() < 1))
+    {
+      return dynamicCellSet;
+    }
+
+    vtkm::cont::ArrayHandle<vtkm::Int32> connectivity32;
+    Algorithm::Copy(vtkm::cont::make_ArrayHandleCast<vtkm::Int32>(connectivity),
+                    connectivity32);
+
+    vtkm::cont::CellSetSingleTypeIndex32 cellSetOut(cellSetIn.GetName());
+    cellSetOut.Fill(cellSetIn.GetNumberOfPoints(),
+                    cellSetIn.GetCellShape(0),
+                    cellSetIn.GetNumberOfPointsInCell(0),
+                    vtkm::cont::make_ArrayHandleCast<vtkm::Id>(connectivity32));
+    return vtkm::cont::DynamicCellSet(cellSetOut);
+  }
+
+  if (dynamicCellSet.IsType<vtkm::cont::CellSetExplicit<> >())
+  {
+    vtkm::cont::CellSetExplicit<> cellSetIn;
+    dynamicCellSet.CopyTo(cellSetIn);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> connectivity =
+        cellSetIn.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                       vtkm::TopologyElementTagCell());
+    if (!detail::FitsInIndex32(cellSetIn.GetNumberOfPoints()) ||
+        !detail::FitsInIndex32(connectivity.GetNumberOfValues()))
+    {
+      return dynamicCellSet;
+    }
+
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> numIndices =
+        cellSetIn.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                     vtkm::TopologyElementTagCell());
+
+    vtkm::cont::ArrayHandle<vtkm::Int32> connectivity32;
+    Algorithm::Copy(vtkm::cont::make_ArrayHandleCast<vtkm::Int32>(connectivity),
+                    connectivity32);
+
+    // The offsets are recomputed rather than copied because the input cell
+    // set may not have built them yet.
+    vtkm::cont::ArrayHandle<vtkm::Int32> offsets32;
+    Algorithm::ScanExclusive(
+          vtkm::cont::make_ArrayHandleCast<vtkm::Int32>(numIndices),
+          offsets32);
+
+    vtkm::cont::CellSetExplicitIndex32 cellSetOut(cellSetIn.GetName());
+    cellSetOut.Fill(cellSetIn.GetNumberOfPoints(),
+                    cellSetIn.GetShapesArray(vtkm::TopologyElementTagPoint(),
+                                             vtkm::TopologyElementTagCell()),
+                    numIndices,
+                    vtkm::cont::make_ArrayHandleCast<vtkm::Id>(connectivity32),
+                    vtkm::cont::make_ArrayHandleCast<vtkm::Id>(offsets32));
+    return vtkm::cont::DynamicCellSet(cellSetOut);
+  }
+
+  return dynamicCellSet;
+}
+
+// Returns a copy of the data set with every cell set converted by
+// ConvertCellSetToIndex32. Fields and coordinate systems are shared with the
+// original. Use this on the output of a reader such as VTKDataSetReader.
+template<typename Device>
+VTKM_CONT
+vtkm::cont::DataSet ConvertToIndex32(const vtkm::cont::DataSet &dataSetIn,
+                                     Device)
+{
+  vtkm::cont::DataSet dataSetOut = dataSetIn;
+  for (vtkm::Id cellSetIndex = 0;
+       cellSetIndex < dataSetIn.GetNumberOfCellSets();
+       ++cellSetIndex)
+  {
+    dataSetOut = vtkm::cont::ReplaceCellSet(
+          dataSetOut,
+          cellSetIndex,
+          ConvertCellSetToIndex32(dataSetIn.GetCellSet(cellSetIndex),
+                                  Device()));
+  }
+  return dataSetOut;
+}
+
+}
+} // namespace vtkm::cont
+////
+//// END-EXAMPLE CellSetExplicitIndex32.cxx
+////
+
+#endif //vtkm_examples_CellSetExplicitIndex32_h
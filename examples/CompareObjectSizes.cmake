@@ -0,0 +1,18 @@
+# Prints the total size of two lists of object files. Run with
+#   cmake -DLOCAL_OBJECTS=<files> -DPRECOMPILED_OBJECTS=<files> -P CompareObjectSizes.cmake
+
+function(total_size var)
+  set(total 0)
+  foreach(object ${ARGN})
+    file(READ ${object} contents HEX)
+    string(LENGTH "${contents}" hex_length)
+    math(EXPR total "${total} + ${hex_length} / 2")
+  endforeach()
+  set(${var} ${total} PARENT_SCOPE)
+endfunction()
+
+total_size(local_size ${LOCAL_OBJECTS})
+total_size(precompiled_size ${PRECOMPILED_OBJECTS})
+
+message("Object size with local dispatch:       ${local_size} bytes")
+message("Object size with precompiled dispatch: ${precompiled_size} bytes")
@@ -0,0 +1,895 @@
+////
+//// BEGIN-EXAMPLE CompressedValueEncoding.cxx
+////
+#include <vtkm/Types.h>
+
+// Values are compressed in blocks of this many values.
+const vtkm::Id COMPRESSED_BLOCK_SIZE = 64;
+
+// Maps the bits of a floating point value to an unsigned integer with the
+// same ordering as the floating point values. Differences between these
+// integers are the residuals stored by the lossless mode.
+template<typename T>
+struct CompressedValueBits;
+
+template<>
+struct CompressedValueBits<vtkm::Float32>
+{
+  VTKM_EXEC_CONT
+  static vtkm::UInt64 ToOrdered(vtkm::Float32 value)
+  {
+    union { vtkm::Float32 Value; vtkm::UInt32 Bits; } convert;
+    convert.Value = value;
+    const vtkm::UInt32 signBit = 0x80000000u;
+    return (convert.Bits & signBit) ? ~convert.Bits : (convert.Bits | signBit);
+  }
+
+  VTKM_EXEC_CONT
+  static vtkm::Float32 FromOrdered(vtkm::UInt64 ordered)
+  {
+    union { vtkm::Float32 Value; vtkm::UInt32 Bits; } convert;
+    const vtkm::UInt32 signBit = 0x80000000u;
+    vtkm::UInt32 bits = static_cast<vtkm::UInt32>(ordered);
+    convert.Bits = (bits & signBit) ? (bits & ~signBit) : ~bits;
+    return convert.Value;
+  }
+};
+
+template<>
+struct CompressedValueBits<vtkm::Float64>
+{
+  VTKM_EXEC_CONT
+  static vtkm::UInt64 ToOrdered(vtkm::Float64 value)
+  {
+    union { vtkm::Float64 Value; vtkm::UInt64 Bits; } convert;
+    convert.Value = value;
+    const vtkm::UInt64 signBit = vtkm::UInt64(1) << 63;
+    return (convert.Bits & signBit) ? ~convert.Bits : (convert.Bits | signBit);
+  }
+
+  VTKM_EXEC_CONT
+  static vtkm::Float64 FromOrdered(vtkm::UInt64 ordered)
+  {
+    union { vtkm::Float64 Value; vtkm::UInt64 Bits; } convert;
+    const vtkm::UInt64 signBit = vtkm::UInt64(1) << 63;
+    convert.Bits = (ordered & signBit) ? (ordered & ~signBit) : ~ordered;
+    return convert.Value;
+  }
+};
+
+// A value is stored as an unsigned residual from the minimum value of its
+// block. A positive tolerance selects the lossy mode, which quantizes the
+// residual to bins of twice the tolerance. A tolerance of 0 selects the
+// lossless mode.
+//
+// Lossy residuals are clamped to 2^63 so that the cast cannot overflow. A
+// block containing a clamped residual thus has a bit width of 64, which no
+// other lossy block can have, and such blocks are stored losslessly instead.
+template<typename T>
+VTKM_EXEC_CONT
+vtkm::UInt64 CompressedEncode(T value, T base, vtkm::Float64 tolerance)
+{
+  if (tolerance > 0)
+  {
+    const vtkm::UInt64 limit = vtkm::UInt64(1) << 63;
+    vtkm::Float64 difference =
+        static_cast<vtkm::Float64>(value) - static_cast<vtkm::Float64>(base);
+    vtkm::Float64 quantized = difference/(2*tolerance) + 0.5;
+    return (quantized < static_cast<vtkm::Float64>(limit)) ?
+          static_cast<vtkm::UInt64>(quantized) : limit;
+  }
+  else
+  {
+    return CompressedValueBits<T>::ToOrdered(value) -
+        CompressedValueBits<T>::ToOrdered(base);
+  }
+}
+
+template<typename T>
+VTKM_EXEC_CONT
+T CompressedDecode(vtkm::UInt64 residual, T base, vtkm::Float64 tolerance)
+{
+  if (tolerance > 0)
+  {
+    return static_cast<T>(static_cast<vtkm::Float64>(base) +
+                          static_cast<vtkm::Float64>(residual)*2*tolerance);
+  }
+  else
+  {
+    return CompressedValueBits<T>::FromOrdered(
+          CompressedValueBits<T>::ToOrdered(base) + residual);
+  }
+}
+////
+//// END-EXAMPLE CompressedValueEncoding.cxx
+////
+
+////
+//// BEGIN-EXAMPLE CompressedArrayPortal.cxx
+////
+#include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/Assert.h>
+
+// Every block has a bit width w (the number of bits in its largest residual)
+// and stores its 64 residuals in exactly w 64-bit words. Thus, the offset
+// array gives both where a block's words start and (from the difference to
+// the next offset) the block's bit width. Blocks with a width of 64 are
+// always stored losslessly (see CompressedEncode).
+template<typename T,
+         typename BasePortalType,
+         typename OffsetPortalType,
+         typename WordPortalType>
+class ArrayPortalCompressed
+{
+public:
+  typedef T ValueType;
+
+  VTKM_SUPPRESS_EXEC_WARNINGS
+  VTKM_EXEC_CONT
+  ArrayPortalCompressed() : NumberOfValues(0), Tolerance(0) {  }
+
+  VTKM_SUPPRESS_EXEC_WARNINGS
+  VTKM_EXEC_CONT
+  ArrayPortalCompressed(const BasePortalType &bases,
+                        const OffsetPortalType &offsets,
+                        const WordPortalType &words,
+                        vtkm::Id numberOfValues,
+                        vtkm::Float64 tolerance)
+    : Bases(bases),
+      Offsets(offsets),
+      Words(words),
+      NumberOfValues(numberOfValues),
+      Tolerance(tolerance)
+  {  }
+
+  VTKM_SUPPRESS_EXEC_WARNINGS
+  VTKM_EXEC_CONT
+  vtkm::Id GetNumberOfValues() const { return this->NumberOfValues; }
+
+  VTKM_SUPPRESS_EXEC_WARNINGS
+  VTKM_EXEC_CONT
+  ValueType Get(vtkm::Id index) const
+  {
+    VTKM_ASSERT(index >= 0);
+    VTKM_ASSERT(index < this->NumberOfValues);
+
+    vtkm::Id blockIndex = index/COMPRESSED_BLOCK_SIZE;
+    vtkm::Id firstWord = this->Offsets.Get(blockIndex);
+    vtkm::Id bitWidth = this->Offsets.Get(blockIndex+1) - firstWord;
+
+    vtkm::UInt64 residual = 0;
+    if (bitWidth > 0)
+    {
+      vtkm::Id bitPosition = (index%COMPRESSED_BLOCK_SIZE)*bitWidth;
+      vtkm::Id wordIndex = firstWord + bitPosition/64;
+      vtkm::Id shift = bitPosition%64;
+      residual = this->Words.Get(wordIndex) >> shift;
+      if (shift + bitWidth > 64)
+      {
+        residual |= this->Words.Get(wordIndex+1) << (64 - shift);
+      }
+      if (bitWidth < 64)
+      {
+        residual &= (vtkm::UInt64(1) << bitWidth) - 1;
+      }
+    }
+
+    return CompressedDecode(residual,
+                            this->Bases.Get(blockIndex),
+                            (bitWidth < 64) ? this->Tolerance : 0.0);
+  }
+
+private:
+  BasePortalType Bases;
+  OffsetPortalType Offsets;
+  WordPortalType Words;
+  vtkm::Id NumberOfValues;
+  vtkm::Float64 Tolerance;
+};
+////
+//// END-EXAMPLE CompressedArrayPortal.cxx
+////
+
+////
+//// BEGIN-EXAMPLE CompressedArrayStorage.cxx
+////
+#include <vtkm/cont/ErrorBadValue.h>
+
+struct StorageTagCompressed {  };
+
+namespace vtkm {
+namespace cont {
+namespace internal {
+
+template<typename T>
+class Storage<T, StorageTagCompressed>
+{
+public:
+  typedef T ValueType;
+
+  typedef ArrayPortalCompressed<
+      T,
+      typename vtkm::cont::ArrayHandle<T>::PortalConstControl,
+      typename vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl,
+      typename vtkm::cont::ArrayHandle<vtkm::UInt64>::PortalConstControl>
+    PortalConstType;
+
+  // Compressed arrays are read-only.
+  typedef PortalConstType PortalType;
+
+  VTKM_CONT
+  Storage() : NumberOfValues(0), Tolerance(0) {  }
+
+  VTKM_CONT
+  Storage(const vtkm::cont::ArrayHandle<T> &bases,
+          const vtkm::cont::ArrayHandle<vtkm::Id> &offsets,
+          const vtkm::cont::ArrayHandle<vtkm::UInt64> &words,
+          vtkm::Id numberOfValues,
+          vtkm::Float64 tolerance)
+    : Bases(bases),
+      Offsets(offsets),
+      Words(words),
+      NumberOfValues(numberOfValues),
+      Tolerance(tolerance)
+  {  }
+
+  VTKM_CONT
+  PortalType GetPortal()
+  {
+    throw vtkm::cont::ErrorBadValue("Compressed arrays are read-only.");
+  }
+
+  VTKM_CONT
+  PortalConstType GetPortalConst() const
+  {
+    return PortalConstType(this->Bases.GetPortalConstControl(),
+                           this->Offsets.GetPortalConstControl(),
+                           this->Words.GetPortalConstControl(),
+                           this->NumberOfValues,
+                           this->Tolerance);
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfValues() const { return this->NumberOfValues; }
+
+  VTKM_CONT
+  void Allocate(vtkm::Id vtkmNotUsed(numberOfValues))
+  {
+    throw vtkm::cont::ErrorBadValue("Compressed arrays are read-only.");
+  }
+
+  VTKM_CONT
+  void Shrink(vtkm::Id vtkmNotUsed(numberOfValues))
+  {
+    throw vtkm::cont::ErrorBadValue("Compressed arrays are read-only.");
+  }
+
+  VTKM_CONT
+  void ReleaseResources()
+  {
+    this->Bases.ReleaseResources();
+    this->Offsets.ReleaseResources();
+    this->Words.ReleaseResources();
+    this->NumberOfValues = 0;
+  }
+
+  VTKM_CONT
+  vtkm::Id GetCompressedSizeInBytes() const
+  {
+    return
+        this->Bases.GetNumberOfValues()*
+          static_cast<vtkm::Id>(sizeof(T)) +
+        this->Offsets.GetNumberOfValues()*
+          static_cast<vtkm::Id>(sizeof(vtkm::Id)) +
+        this->Words.GetNumberOfValues()*
+          static_cast<vtkm::Id>(sizeof(vtkm::UInt64));
+  }
+
+  // Required for later use in ArrayTransfer class.
+  VTKM_CONT
+  const vtkm::cont::ArrayHandle<T> &GetBases() const { return this->Bases; }
+  VTKM_CONT
+  const vtkm::cont::ArrayHandle<vtkm::Id> &GetOffsets() const
+  {
+    return this->Offsets;
+  }
+  VTKM_CONT
+  const vtkm::cont::ArrayHandle<vtkm::UInt64> &GetWords() const
+  {
+    return this->Words;
+  }
+  VTKM_CONT
+  vtkm::Float64 GetTolerance() const { return this->Tolerance; }
+
+private:
+  vtkm::cont::ArrayHandle<T> Bases;
+  vtkm::cont::ArrayHandle<vtkm::Id> Offsets;
+  vtkm::cont::ArrayHandle<vtkm::UInt64> Words;
+  vtkm::Id NumberOfValues;
+  vtkm::Float64 Tolerance;
+};
+
+template<typename T, typename Device>
+class ArrayTransfer<T, StorageTagCompressed, Device>
+{
+public:
+  typedef T ValueType;
+
+private:
+  typedef vtkm::cont::internal::Storage<T, StorageTagCompressed> StorageType;
+
+public:
+  typedef typename StorageType::PortalType PortalControl;
+  typedef typename StorageType::PortalConstType PortalConstControl;
+
+  typedef ArrayPortalCompressed<
+      T,
+      typename vtkm::cont::ArrayHandle<T>::
+        template ExecutionTypes<Device>::PortalConst,
+      typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::PortalConst,
+      typename vtkm::cont::ArrayHandle<vtkm::UInt64>::
+        template ExecutionTypes<Device>::PortalConst>
+    PortalConstExecution;
+  typedef PortalConstExecution PortalExecution;
+
+  VTKM_CONT
+  ArrayTransfer(StorageType *storage)
+    : Bases(storage->GetBases()),
+      Offsets(storage->GetOffsets()),
+      Words(storage->GetWords()),
+      NumberOfValues(storage->GetNumberOfValues()),
+      Tolerance(storage->GetTolerance())
+  {  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfValues() const { return this->NumberOfValues; }
+
+  VTKM_CONT
+  PortalConstExecution PrepareForInput(bool vtkmNotUsed(updateData))
+  {
+    // Only the compressed representation is moved to the device. Values are
+    // decompressed as they are read from the portal.
+    return PortalConstExecution(this->Bases.PrepareForInput(Device()),
+                                this->Offsets.PrepareForInput(Device()),
+                                this->Words.PrepareForInput(Device()),
+                                this->NumberOfValues,
+                                this->Tolerance);
+  }
+
+  VTKM_CONT
+  PortalExecution PrepareForInPlace(bool vtkmNotUsed(updateData))
+  {
+    throw vtkm::cont::ErrorBadValue("Compressed arrays are read-only.");
+  }
+
+  VTKM_CONT
+  PortalExecution PrepareForOutput(vtkm::Id vtkmNotUsed(numberOfValues))
+  {
+    throw vtkm::cont::ErrorBadValue("Compressed arrays are read-only.");
+  }
+
+  VTKM_CONT
+  void RetrieveOutputData(StorageType *vtkmNotUsed(storage)) const
+  {
+    // Compressed arrays are never used for output.
+  }
+
+  VTKM_CONT
+  void Shrink(vtkm::Id vtkmNotUsed(numberOfValues))
+  {
+    throw vtkm::cont::ErrorBadValue("Compressed arrays are read-only.");
+  }
+
+  VTKM_CONT
+  void ReleaseResources()
+  {
+    this->Bases.ReleaseResourcesExecution();
+    this->Offsets.ReleaseResourcesExecution();
+    this->Words.ReleaseResourcesExecution();
+  }
+
+private:
+  vtkm::cont::ArrayHandle<T> Bases;
+  vtkm::cont::ArrayHandle<vtkm::Id> Offsets;
+  vtkm::cont::ArrayHandle<vtkm::UInt64> Words;
+  vtkm::Id NumberOfValues;
+  vtkm::Float64 Tolerance;
+};
+
+}
+}
+} // namespace vtkm::cont::internal
+////
+//// END-EXAMPLE CompressedArrayStorage.cxx
+////
+
+////
+//// BEGIN-EXAMPLE CompressedArrayHandle.cxx
+////
+template<typename T>
+class ArrayHandleCompressed
+    : public vtkm::cont::ArrayHandle<T, StorageTagCompressed>
+{
+public:
+  VTKM_ARRAY_HANDLE_SUBCLASS(
+      ArrayHandleCompressed,
+      (ArrayHandleCompressed<T>),
+      (vtkm::cont::ArrayHandle<T, StorageTagCompressed>));
+
+private:
+  typedef vtkm::cont::internal::Storage<T, StorageTagCompressed> StorageType;
+
+public:
+  VTKM_CONT
+  ArrayHandleCompressed(const vtkm::cont::ArrayHandle<T> &bases,
+                        const vtkm::cont::ArrayHandle<vtkm::Id> &offsets,
+                        const vtkm::cont::ArrayHandle<vtkm::UInt64> &words,
+                        vtkm::Id numberOfValues,
+                        vtkm::Float64 tolerance)
+    : Superclass(StorageType(bases, offsets, words, numberOfValues, tolerance))
+  {  }
+
+  VTKM_CONT
+  vtkm::Id GetCompressedSizeInBytes() const
+  {
+    return this->GetStorage().GetCompressedSizeInBytes();
+  }
+};
+////
+//// END-EXAMPLE CompressedArrayHandle.cxx
+////
+
+////
+//// BEGIN-EXAMPLE CompressArray.cxx
+////
+#include <vtkm/cont/DeviceAdapter.h>
+
+#include <vtkm/exec/FunctorBase.h>
+
+template<typename InPortalType, typename BasePortalType, typename WidthPortalType>
+struct CompressBlockHeaderFunctor : public vtkm::exec::FunctorBase
+{
+  typedef typename InPortalType::ValueType ValueType;
+
+  InPortalType Input;
+  BasePortalType Bases;
+  WidthPortalType Widths;
+  vtkm::Float64 Tolerance;
+
+  VTKM_CONT
+  CompressBlockHeaderFunctor(const InPortalType &input,
+                             const BasePortalType &bases,
+                             const WidthPortalType &widths,
+                             vtkm::Float64 tolerance)
+    : Input(input), Bases(bases), Widths(widths), Tolerance(tolerance) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id blockIndex) const
+  {
+    if (blockIndex == this->Bases.GetNumberOfValues())
+    {
+      // An extra entry with no width makes the scan of the widths end with
+      // the total number of words.
+      this->Widths.Set(blockIndex, 0);
+      return;
+    }
+
+    vtkm::Id begin = blockIndex*COMPRESSED_BLOCK_SIZE;
+    vtkm::Id end = begin + COMPRESSED_BLOCK_SIZE;
+    if (end > this->Input.GetNumberOfValues())
+    {
+      end = this->Input.GetNumberOfValues();
+    }
+
+    ValueType base = this->Input.Get(begin);
+    for (vtkm::Id index = begin+1; index < end; index++)
+    {
+      ValueType value = this->Input.Get(index);
+      base = (value < base) ? value : base;
+    }
+
+    vtkm::UInt64 maxResidual = 0;
+    for (vtkm::Id index = begin; index < end; index++)
+    {
+      vtkm::UInt64 residual =
+          CompressedEncode(this->Input.Get(index), base, this->Tolerance);
+      maxResidual = (residual > maxResidual) ? residual : maxResidual;
+    }
+
+    vtkm::Id bitWidth = 0;
+    while (maxResidual > 0)
+    {
+      bitWidth++;
+      maxResidual >>= 1;
+    }
+
+    this->Bases.Set(blockIndex, base);
+    this->Widths.Set(blockIndex, bitWidth);
+  }
+};
+
+template<typename InPortalType,
+         typename BasePortalType,
+         typename OffsetPortalType,
+         typename WordPortalType>
+struct CompressBlockPackFunctor : public vtkm::exec::FunctorBase
+{
+  InPortalType Input;
+  BasePortalType Bases;
+  OffsetPortalType Offsets;
+  WordPortalType Words;
+  vtkm::Float64 Tolerance;
+
+  VTKM_CONT
+  CompressBlockPackFunctor(const InPortalType &input,
+                           const BasePortalType &bases,
+                           const OffsetPortalType &offsets,
+                           const WordPortalType &words,
+                           vtkm::Float64 tolerance)
+    : Input(input),
+      Bases(bases),
+      Offsets(offsets),
+      Words(words),
+      Tolerance(tolerance)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id blockIndex) const
+  {
+    vtkm::Id wordIndex = this->Offsets.Get(blockIndex);
+    vtkm::Id bitWidth = this->Offsets.Get(blockIndex+1) - wordIndex;
+    if (bitWidth == 0) { return; }
+
+    vtkm::Id begin = blockIndex*COMPRESSED_BLOCK_SIZE;
+    vtkm::Id numValues = this->Input.GetNumberOfValues();
+    typename BasePortalType::ValueType base = this->Bases.Get(blockIndex);
+
+    // Lossy residuals too large to quantize make the block 64 bits wide,
+    // and such blocks are stored losslessly.
+    vtkm::Float64 tolerance = (bitWidth < 64) ? this->Tolerance : 0.0;
+
+    // Each block fills exactly bitWidth words, so blocks can be written
+    // independently.
+    vtkm::UInt64 word = 0;
+    vtkm::Id bitsInWord = 0;
+    for (vtkm::Id localIndex = 0;
+         localIndex < COMPRESSED_BLOCK_SIZE;
+         localIndex++)
+    {
+      vtkm::Id index = begin + localIndex;
+      vtkm::UInt64 residual = (index < numValues) ?
+            CompressedEncode(this->Input.Get(index), base, tolerance) :
+            0;
+      word |= residual << bitsInWord;
+      if (bitsInWord + bitWidth >= 64)
+      {
+        this->Words.Set(wordIndex, word);
+        wordIndex++;
+        vtkm::Id bitsWritten = 64 - bitsInWord;
+        word = (bitsWritten < 64) ? (residual >> bitsWritten) : 0;
+        bitsInWord = bitsInWord + bitWidth - 64;
+      }
+      else
+      {
+        bitsInWord += bitWidth;
+      }
+    }
+  }
+};
+
+template<typename T, typename StorageTag, typename Device>
+VTKM_CONT
+ArrayHandleCompressed<T>
+CompressArray(const vtkm::cont::ArrayHandle<T,StorageTag> &input,
+              vtkm::Float64 tolerance,
+              Device)
+{
+  typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+
+  typedef typename vtkm::cont::ArrayHandle<T,StorageTag>::
+      template ExecutionTypes<Device>::PortalConst InPortalType;
+  typedef typename vtkm::cont::ArrayHandle<T>::
+      template ExecutionTypes<Device>::Portal BasePortalType;
+  typedef typename vtkm::cont::ArrayHandle<T>::
+      template ExecutionTypes<Device>::PortalConst BaseConstPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal IdPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::PortalConst IdConstPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::UInt64>::
+      template ExecutionTypes<Device>::Portal WordPortalType;
+
+  vtkm::Id numValues = input.GetNumberOfValues();
+  vtkm::Id numBlocks =
+      (numValues + COMPRESSED_BLOCK_SIZE - 1)/COMPRESSED_BLOCK_SIZE;
+
+  // Find the base value and bit width of each block.
+  vtkm::cont::ArrayHandle<T> bases;
+  vtkm::cont::ArrayHandle<vtkm::Id> bitWidths;
+  CompressBlockHeaderFunctor<InPortalType,BasePortalType,IdPortalType>
+      headerFunctor(input.PrepareForInput(Device()),
+                    bases.PrepareForOutput(numBlocks, Device()),
+                    bitWidths.PrepareForOutput(numBlocks+1, Device()),
+                    tolerance);
+  Algorithm::Schedule(headerFunctor, numBlocks+1);
+
+  // The scan of the bit widths gives where each block starts in the packed
+  // words and the total number of words.
+  vtkm::cont::ArrayHandle<vtkm::Id> offsets;
+  vtkm::Id numWords = Algorithm::ScanExclusive(bitWidths, offsets);
+
+  vtkm::cont::ArrayHandle<vtkm::UInt64> words;
+  CompressBlockPackFunctor<InPortalType,
+                           BaseConstPortalType,
+                           IdConstPortalType,
+                           WordPortalType>
+      packFunctor(input.PrepareForInput(Device()),
+                  bases.PrepareForInput(Device()),
+                  offsets.PrepareForInput(Device()),
+                  words.PrepareForOutput(numWords, Device()),
+                  tolerance);
+  if (numBlocks > 0)
+  {
+    Algorithm::Schedule(packFunctor, numBlocks);
+  }
+
+  return ArrayHandleCompressed<T>(bases, offsets, words, numValues, tolerance);
+}
+
+template<typename T, typename StorageTag, typename Device>
+VTKM_CONT
+ArrayHandleCompressed<T>
+CompressArrayLossless(const vtkm::cont::ArrayHandle<T,StorageTag> &input,
+                      Device)
+{
+  return CompressArray(input, 0.0, Device());
+}
+
+// Every decompressed value is within tolerance of the original value (up to
+// the precision of T).
+template<typename T, typename StorageTag, typename Device>
+VTKM_CONT
+ArrayHandleCompressed<T>
+CompressArrayLossy(const vtkm::cont::ArrayHandle<T,StorageTag> &input,
+                   vtkm::Float64 tolerance,
+                   Device)
+{
+  if (!(tolerance > 0))
+  {
+    throw vtkm::cont::ErrorBadValue("Lossy compression needs a tolerance > 0.");
+  }
+  return CompressArray(input, tolerance, Device());
+}
+////
+//// END-EXAMPLE CompressArray.cxx
+////
+
+#include <vtkm/cont/ArrayHandleConstant.h>
+#include <vtkm/cont/Timer.h>
+
+#include <vtkm/worklet/DispatcherMapField.h>
+#include <vtkm/worklet/WorkletMapField.h>
+
+#include <vtkm/Math.h>
+
+#include <vtkm/cont/testing/Testing.h>
+
+#include <limits>
+
+namespace {
+
+typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+struct SquareWorklet : vtkm::worklet::WorkletMapField
+{
+  typedef void ControlSignature(FieldIn<Scalar>, FieldOut<Scalar>);
+  typedef _2 ExecutionSignature(_1);
+
+  template<typename T>
+  VTKM_EXEC
+  T operator()(T value) const { return value*value; }
+};
+
+// A smooth scalar field over a uniform grid, similar to what the point
+// elevation filter produces.
+template<typename T>
+vtkm::cont::ArrayHandle<T> MakeSmoothField(vtkm::Id3 dimensions)
+{
+  vtkm::cont::ArrayHandle<T> field;
+  field.Allocate(dimensions[0]*dimensions[1]*dimensions[2]);
+  vtkm::Id index = 0;
+  for (vtkm::Id k = 0; k < dimensions[2]; k++)
+  {
+    for (vtkm::Id j = 0; j < dimensions[1]; j++)
+    {
+      for (vtkm::Id i = 0; i < dimensions[0]; i++)
+      {
+        vtkm::Float64 x = static_cast<vtkm::Float64>(i)/
+            static_cast<vtkm::Float64>(dimensions[0]);
+        vtkm::Float64 y = static_cast<vtkm::Float64>(j)/
+            static_cast<vtkm::Float64>(dimensions[1]);
+        vtkm::Float64 z = static_cast<vtkm::Float64>(k)/
+            static_cast<vtkm::Float64>(dimensions[2]);
+        field.GetPortalControl().Set(
+              index, static_cast<T>(100*vtkm::Sin(3*x)*vtkm::Cos(2*y) + z));
+        index++;
+      }
+    }
+  }
+  return field;
+}
+
+template<typename T>
+void CheckDecompressed(const vtkm::cont::ArrayHandle<T> &original,
+                       const ArrayHandleCompressed<T> &compressed,
+                       vtkm::Float64 tolerance)
+{
+  VTKM_TEST_ASSERT(
+        compressed.GetNumberOfValues() == original.GetNumberOfValues(),
+        "Compressed array has wrong size.");
+
+  // Decompress in the execution environment.
+  vtkm::cont::ArrayHandle<T> decompressed;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(compressed, decompressed);
+
+  // Allow the rounding error of converting the decompressed value to T.
+  const vtkm::Float64 epsilon = std::numeric_limits<T>::epsilon();
+
+  typename vtkm::cont::ArrayHandle<T>::PortalConstControl originalPortal =
+      original.GetPortalConstControl();
+  typename ArrayHandleCompressed<T>::PortalConstControl compressedPortal =
+      compressed.GetPortalConstControl();
+  for (vtkm::Id index = 0; index < original.GetNumberOfValues(); index++)
+  {
+    T expected = originalPortal.Get(index);
+    T decompressedValue = decompressed.GetPortalConstControl().Get(index);
+    VTKM_TEST_ASSERT(decompressedValue == compressedPortal.Get(index),
+                     "Control and execution decompression differ.");
+    if (tolerance > 0)
+    {
+      vtkm::Float64 error =
+          vtkm::Abs(static_cast<vtkm::Float64>(decompressedValue) -
+                    static_cast<vtkm::Float64>(expected));
+      VTKM_TEST_ASSERT(error <= tolerance + 2*epsilon*vtkm::Abs(expected),
+                       "Lossy compression exceeded tolerance.");
+    }
+    else
+    {
+      VTKM_TEST_ASSERT(decompressedValue == expected,
+                       "Lossless compression changed a value.");
+    }
+  }
+}
+
+template<typename T>
+void TryCompression()
+{
+  std::cout << "Trying compression of "
+            << (sizeof(T) == 4 ? "Float32" : "Float64") << std::endl;
+
+  // Use a size that does not divide evenly into blocks.
+  vtkm::cont::ArrayHandle<T> field = MakeSmoothField<T>(vtkm::Id3(31, 17, 9));
+  vtkm::Id originalSize =
+      field.GetNumberOfValues()*static_cast<vtkm::Id>(sizeof(T));
+
+  ////
+  //// BEGIN-EXAMPLE UsingArrayHandleCompressed.cxx
+  ////
+  ArrayHandleCompressed<T> losslessArray =
+      CompressArrayLossless(field, Device());
+
+  ArrayHandleCompressed<T> lossyArray =
+      CompressArrayLossy(field, 0.01, Device());
+
+  // Compressed arrays can be used as input to worklets. Values are
+  // decompressed as they are read.
+  vtkm::cont::ArrayHandle<T> squaredField;
+  vtkm::worklet::DispatcherMapField<SquareWorklet> dispatcher;
+  dispatcher.Invoke(lossyArray, squaredField);
+  ////
+  //// END-EXAMPLE UsingArrayHandleCompressed.cxx
+  ////
+
+  CheckDecompressed(field, losslessArray, 0.0);
+  CheckDecompressed(field, lossyArray, 0.01);
+
+  std::cout << "  Lossless ratio: "
+            << static_cast<vtkm::Float64>(originalSize)/
+                 static_cast<vtkm::Float64>(
+                   losslessArray.GetCompressedSizeInBytes())
+            << std::endl;
+  std::cout << "  Lossy ratio: "
+            << static_cast<vtkm::Float64>(originalSize)/
+                 static_cast<vtkm::Float64>(
+                   lossyArray.GetCompressedSizeInBytes())
+            << std::endl;
+  VTKM_TEST_ASSERT(lossyArray.GetCompressedSizeInBytes() < originalSize/2,
+                   "Smooth field did not compress well.");
+
+  VTKM_TEST_ASSERT(squaredField.GetNumberOfValues() == field.GetNumberOfValues(),
+                   "Worklet output has wrong size.");
+
+  // A constant field needs no residual bits at all.
+  vtkm::cont::ArrayHandle<T> constantField;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+        vtkm::cont::make_ArrayHandleConstant(T(5), 1000), constantField);
+  ArrayHandleCompressed<T> constantArray =
+      CompressArrayLossless(constantField, Device());
+  CheckDecompressed(constantField, constantArray, 0.0);
+  VTKM_TEST_ASSERT(constantArray.GetStorage().GetWords().GetNumberOfValues()
+                     == 0,
+                   "Constant field should need no residuals.");
+
+  // Negative values and mixed signs must survive the lossless mode.
+  vtkm::cont::ArrayHandle<T> mixedField;
+  mixedField.Allocate(200);
+  for (vtkm::Id index = 0; index < 200; index++)
+  {
+    mixedField.GetPortalControl().Set(
+          index, static_cast<T>(index%7 - 3)*static_cast<T>(1.5*index));
+  }
+  CheckDecompressed(mixedField, CompressArrayLossless(mixedField, Device()), 0.0);
+
+  // Values far from their block base cannot be quantized with a small
+  // tolerance. Those blocks fall back to lossless storage.
+  vtkm::cont::ArrayHandle<T> wideField;
+  wideField.Allocate(200);
+  for (vtkm::Id index = 0; index < 200; index++)
+  {
+    wideField.GetPortalControl().Set(
+          index, (index%3 == 0) ? static_cast<T>(1e30) : static_cast<T>(index));
+  }
+  CheckDecompressed(wideField, CompressArrayLossy(wideField, 0.01, Device()), 0.01);
+}
+
+template<typename T>
+void BenchmarkCompression(vtkm::Float64 tolerance)
+{
+  vtkm::cont::ArrayHandle<T> field =
+      MakeSmoothField<T>(vtkm::Id3(128, 128, 64));
+  vtkm::Id originalSize =
+      field.GetNumberOfValues()*static_cast<vtkm::Id>(sizeof(T));
+  vtkm::Float64 megabytes =
+      static_cast<vtkm::Float64>(originalSize)/(1024*1024);
+  field.PrepareForInput(Device());
+
+  vtkm::cont::Timer<Device> timer;
+  ArrayHandleCompressed<T> compressed =
+      CompressArray(field, tolerance, Device());
+  vtkm::Float64 compressTime = timer.GetElapsedTime();
+
+  timer.Reset();
+  vtkm::cont::ArrayHandle<T> decompressed;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(compressed, decompressed);
+  vtkm::Float64 decompressTime = timer.GetElapsedTime();
+
+  std::cout << "  " << (tolerance > 0 ? "Lossy   " : "Lossless")
+            << " ratio: "
+            << static_cast<vtkm::Float64>(originalSize)/
+                 static_cast<vtkm::Float64>(
+                   compressed.GetCompressedSizeInBytes())
+            << "  compress: " << megabytes/compressTime << " MB/s"
+            << "  decompress: " << megabytes/decompressTime << " MB/s"
+            << std::endl;
+}
+
+void Test()
+{
+  TryCompression<vtkm::Float32>();
+  TryCompression<vtkm::Float64>();
+
+  std::cout << "Benchmarking compression of Float32 field." << std::endl;
+  BenchmarkCompression<vtkm::Float32>(0.0);
+  BenchmarkCompression<vtkm::Float32>(0.01);
+  std::cout << "Benchmarking compression of Float64 field." << std::endl;
+  BenchmarkCompression<vtkm::Float64>(0.0);
+  BenchmarkCompression<vtkm::Float64>(0.01);
+}
+
+} // anonymous namespace
+
+int CompressedFieldStorage(int, char *[])
+{
+  return vtkm::cont::testing::Testing::Run(Test);
+}
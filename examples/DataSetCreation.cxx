@@ -1,13 +1,26 @@
+#include "BenchmarkHelpers.h"
+#include "ReplaceCellSet.h"
+
+#include <vtkm/cont/ArrayHandleZip.h>
+#include <vtkm/cont/ArrayPortalToIterators.h>
 #include <vtkm/cont/CellSetPermutation.h>
+#include <vtkm/cont/CellSetSingleType.h>
 #include <vtkm/cont/DataSetBuilderExplicit.h>
 #include <vtkm/cont/DataSetBuilderRectilinear.h>
 #include <vtkm/cont/DataSetBuilderUniform.h>
 #include <vtkm/cont/DataSetFieldAdd.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/ErrorBadValue.h>
+
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/Math.h>
 
 #include <vtkm/cont/testing/Testing.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace DataSetCreationNamespace {
 
 void CreateUniformGrid()
@@ -378,6 +391,817 @@ void AddFieldData()
   ////
 }
 
+////
+//// BEGIN-EXAMPLE DataSetBuilderExplicitBulk.cxx
+////
+// Copies one builder's array into the merged array at the given offset.
+template<typename T, typename Device>
+struct AppendArrayFunctor : public vtkm::exec::FunctorBase
+{
+  typedef typename vtkm::cont::ArrayHandle<T>::
+      template ExecutionTypes<Device>::PortalConst InPortalType;
+  typedef typename vtkm::cont::ArrayHandle<T>::
+      template ExecutionTypes<Device>::Portal OutPortalType;
+
+  InPortalType Input;
+  OutPortalType Output;
+  vtkm::Id OutputOffset;
+
+  VTKM_CONT
+  AppendArrayFunctor(const InPortalType &input,
+                     const OutPortalType &output,
+                     vtkm::Id outputOffset)
+    : Input(input), Output(output), OutputOffset(outputOffset)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id index) const
+  {
+    this->Output.Set(this->OutputOffset + index, this->Input.Get(index));
+  }
+};
+
+// Like AppendArrayFunctor, but also shifts the point indices of a builder by
+// the number of points in the builders before it.
+template<typename Device>
+struct AppendConnectivityFunctor : public vtkm::exec::FunctorBase
+{
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::PortalConst InPortalType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal OutPortalType;
+
+  InPortalType Input;
+  OutPortalType Output;
+  vtkm::Id OutputOffset;
+  vtkm::Id PointOffset;
+
+  VTKM_CONT
+  AppendConnectivityFunctor(const InPortalType &input,
+                            const OutPortalType &output,
+                            vtkm::Id outputOffset,
+                            vtkm::Id pointOffset)
+    : Input(input),
+      Output(output),
+      OutputOffset(outputOffset),
+      PointOffset(pointOffset)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id index) const
+  {
+    this->Output.Set(this->OutputOffset + index,
+                     this->Input.Get(index) + this->PointOffset);
+  }
+};
+
+// Builds an explicit data set from points and cells added in batches. The
+// values are written straight into ArrayHandles, and Create hands those
+// arrays to the data set without copying them. Several builders can be
+// filled independently (for example, one per thread) and merged in parallel.
+class DataSetBuilderExplicitBulk
+{
+public:
+  typedef vtkm::Vec<vtkm::Float32,3> PointType;
+
+  VTKM_CONT
+  DataSetBuilderExplicitBulk()
+    : NumberOfPoints(0), NumberOfCells(0), ConnectivitySize(0)
+  {  }
+
+  // Allocates space for the given number of points, cells, and point indices
+  // so that adding them does not reallocate.
+  VTKM_CONT
+  void Reserve(vtkm::Id numPoints, vtkm::Id numCells, vtkm::Id connectivitySize)
+  {
+    Grow(this->Points, this->NumberOfPoints, numPoints);
+    Grow(this->Shapes, this->NumberOfCells, numCells);
+    Grow(this->NumIndices, this->NumberOfCells, numCells);
+    Grow(this->Connectivity, this->ConnectivitySize, connectivitySize);
+  }
+
+  // Adds points and returns the index of the first one.
+  VTKM_CONT
+  vtkm::Id AddPoints(const PointType *points, vtkm::Id numPoints)
+  {
+    vtkm::Id firstPoint = this->NumberOfPoints;
+    Grow(this->Points, this->NumberOfPoints, firstPoint + numPoints);
+    std::copy(points,
+              points + numPoints,
+              vtkm::cont::ArrayPortalToIteratorBegin(
+                this->Points.GetPortalControl()) + firstPoint);
+    this->NumberOfPoints += numPoints;
+    return firstPoint;
+  }
+
+  // Adds cells of any shapes. connectivity holds the point indices of all
+  // the cells back to back. Returns the index of the first cell.
+  VTKM_CONT
+  vtkm::Id AddCells(const vtkm::UInt8 *shapes,
+                    const vtkm::IdComponent *numIndices,
+                    vtkm::Id numCells,
+                    const vtkm::Id *connectivity)
+  {
+    vtkm::Id connectivitySize = 0;
+    for (vtkm::Id cellIndex = 0; cellIndex < numCells; ++cellIndex)
+    {
+      connectivitySize += numIndices[cellIndex];
+    }
+
+    vtkm::Id firstCell = this->NumberOfCells;
+    Grow(this->Shapes, this->NumberOfCells, firstCell + numCells);
+    Grow(this->NumIndices, this->NumberOfCells, firstCell + numCells);
+    std::copy(shapes,
+              shapes + numCells,
+              vtkm::cont::ArrayPortalToIteratorBegin(
+                this->Shapes.GetPortalControl()) + firstCell);
+    std::copy(numIndices,
+              numIndices + numCells,
+              vtkm::cont::ArrayPortalToIteratorBegin(
+                this->NumIndices.GetPortalControl()) + firstCell);
+    this->NumberOfCells += numCells;
+
+    this->AppendConnectivity(connectivity, connectivitySize);
+    return firstCell;
+  }
+
+  // Adds cells that all have the same shape and number of points.
+  VTKM_CONT
+  vtkm::Id AddCells(vtkm::UInt8 shape,
+                    vtkm::IdComponent pointsPerCell,
+                    vtkm::Id numCells,
+                    const vtkm::Id *connectivity)
+  {
+    vtkm::Id firstCell = this->NumberOfCells;
+    Grow(this->Shapes, this->NumberOfCells, firstCell + numCells);
+    Grow(this->NumIndices, this->NumberOfCells, firstCell + numCells);
+    std::fill_n(vtkm::cont::ArrayPortalToIteratorBegin(
+                  this->Shapes.GetPortalControl()) + firstCell,
+                numCells,
+                shape);
+    std::fill_n(vtkm::cont::ArrayPortalToIteratorBegin(
+                  this->NumIndices.GetPortalControl()) + firstCell,
+                numCells,
+                pointsPerCell);
+    this->NumberOfCells += numCells;
+
+    this->AppendConnectivity(connectivity, numCells*pointsPerCell);
+    return firstCell;
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfPoints() const { return this->NumberOfPoints; }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfCells() const { return this->NumberOfCells; }
+
+  // Moves the arrays into a new data set. The builder is empty afterward.
+  VTKM_CONT
+  vtkm::cont::DataSet Create(const std::string &coordsName = "coords",
+                             const std::string &cellSetName = "cells")
+  {
+    this->Points.Shrink(this->NumberOfPoints);
+    this->Shapes.Shrink(this->NumberOfCells);
+    this->NumIndices.Shrink(this->NumberOfCells);
+    this->Connectivity.Shrink(this->ConnectivitySize);
+
+    vtkm::cont::DataSet dataSet = MakeDataSet(this->Points,
+                                              this->Shapes,
+                                              this->NumIndices,
+                                              this->Connectivity,
+                                              coordsName,
+                                              cellSetName);
+    *this = DataSetBuilderExplicitBulk();
+    return dataSet;
+  }
+
+  // Merges several builders into one data set. The point indices in each
+  // builder refer to that builder's own points, so a point shared by two
+  // builders must be added to both. The builders are handled one after
+  // another, and each array of each builder is copied into place with a
+  // parallel schedule on the given device. The builders are empty afterward.
+  template<typename Device>
+  VTKM_CONT
+  static vtkm::cont::DataSet
+  Create(std::vector<DataSetBuilderExplicitBulk> &builders,
+         Device,
+         const std::string &coordsName = "coords",
+         const std::string &cellSetName = "cells")
+  {
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    vtkm::Id numPoints = 0;
+    vtkm::Id numCells = 0;
+    vtkm::Id connectivitySize = 0;
+    for (std::size_t builderIndex = 0;
+         builderIndex < builders.size();
+         ++builderIndex)
+    {
+      DataSetBuilderExplicitBulk &builder = builders[builderIndex];
+      builder.Points.Shrink(builder.NumberOfPoints);
+      builder.Shapes.Shrink(builder.NumberOfCells);
+      builder.NumIndices.Shrink(builder.NumberOfCells);
+      builder.Connectivity.Shrink(builder.ConnectivitySize);
+      numPoints += builder.NumberOfPoints;
+      numCells += builder.NumberOfCells;
+      connectivitySize += builder.ConnectivitySize;
+    }
+
+    vtkm::cont::ArrayHandle<PointType> points;
+    vtkm::cont::ArrayHandle<vtkm::UInt8> shapes;
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> numIndices;
+    vtkm::cont::ArrayHandle<vtkm::Id> connectivity;
+    typename vtkm::cont::ArrayHandle<PointType>::
+        template ExecutionTypes<Device>::Portal pointsPortal =
+          points.PrepareForOutput(numPoints, Device());
+    typename vtkm::cont::ArrayHandle<vtkm::UInt8>::
+        template ExecutionTypes<Device>::Portal shapesPortal =
+          shapes.PrepareForOutput(numCells, Device());
+    typename vtkm::cont::ArrayHandle<vtkm::IdComponent>::
+        template ExecutionTypes<Device>::Portal numIndicesPortal =
+          numIndices.PrepareForOutput(numCells, Device());
+    typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::Portal connectivityPortal =
+          connectivity.PrepareForOutput(connectivitySize, Device());
+
+    vtkm::Id pointOffset = 0;
+    vtkm::Id cellOffset = 0;
+    vtkm::Id connectivityOffset = 0;
+    for (std::size_t builderIndex = 0;
+         builderIndex < builders.size();
+         ++builderIndex)
+    {
+      const DataSetBuilderExplicitBulk &builder = builders[builderIndex];
+      Algorithm::Schedule(
+            AppendArrayFunctor<PointType,Device>(
+              builder.Points.PrepareForInput(Device()),
+              pointsPortal,
+              pointOffset),
+            builder.NumberOfPoints);
+      Algorithm::Schedule(
+            AppendArrayFunctor<vtkm::UInt8,Device>(
+              builder.Shapes.PrepareForInput(Device()),
+              shapesPortal,
+              cellOffset),
+            builder.NumberOfCells);
+      Algorithm::Schedule(
+            AppendArrayFunctor<vtkm::IdComponent,Device>(
+              builder.NumIndices.PrepareForInput(Device()),
+              numIndicesPortal,
+              cellOffset),
+            builder.NumberOfCells);
+      Algorithm::Schedule(
+            AppendConnectivityFunctor<Device>(
+              builder.Connectivity.PrepareForInput(Device()),
+              connectivityPortal,
+              connectivityOffset,
+              pointOffset),
+            builder.ConnectivitySize);
+      pointOffset += builder.NumberOfPoints;
+      cellOffset += builder.NumberOfCells;
+      connectivityOffset += builder.ConnectivitySize;
+    }
+
+    builders.clear();
+    return MakeDataSet(
+          points, shapes, numIndices, connectivity, coordsName, cellSetName);
+  }
+
+private:
+  // Makes sure array can hold at least size values, keeping the first used
+  // values. Capacity at least doubles so that repeated adds stay amortized
+  // constant time.
+  template<typename T>
+  VTKM_CONT
+  static void Grow(vtkm::cont::ArrayHandle<T> &array,
+                   vtkm::Id used,
+                   vtkm::Id size)
+  {
+    vtkm::Id capacity = array.GetNumberOfValues();
+    if (size <= capacity) { return; }
+
+    vtkm::cont::ArrayHandle<T> newArray;
+    newArray.Allocate(vtkm::Max(size, 2*capacity));
+    if (used > 0)
+    {
+      std::copy(vtkm::cont::ArrayPortalToIteratorBegin(
+                  array.GetPortalConstControl()),
+                vtkm::cont::ArrayPortalToIteratorBegin(
+                  array.GetPortalConstControl()) + used,
+                vtkm::cont::ArrayPortalToIteratorBegin(
+                  newArray.GetPortalControl()));
+    }
+    array = newArray;
+  }
+
+  VTKM_CONT
+  void AppendConnectivity(const vtkm::Id *connectivity, vtkm::Id size)
+  {
+    Grow(this->Connectivity, this->ConnectivitySize,
+         this->ConnectivitySize + size);
+    std::copy(connectivity,
+              connectivity + size,
+              vtkm::cont::ArrayPortalToIteratorBegin(
+                this->Connectivity.GetPortalControl()) + this->ConnectivitySize);
+    this->ConnectivitySize += size;
+  }
+
+  VTKM_CONT
+  static vtkm::cont::DataSet
+  MakeDataSet(const vtkm::cont::ArrayHandle<PointType> &points,
+              const vtkm::cont::ArrayHandle<vtkm::UInt8> &shapes,
+              const vtkm::cont::ArrayHandle<vtkm::IdComponent> &numIndices,
+              const vtkm::cont::ArrayHandle<vtkm::Id> &connectivity,
+              const std::string &coordsName,
+              const std::string &cellSetName)
+  {
+    vtkm::cont::CellSetExplicit<> cellSet(cellSetName);
+    cellSet.Fill(points.GetNumberOfValues(), shapes, numIndices, connectivity);
+
+    vtkm::cont::DataSet dataSet;
+    dataSet.AddCoordinateSystem(
+          vtkm::cont::CoordinateSystem(coordsName, points));
+    dataSet.AddCellSet(cellSet);
+    return dataSet;
+  }
+
+  vtkm::cont::ArrayHandle<PointType> Points;
+  vtkm::cont::ArrayHandle<vtkm::UInt8> Shapes;
+  vtkm::cont::ArrayHandle<vtkm::IdComponent> NumIndices;
+  vtkm::cont::ArrayHandle<vtkm::Id> Connectivity;
+  vtkm::Id NumberOfPoints;
+  vtkm::Id NumberOfCells;
+  vtkm::Id ConnectivitySize;
+};
+////
+//// END-EXAMPLE DataSetBuilderExplicitBulk.cxx
+////
+
+void CreateExplicitGridBulk()
+{
+  std::cout << "Creating explicit grid in bulk." << std::endl;
+
+  ////
+  //// BEGIN-EXAMPLE CreateExplicitGridBulk.cxx
+  ////
+  const vtkm::Vec<vtkm::Float32,3> points[8] = {
+    vtkm::make_Vec(1.1f, 0.0f, 0.0f),
+    vtkm::make_Vec(0.2f, 0.4f, 0.0f),
+    vtkm::make_Vec(0.9f, 0.6f, 0.0f),
+    vtkm::make_Vec(1.4f, 0.5f, 0.0f),
+    vtkm::make_Vec(1.8f, 0.3f, 0.0f),
+    vtkm::make_Vec(0.4f, 1.0f, 0.0f),
+    vtkm::make_Vec(1.0f, 1.2f, 0.0f),
+    vtkm::make_Vec(1.5f, 0.9f, 0.0f)
+  };
+  const vtkm::UInt8 shapes[2] = { vtkm::CELL_SHAPE_QUAD,
+                                  vtkm::CELL_SHAPE_POLYGON };
+  const vtkm::IdComponent numIndices[2] = { 4, 5 };
+  const vtkm::Id mixedConnectivity[9] = { 0, 4, 3, 2,
+                                          2, 3, 7, 6, 5 };
+  const vtkm::Id triangleConnectivity[9] = { 0, 2, 1,
+                                             1, 2, 5,
+                                             3, 4, 7 };
+
+  DataSetBuilderExplicitBulk dataSetBuilder;
+  dataSetBuilder.Reserve(8, 5, 18);
+  dataSetBuilder.AddPoints(points, 8);
+  dataSetBuilder.AddCells(shapes, numIndices, 2, mixedConnectivity);
+  dataSetBuilder.AddCells(vtkm::CELL_SHAPE_TRIANGLE, 3, 3, triangleConnectivity);
+
+  vtkm::cont::DataSet dataSet = dataSetBuilder.Create();
+  ////
+  //// END-EXAMPLE CreateExplicitGridBulk.cxx
+  ////
+
+  vtkm::cont::CellSetExplicit<> cellSet;
+  dataSet.GetCellSet().CopyTo(cellSet);
+  VTKM_TEST_ASSERT(test_equal(cellSet.GetNumberOfPoints(), 8),
+                   "Data set has wrong number of points.");
+  VTKM_TEST_ASSERT(test_equal(cellSet.GetNumberOfCells(), 5),
+                   "Data set has wrong number of cells.");
+  VTKM_TEST_ASSERT(dataSetBuilder.GetNumberOfPoints() == 0,
+                   "Builder not reset by Create.");
+
+  vtkm::Bounds bounds = dataSet.GetCoordinateSystem().GetBounds();
+  std::cout << bounds << std::endl;
+
+  VTKM_TEST_ASSERT(test_equal(bounds, vtkm::Bounds(0.2,1.8,0.0,1.2,0.0,0.0)),
+                   "Bad bounds");
+
+  // The cells are in a different order than CreateExplicitGrid, but the
+  // number of cells incident on each point is the same.
+  cellSet.BuildConnectivity(VTKM_DEFAULT_DEVICE_ADAPTER_TAG(),
+                            vtkm::TopologyElementTagCell(),
+                            vtkm::TopologyElementTagPoint());
+  vtkm::cont::ArrayHandle<vtkm::IdComponent>::PortalConstControl numCellsPortal=
+      cellSet.GetNumIndicesArray(vtkm::TopologyElementTagCell(),
+                                 vtkm::TopologyElementTagPoint())
+      .GetPortalConstControl();
+  const vtkm::IdComponent expectedNumCells[8] = { 2, 2, 4, 3, 2, 2, 1, 2 };
+  for (vtkm::Id pointIndex = 0; pointIndex < 8; ++pointIndex)
+  {
+    VTKM_TEST_ASSERT(test_equal(numCellsPortal.Get(pointIndex),
+                                expectedNumCells[pointIndex]),
+                     "Wrong number of cells on point.");
+  }
+}
+
+// Builds a dim by dim grid of squares, each split into two triangles, with
+// one call per point and per cell index.
+vtkm::cont::DataSet MakeTriangleGridIterative(vtkm::Id dim)
+{
+  vtkm::cont::DataSetBuilderExplicitIterative iterativeBuilder;
+  iterativeBuilder.Begin();
+  for (vtkm::Id j = 0; j <= dim; ++j)
+  {
+    for (vtkm::Id i = 0; i <= dim; ++i)
+    {
+      iterativeBuilder.AddPoint(static_cast<vtkm::Float32>(i),
+                                static_cast<vtkm::Float32>(j),
+                                0.0f);
+    }
+  }
+  for (vtkm::Id j = 0; j < dim; ++j)
+  {
+    for (vtkm::Id i = 0; i < dim; ++i)
+    {
+      vtkm::Id corner = j*(dim+1) + i;
+      iterativeBuilder.AddCell(vtkm::CELL_SHAPE_TRIANGLE);
+      iterativeBuilder.AddCellPoint(corner);
+      iterativeBuilder.AddCellPoint(corner+1);
+      iterativeBuilder.AddCellPoint(corner+dim+2);
+      iterativeBuilder.AddCell(vtkm::CELL_SHAPE_TRIANGLE);
+      iterativeBuilder.AddCellPoint(corner);
+      iterativeBuilder.AddCellPoint(corner+dim+2);
+      iterativeBuilder.AddCellPoint(corner+dim+1);
+    }
+  }
+  return iterativeBuilder.Create();
+}
+
+// Builds the same grid as MakeTriangleGridIterative with numParts bulk
+// builders, which dim must be a multiple of. Each part holds a band of rows of
+// the grid and is filled independently of the others, so the parts could be
+// filled by separate threads. Point indices are local to each part, so every
+// part holds its own copy of the row of points it shares with the part below.
+template<typename Device>
+vtkm::cont::DataSet MakeTriangleGridBulk(vtkm::Id dim,
+                                         vtkm::Id numParts,
+                                         Device)
+{
+  vtkm::Id rowsPerPart = dim/numParts;
+  std::vector<DataSetBuilderExplicitBulk> parts(
+        static_cast<std::size_t>(numParts));
+  for (vtkm::Id part = 0; part < numParts; ++part)
+  {
+    DataSetBuilderExplicitBulk &builder = parts[static_cast<std::size_t>(part)];
+    vtkm::Id firstRow = part*rowsPerPart;
+    builder.Reserve((rowsPerPart+1)*(dim+1),
+                    2*rowsPerPart*dim,
+                    6*rowsPerPart*dim);
+
+    std::vector<vtkm::Vec<vtkm::Float32,3> > rowPoints(
+          static_cast<std::size_t>(dim+1));
+    for (vtkm::Id row = 0; row <= rowsPerPart; ++row)
+    {
+      vtkm::Id j = firstRow + row;
+      for (vtkm::Id i = 0; i <= dim; ++i)
+      {
+        rowPoints[static_cast<std::size_t>(i)] =
+            vtkm::make_Vec(static_cast<vtkm::Float32>(i),
+                           static_cast<vtkm::Float32>(j),
+                           0.0f);
+      }
+      builder.AddPoints(&rowPoints.front(), dim+1);
+    }
+
+    std::vector<vtkm::Id> rowConnectivity(static_cast<std::size_t>(6*dim));
+    for (vtkm::Id row = 0; row < rowsPerPart; ++row)
+    {
+      for (vtkm::Id i = 0; i < dim; ++i)
+      {
+        vtkm::Id corner = row*(dim+1) + i;
+        vtkm::Id *cellPoints = &rowConnectivity[static_cast<std::size_t>(6*i)];
+        cellPoints[0] = corner;
+        cellPoints[1] = corner+1;
+        cellPoints[2] = corner+dim+2;
+        cellPoints[3] = corner;
+        cellPoints[4] = corner+dim+2;
+        cellPoints[5] = corner+dim+1;
+      }
+      builder.AddCells(vtkm::CELL_SHAPE_TRIANGLE,
+                       3,
+                       2*dim,
+                       &rowConnectivity.front());
+    }
+  }
+  return DataSetBuilderExplicitBulk::Create(parts, Device());
+}
+
+void CreateExplicitGridBulkBenchmark()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id DIM = 512;
+  static const vtkm::Id NUM_PARTS = 4;
+
+  std::cout << "Timing builders on " << 2*DIM*DIM << " triangles."
+            << std::endl;
+
+  // Each call builds a new data set, so timing them repeatedly measures the
+  // whole build every time.
+  vtkm::cont::DataSet iterativeDataSet;
+  vtkm::Float64 iterativeTime = benchmark::AverageTime(
+        [&]() { iterativeDataSet = MakeTriangleGridIterative(DIM); },
+        Device());
+
+  vtkm::cont::DataSet bulkDataSet;
+  vtkm::Float64 bulkTime = benchmark::AverageTime(
+        [&]() { bulkDataSet = MakeTriangleGridBulk(DIM, NUM_PARTS, Device()); },
+        Device());
+
+  std::cout << "  One call per entity: " << iterativeTime << " s" << std::endl;
+  std::cout << "  Bulk, " << NUM_PARTS << " merged builders: " << bulkTime
+            << " s" << std::endl;
+
+  vtkm::cont::CellSetExplicit<> iterativeCellSet;
+  iterativeDataSet.GetCellSet().CopyTo(iterativeCellSet);
+  vtkm::cont::CellSetExplicit<> bulkCellSet;
+  bulkDataSet.GetCellSet().CopyTo(bulkCellSet);
+  // Every part after the first repeats one row of points.
+  VTKM_TEST_ASSERT(bulkCellSet.GetNumberOfPoints() ==
+                   iterativeCellSet.GetNumberOfPoints() +
+                   (NUM_PARTS-1)*(DIM+1),
+                   "Bulk builder has wrong number of points.");
+  VTKM_TEST_ASSERT(bulkCellSet.GetNumberOfCells() ==
+                   iterativeCellSet.GetNumberOfCells(),
+                   "Bulk builder has wrong number of cells.");
+
+  // The parts were filled in row order, so each cell of the merged data set
+  // should use the same point coordinates as the one from the iterative
+  // builder. The indices differ because of the duplicated rows.
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > iterativePoints;
+  iterativeDataSet.GetCoordinateSystem().GetData().CopyTo(iterativePoints);
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > bulkPoints;
+  bulkDataSet.GetCoordinateSystem().GetData().CopyTo(bulkPoints);
+  vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl iterativePortal =
+      iterativeCellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                            vtkm::TopologyElementTagCell())
+      .GetPortalConstControl();
+  vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl bulkPortal =
+      bulkCellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                       vtkm::TopologyElementTagCell())
+      .GetPortalConstControl();
+  VTKM_TEST_ASSERT(bulkPortal.GetNumberOfValues() ==
+                   iterativePortal.GetNumberOfValues(),
+                   "Bulk builder has wrong connectivity size.");
+  for (vtkm::Id index = 0; index < bulkPortal.GetNumberOfValues(); ++index)
+  {
+    VTKM_TEST_ASSERT(
+          bulkPoints.GetPortalConstControl().Get(bulkPortal.Get(index)) ==
+          iterativePoints.GetPortalConstControl().Get(
+            iterativePortal.Get(index)),
+          "Bulk builder has wrong connectivity.");
+  }
+}
+
+////
+//// BEGIN-EXAMPLE ConvertExplicitToSingleType.cxx
+////
+// Reduction operator that finds the one (shape, number of points) pair shared
+// by all cells. Values with a negative count are markers: NO_CELLS is the
+// identity and MIXED_CELLS means at least two cells differ.
+struct CommonCellTypeOperator
+{
+  typedef vtkm::Pair<vtkm::UInt8,vtkm::IdComponent> CellTypeType;
+
+  enum { NO_CELLS = -1, MIXED_CELLS = -2 };
+
+  VTKM_EXEC_CONT
+  CellTypeType operator()(const CellTypeType &a, const CellTypeType &b) const
+  {
+    if (a.second == NO_CELLS) { return b; }
+    if (b.second == NO_CELLS) { return a; }
+    if ((a.first == b.first) && (a.second == b.second)) { return a; }
+    return CellTypeType(vtkm::UInt8(vtkm::CELL_SHAPE_EMPTY), MIXED_CELLS);
+  }
+};
+
+// Checks the shapes and point counts of an explicit cell set in one parallel
+// reduction. If every cell has the same shape and the same number of points,
+// returns true and fills cellSetOut with a CellSetSingleType that shares the
+// connectivity array of cellSetIn. Otherwise returns false and leaves
+// cellSetOut alone.
+template<typename ShapeStorage,
+         typename NumIndicesStorage,
+         typename ConnectivityStorage,
+         typename OffsetsStorage,
+         typename Device>
+VTKM_CONT
+bool ConvertToSingleType(
+    const vtkm::cont::CellSetExplicit<
+      ShapeStorage,NumIndicesStorage,ConnectivityStorage,OffsetsStorage>
+        &cellSetIn,
+    vtkm::cont::CellSetSingleType<ConnectivityStorage> &cellSetOut,
+    Device)
+{
+  typedef CommonCellTypeOperator::CellTypeType CellTypeType;
+
+  CellTypeType commonType =
+      vtkm::cont::DeviceAdapterAlgorithm<Device>::Reduce(
+        vtkm::cont::make_ArrayHandleZip(
+          cellSetIn.GetShapesArray(vtkm::TopologyElementTagPoint(),
+                                   vtkm::TopologyElementTagCell()),
+          cellSetIn.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                       vtkm::TopologyElementTagCell())),
+        CellTypeType(vtkm::UInt8(vtkm::CELL_SHAPE_EMPTY),
+                     CommonCellTypeOperator::NO_CELLS),
+        CommonCellTypeOperator());
+
+  if (commonType.second < 0)
+  {
+    // Either there are no cells or the cells are of mixed type.
+    return false;
+  }
+
+  cellSetOut = vtkm::cont::CellSetSingleType<ConnectivityStorage>(
+        cellSetIn.GetName());
+  cellSetOut.Fill(cellSetIn.GetNumberOfPoints(),
+                  commonType.first,
+                  commonType.second,
+                  cellSetIn.GetConnectivityArray(
+                    vtkm::TopologyElementTagPoint(),
+                    vtkm::TopologyElementTagCell()));
+  return true;
+}
+
+// Returns a copy of the data set with each explicit cell set replaced by a
+// CellSetSingleType when all its cells have the same type. Other cell sets,
+// fields, and coordinate systems are shared with the original data set.
+template<typename Device>
+VTKM_CONT
+vtkm::cont::DataSet ConvertToSingleType(const vtkm::cont::DataSet &dataSetIn,
+                                        Device)
+{
+  vtkm::cont::DataSet dataSetOut = dataSetIn;
+  for (vtkm::Id cellSetIndex = 0;
+       cellSetIndex < dataSetIn.GetNumberOfCellSets();
+       ++cellSetIndex)
+  {
+    const vtkm::cont::DynamicCellSet &cellSetIn =
+        dataSetIn.GetCellSet(cellSetIndex);
+    if (!cellSetIn.IsType<vtkm::cont::CellSetExplicit<> >())
+    {
+      continue;
+    }
+
+    vtkm::cont::CellSetExplicit<> explicitCellSet;
+    cellSetIn.CopyTo(explicitCellSet);
+
+    vtkm::cont::CellSetSingleType<> singleTypeCellSet;
+    if (ConvertToSingleType(explicitCellSet, singleTypeCellSet, Device()))
+    {
+      dataSetOut = vtkm::cont::ReplaceCellSet(
+            dataSetOut, cellSetIndex, singleTypeCellSet);
+    }
+  }
+  return dataSetOut;
+}
+////
+//// END-EXAMPLE ConvertExplicitToSingleType.cxx
+////
+
+void ConvertExplicitToSingleType()
+{
+  std::cout << "Convert explicit cell set to single type." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  // A triangle strip built as a general explicit data set.
+  const vtkm::Id numTriangles = 100;
+  std::vector<vtkm::Vec<vtkm::Float32,3> > pointCoordinates;
+  for (vtkm::Id pointIndex = 0; pointIndex < numTriangles + 2; ++pointIndex)
+  {
+    pointCoordinates.push_back(
+          vtkm::Vec<vtkm::Float32,3>(static_cast<vtkm::Float32>(pointIndex/2),
+                                     static_cast<vtkm::Float32>(pointIndex%2),
+                                     0.0f));
+  }
+  std::vector<vtkm::UInt8> shapes;
+  std::vector<vtkm::IdComponent> numIndices;
+  std::vector<vtkm::Id> connectivity;
+  for (vtkm::Id cellIndex = 0; cellIndex < numTriangles; ++cellIndex)
+  {
+    shapes.push_back(vtkm::CELL_SHAPE_TRIANGLE);
+    numIndices.push_back(3);
+    connectivity.push_back(cellIndex);
+    connectivity.push_back(cellIndex+1);
+    connectivity.push_back(cellIndex+2);
+  }
+
+  vtkm::cont::DataSetBuilderExplicit dataSetBuilder;
+  vtkm::cont::DataSet triangleDataSet =
+      dataSetBuilder.Create(pointCoordinates, shapes, numIndices, connectivity);
+  vtkm::cont::DataSetFieldAdd dataSetFieldAdd;
+  dataSetFieldAdd.AddCellField(triangleDataSet,
+                               "cellvar",
+                               std::vector<vtkm::Float32>(numTriangles, 1.0f));
+
+  vtkm::cont::CellSetExplicit<> explicitCellSet;
+  triangleDataSet.GetCellSet().CopyTo(explicitCellSet);
+
+  vtkm::cont::CellSetSingleType<> singleTypeCellSet;
+  VTKM_TEST_ASSERT(
+        ConvertToSingleType(explicitCellSet, singleTypeCellSet, Device()),
+        "Triangle cell set not converted.");
+  VTKM_TEST_ASSERT(singleTypeCellSet.GetNumberOfCells() == numTriangles,
+                   "Wrong number of cells.");
+  VTKM_TEST_ASSERT(singleTypeCellSet.GetNumberOfPoints() == numTriangles+2,
+                   "Wrong number of points.");
+  VTKM_TEST_ASSERT(
+        singleTypeCellSet.GetConnectivityArray(
+          vtkm::TopologyElementTagPoint(), vtkm::TopologyElementTagCell()) ==
+        explicitCellSet.GetConnectivityArray(
+          vtkm::TopologyElementTagPoint(), vtkm::TopologyElementTagCell()),
+        "Connectivity array was not shared.");
+  for (vtkm::Id cellIndex = 0; cellIndex < numTriangles; ++cellIndex)
+  {
+    VTKM_TEST_ASSERT(singleTypeCellSet.GetCellShape(cellIndex) ==
+                     vtkm::CELL_SHAPE_TRIANGLE,
+                     "Wrong cell shape.");
+    VTKM_TEST_ASSERT(singleTypeCellSet.GetNumberOfPointsInCell(cellIndex) == 3,
+                     "Wrong number of points in cell.");
+  }
+
+  vtkm::cont::DataSet convertedDataSet =
+      ConvertToSingleType(triangleDataSet, Device());
+  VTKM_TEST_ASSERT(
+        convertedDataSet.GetCellSet().IsType<vtkm::cont::CellSetSingleType<> >(),
+        "Data set cell set not converted.");
+  VTKM_TEST_ASSERT(convertedDataSet.GetNumberOfFields() ==
+                   triangleDataSet.GetNumberOfFields(),
+                   "Fields not copied.");
+  VTKM_TEST_ASSERT(convertedDataSet.HasField("cellvar"),
+                   "Cell field missing.");
+
+  // A triangle next to a quad has to stay explicit.
+  std::vector<vtkm::UInt8> mixedShapes;
+  mixedShapes.push_back(vtkm::CELL_SHAPE_TRIANGLE);
+  mixedShapes.push_back(vtkm::CELL_SHAPE_QUAD);
+  std::vector<vtkm::IdComponent> mixedNumIndices;
+  mixedNumIndices.push_back(3);
+  mixedNumIndices.push_back(4);
+  std::vector<vtkm::Id> mixedConnectivity;
+  mixedConnectivity.push_back(0);
+  mixedConnectivity.push_back(1);
+  mixedConnectivity.push_back(2);
+  mixedConnectivity.push_back(1);
+  mixedConnectivity.push_back(3);
+  mixedConnectivity.push_back(4);
+  mixedConnectivity.push_back(2);
+  std::vector<vtkm::Vec<vtkm::Float32,3> > mixedCoordinates(
+        pointCoordinates.begin(), pointCoordinates.begin() + 5);
+  vtkm::cont::DataSet mixedDataSet =
+      dataSetBuilder.Create(mixedCoordinates,
+                            mixedShapes,
+                            mixedNumIndices,
+                            mixedConnectivity);
+  vtkm::cont::CellSetExplicit<> mixedCellSet;
+  mixedDataSet.GetCellSet().CopyTo(mixedCellSet);
+  VTKM_TEST_ASSERT(
+        !ConvertToSingleType(mixedCellSet, singleTypeCellSet, Device()),
+        "Mixed cell set should not convert.");
+
+  vtkm::cont::DataSet unconvertedDataSet =
+      ConvertToSingleType(mixedDataSet, Device());
+  VTKM_TEST_ASSERT(
+        unconvertedDataSet.GetCellSet().IsType<vtkm::cont::CellSetExplicit<> >(),
+        "Mixed data set should stay explicit.");
+
+  // Every cell set of a data set is converted, and all of them are kept.
+  vtkm::cont::DataSet multipleDataSet = triangleDataSet;
+  multipleDataSet.AddCellSet(mixedCellSet);
+  multipleDataSet.AddCellSet(explicitCellSet);
+  vtkm::cont::DataSet multipleConvertedDataSet =
+      ConvertToSingleType(multipleDataSet, Device());
+  VTKM_TEST_ASSERT(multipleConvertedDataSet.GetNumberOfCellSets() == 3,
+                   "Cell sets dropped.");
+  VTKM_TEST_ASSERT(
+        multipleConvertedDataSet.GetCellSet(0).
+          IsType<vtkm::cont::CellSetSingleType<> >(),
+        "First cell set not converted.");
+  VTKM_TEST_ASSERT(
+        multipleConvertedDataSet.GetCellSet(1).
+          IsType<vtkm::cont::CellSetExplicit<> >(),
+        "Mixed cell set should stay explicit.");
+  VTKM_TEST_ASSERT(
+        multipleConvertedDataSet.GetCellSet(2).
+          IsType<vtkm::cont::CellSetSingleType<> >(),
+        "Last cell set not converted.");
+  VTKM_TEST_ASSERT(multipleConvertedDataSet.HasField("cellvar"),
+                   "Cell field missing.");
+}
+
 void CreateCellSetPermutation()
 {
   std::cout << "Create a cell set permutation" << std::endl;
@@ -422,6 +1246,9 @@ void Test()
   CreateRectilinearGrid();
   CreateExplicitGrid();
   CreateExplicitGridIterative();
+  CreateExplicitGridBulk();
+  CreateExplicitGridBulkBenchmark();
+  ConvertExplicitToSingleType();
   AddFieldData();
   CreateCellSetPermutation();
 }
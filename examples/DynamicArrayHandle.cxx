@@ -3,13 +3,21 @@
 #include <vtkm/cont/ArrayHandleIndex.h>
 #include <vtkm/cont/DeviceAdapter.h>
 #include <vtkm/cont/DynamicArrayHandle.h>
+#include <vtkm/cont/ErrorBadValue.h>
+#include <vtkm/cont/Timer.h>
 
 #include <vtkm/cont/internal/StorageError.h>
 
+#include <vtkm/ListTag.h>
 #include <vtkm/VecTraits.h>
 
 #include <vtkm/cont/testing/Testing.h>
 
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+
 namespace {
 
 ////
@@ -297,6 +305,261 @@ void TryPrintArrayContents()
   ////
 }
 
+////
+//// BEGIN-EXAMPLE DispatchTable.cxx
+////
+// Resolves the concrete type of a dynamic array with one hash lookup instead
+// of trying every type and storage in the lists. One table is built for each
+// combination of functor, type list, and storage list the first time it is
+// used.
+template<typename Functor>
+class DispatchTable
+{
+  typedef vtkm::cont::detail::PolymorphicArrayHandleContainerBase
+      ContainerBase;
+  typedef void (*CallerType)(ContainerBase *, const Functor &);
+  typedef std::unordered_map<std::type_index, CallerType> MapType;
+
+public:
+  template<typename TypeList, typename StorageList>
+  VTKM_CONT
+  static const DispatchTable &Get(TypeList, StorageList)
+  {
+    static const DispatchTable table((TypeList()), (StorageList()));
+    return table;
+  }
+
+  template<typename TypeList, typename StorageList>
+  VTKM_CONT
+  void Call(const vtkm::cont::DynamicArrayHandleBase<TypeList,StorageList>
+              &array,
+            const Functor &f) const
+  {
+    const std::shared_ptr<ContainerBase> &container =
+        vtkm::cont::detail::DynamicArrayHandleCopyHelper::
+        GetArrayHandleContainer(array);
+    if (!container)
+    {
+      throw vtkm::cont::ErrorBadValue("Cannot dispatch an empty array.");
+    }
+
+    typename MapType::const_iterator caller =
+        this->Callers.find(std::type_index(typeid(*container)));
+    if (caller == this->Callers.end())
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Could not find appropriate cast for array in dispatch table.");
+    }
+    caller->second(container.get(), f);
+  }
+
+  VTKM_CONT
+  std::size_t GetNumberOfEntries() const { return this->Callers.size(); }
+
+private:
+  template<typename T, typename Storage>
+  VTKM_CONT
+  static void CallWithArray(ContainerBase *container, const Functor &f)
+  {
+    f(static_cast<vtkm::cont::detail::
+                  PolymorphicArrayHandleContainer<T,Storage> *>(container)
+      ->Array);
+  }
+
+  template<typename T>
+  struct AddStorageFunctor
+  {
+    MapType *Callers;
+
+    template<typename Storage>
+    VTKM_CONT
+    void operator()(Storage) const
+    {
+      this->template Add<Storage>(typename vtkm::cont::internal::
+                           IsValidArrayHandle<T,Storage>::type());
+    }
+
+    template<typename Storage>
+    VTKM_CONT
+    void Add(std::true_type) const
+    {
+      typedef vtkm::cont::detail::PolymorphicArrayHandleContainer<T,Storage>
+          ContainerType;
+      (*this->Callers)[std::type_index(typeid(ContainerType))] =
+          &DispatchTable::CallWithArray<T,Storage>;
+    }
+
+    template<typename Storage>
+    VTKM_CONT
+    void Add(std::false_type) const
+    {
+      // This storage cannot hold values of type T.
+    }
+  };
+
+  template<typename StorageList>
+  struct AddTypeFunctor
+  {
+    MapType *Callers;
+
+    template<typename T>
+    VTKM_CONT
+    void operator()(T) const
+    {
+      AddStorageFunctor<T> addStorage = { this->Callers };
+      vtkm::ListForEach(addStorage, StorageList());
+    }
+  };
+
+  template<typename TypeList, typename StorageList>
+  VTKM_CONT
+  DispatchTable(TypeList, StorageList)
+  {
+    AddTypeFunctor<StorageList> addType = { &this->Callers };
+    vtkm::ListForEach(addType, TypeList());
+  }
+
+  MapType Callers;
+};
+
+template<typename TypeList, typename StorageList, typename Functor>
+VTKM_CONT
+void TableCastAndCall(
+    const vtkm::cont::DynamicArrayHandleBase<TypeList,StorageList> &array,
+    const Functor &f)
+{
+  DispatchTable<Functor>::Get(TypeList(), StorageList()).Call(array, f);
+}
+////
+//// END-EXAMPLE DispatchTable.cxx
+////
+
+template<typename ExpectedType, typename ExpectedStorage>
+struct CheckDispatchTypeFunctor
+{
+  bool *Called;
+
+  template<typename T, typename Storage>
+  VTKM_CONT
+  void operator()(const vtkm::cont::ArrayHandle<T,Storage> &) const
+  {
+    VTKM_TEST_ASSERT((std::is_same<T,ExpectedType>::value),
+                     "Dispatched with wrong value type.");
+    VTKM_TEST_ASSERT((std::is_same<Storage,ExpectedStorage>::value),
+                     "Dispatched with wrong storage.");
+    *this->Called = true;
+  }
+};
+
+struct CountValuesFunctor
+{
+  vtkm::Id *Count;
+
+  template<typename T, typename Storage>
+  VTKM_CONT
+  void operator()(const vtkm::cont::ArrayHandle<T,Storage> &array) const
+  {
+    *this->Count += array.GetNumberOfValues();
+  }
+};
+
+template<typename DynamicArrayType>
+void BenchmarkDispatch(const DynamicArrayType &array, const std::string &name)
+{
+  static const vtkm::Id NUM_DISPATCHES = 10000;
+
+  vtkm::Id count = 0;
+  CountValuesFunctor functor = { &count };
+
+  vtkm::cont::Timer<> timer;
+  for (vtkm::Id trial = 0; trial < NUM_DISPATCHES; trial++)
+  {
+    array.CastAndCall(functor);
+  }
+  vtkm::Float64 castAndCallTime = timer.GetElapsedTime();
+
+  timer.Reset();
+  for (vtkm::Id trial = 0; trial < NUM_DISPATCHES; trial++)
+  {
+    TableCastAndCall(array, functor);
+  }
+  vtkm::Float64 tableTime = timer.GetElapsedTime();
+
+  VTKM_TEST_ASSERT(count == 2*NUM_DISPATCHES*array.GetNumberOfValues(),
+                   "Dispatch missed calls.");
+
+  std::cout << "  " << name << ": CastAndCall "
+            << 1e9*castAndCallTime/NUM_DISPATCHES << " ns, table "
+            << 1e9*tableTime/NUM_DISPATCHES << " ns per dispatch" << std::endl;
+}
+
+void TryDispatchTable()
+{
+  std::cout << "Trying dispatch table." << std::endl;
+
+  std::vector<vtkm::Vec<vtkm::Float64,3> > vectorBuffer(10);
+  vtkm::cont::DynamicArrayHandle vectorArray =
+      vtkm::cont::make_ArrayHandle(vectorBuffer);
+
+  bool called = false;
+  TableCastAndCall(vectorArray,
+                   CheckDispatchTypeFunctor<vtkm::Vec<vtkm::Float64,3>,
+                                            vtkm::cont::StorageTagBasic>
+                     { &called });
+  VTKM_TEST_ASSERT(called, "Functor not called.");
+
+  vtkm::cont::DynamicArrayHandle indexArray = vtkm::cont::ArrayHandleIndex(10);
+  called = false;
+  TableCastAndCall(indexArray.
+                   ResetTypeList(vtkm::TypeListTagId()).
+                   ResetStorageList(MyIdStorageList()),
+                   CheckDispatchTypeFunctor<
+                     vtkm::Id, vtkm::cont::ArrayHandleIndex::StorageTag>
+                     { &called });
+  VTKM_TEST_ASSERT(called, "Functor not called.");
+
+  // TypeListTagId has the single type vtkm::Id, and both storages in
+  // MyIdStorageList can hold it (basic storage holds any type, and the index
+  // storage holds only vtkm::Id). That is 1 type times 2 storages, so 2
+  // entries. For a type other than vtkm::Id, the index storage entry would
+  // be skipped.
+  VTKM_TEST_ASSERT(
+        (DispatchTable<CountValuesFunctor>::Get(vtkm::TypeListTagId(),
+                                                MyIdStorageList())
+         .GetNumberOfEntries() == 2),
+        "Wrong number of table entries.");
+
+  bool threw = false;
+  try
+  {
+    vtkm::Id count = 0;
+    TableCastAndCall(indexArray.ResetTypeList(vtkm::TypeListTagFieldScalar()),
+                     CountValuesFunctor{ &count });
+  }
+  catch (vtkm::cont::ErrorBadValue &)
+  {
+    threw = true;
+  }
+  VTKM_TEST_ASSERT(threw, "Missing array type did not throw.");
+
+  std::cout << "Benchmarking dispatch overhead." << std::endl;
+  std::vector<vtkm::Id> idBuffer(10);
+  BenchmarkDispatch(vtkm::cont::DynamicArrayHandle(
+                      vtkm::cont::make_ArrayHandle(idBuffer))
+                    .ResetTypeList(vtkm::TypeListTagId()),
+                    "TypeListTagId");
+  std::vector<vtkm::Float64> scalarBuffer(10);
+  BenchmarkDispatch(vtkm::cont::DynamicArrayHandle(
+                      vtkm::cont::make_ArrayHandle(scalarBuffer))
+                    .ResetTypeList(vtkm::TypeListTagFieldScalar()),
+                    "TypeListTagFieldScalar");
+  BenchmarkDispatch(vectorArray.ResetTypeList(vtkm::TypeListTagField()),
+                    "TypeListTagField");
+  BenchmarkDispatch(vectorArray, "TypeListTagCommon");
+  BenchmarkDispatch(vectorArray.ResetTypeList(vtkm::TypeListTagAll()),
+                    "TypeListTagAll");
+}
+
 void Test()
 {
   TryLoadDynamicArray();
@@ -304,6 +567,7 @@ void Test()
   DynamicArrayHandleNewInstance();
   QueryCastDynamicArrayHandle();
   TryPrintArrayContents();
+  TryDispatchTable();
 }
 
 } // anonymous namespace
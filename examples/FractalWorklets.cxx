@@ -1,3 +1,5 @@
+#include "ScatterCountingFused.h"
+
 #include <vtkm/TypeListTag.h>
 
 #include <vtkm/cont/ArrayHandleGroupVec.h>
@@ -12,7 +14,6 @@
 #include <vtkm/exec/arg/ThreadIndicesBasic.h>
 
 #include <vtkm/worklet/DispatcherMapField.h>
-#include <vtkm/worklet/ScatterCounting.h>
 #include <vtkm/worklet/WorkletMapField.h>
 
 #include <vtkm/cont/testing/Testing.h>
@@ -1143,7 +1144,7 @@ struct TreeFractal
     typedef void ExecutionSignature(Transform, VisitIndex, _2, _3);
     using InputDomain = _1;
 
-    using ScatterType = vtkm::worklet::ScatterCounting;
+    using ScatterType = vtkm::worklet::ScatterCountingFused;
     VTKM_CONT
     ScatterType GetScatter() const { return this->Scatter; }
 
@@ -0,0 +1,101 @@
+#ifndef vtkm_examples_LocalDispatch_h
+#define vtkm_examples_LocalDispatch_h
+
+// The same operation as AverageCellFieldToPoints in PrecompiledDispatch.cxx,
+// but invoking the worklet with dynamic arguments in the including file the
+// way ConvertCellFieldsToPointFields in UseWorkletMapCellToPoint.cxx does.
+// PrecompiledDispatch.cxx times the two against each other, and
+// LocalDispatchComparison.cxx compiles this on its own to compare compile
+// time and object size.
+
+#include <vtkm/worklet/DispatcherMapTopology.h>
+#include <vtkm/worklet/WorkletMapTopology.h>
+
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DynamicArrayHandle.h>
+#include <vtkm/cont/DynamicCellSet.h>
+#include <vtkm/cont/Field.h>
+
+#include <vtkm/ListTag.h>
+#include <vtkm/VecTraits.h>
+
+#include <string>
+
+namespace localdispatch {
+
+class AverageCellField : public vtkm::worklet::WorkletMapCellToPoint
+{
+public:
+  typedef void ControlSignature(CellSetIn cellSet,
+                                FieldInCell<> inputCellField,
+                                FieldOut<> outputPointField);
+  typedef void ExecutionSignature(CellCount, _2, _3);
+  using InputDomain = _1;
+
+  template<typename InputCellFieldType, typename OutputFieldType>
+  VTKM_EXEC
+  void operator()(vtkm::IdComponent numCells,
+                  const InputCellFieldType &inputCellField,
+                  OutputFieldType &fieldAverage) const
+  {
+    // The dynamic arguments are resolved independently, so some of the
+    // combinations instantiated have different input and output types. Only
+    // matching types do the average, as in UseWorkletMapCellToPoint.cxx.
+    typedef typename InputCellFieldType::ComponentType InputComponentType;
+    this->DoAverage(numCells,
+                    inputCellField,
+                    fieldAverage,
+                    vtkm::ListTagBase<InputComponentType,OutputFieldType>());
+  }
+
+private:
+  template<typename InputCellFieldType, typename T>
+  VTKM_EXEC
+  void DoAverage(vtkm::IdComponent numCells,
+                 const InputCellFieldType &inputCellField,
+                 T &fieldAverage,
+                 vtkm::ListTagBase<T,T>) const
+  {
+    typedef typename vtkm::VecTraits<T>::ComponentType ComponentType;
+
+    fieldAverage = T(ComponentType(0));
+    for (vtkm::IdComponent cellIndex = 0; cellIndex < numCells; cellIndex++)
+    {
+      fieldAverage = fieldAverage + inputCellField[cellIndex];
+    }
+    fieldAverage = fieldAverage / T(static_cast<ComponentType>(numCells));
+  }
+
+  template<typename T1, typename T2, typename T3>
+  VTKM_EXEC
+  void DoAverage(vtkm::IdComponent, T1, T2, T3) const
+  {
+    this->RaiseError("Incompatible types for input and output.");
+  }
+};
+
+VTKM_CONT
+inline vtkm::cont::DataSet
+AverageCellFieldToPoints(const vtkm::cont::DataSet &inData,
+                         const std::string &fieldName)
+{
+  vtkm::cont::Field inField = inData.GetField(fieldName);
+  vtkm::cont::DynamicArrayHandle inFieldData = inField.GetData();
+
+  // The dispatcher is instantiated here for every type in the default lists.
+  vtkm::cont::DynamicArrayHandle outFieldData = inFieldData.NewInstance();
+  vtkm::worklet::DispatcherMapTopology<AverageCellField> dispatcher;
+  dispatcher.Invoke(inData.GetCellSet(inField.GetAssocCellSet()),
+                    inFieldData,
+                    outFieldData);
+
+  vtkm::cont::DataSet outData = inData;
+  outData.AddField(vtkm::cont::Field(fieldName + "_point",
+                                     vtkm::cont::Field::ASSOC_POINTS,
+                                     outFieldData));
+  return outData;
+}
+
+} // namespace localdispatch
+
+#endif //vtkm_examples_LocalDispatch_h
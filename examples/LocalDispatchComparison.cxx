@@ -0,0 +1,12 @@
+// Compiled only by the precompiled-dispatch-comparison target. Compare with
+// PrecompiledDispatchComparison.cxx, which does the same with the library.
+
+#include "LocalDispatch.h"
+
+VTKM_CONT
+vtkm::cont::DataSet
+CompareAverageCellFieldToPoints(const vtkm::cont::DataSet &inData,
+                                const std::string &fieldName)
+{
+  return localdispatch::AverageCellFieldToPoints(inData, fieldName);
+}
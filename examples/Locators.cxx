@@ -0,0 +1,1124 @@
+#include "BenchmarkHelpers.h"
+#include "ScatterCountingFused.h"
+
+#include <vtkm/exec/FunctorBase.h>
+#include <vtkm/exec/ParametricCoordinates.h>
+
+#include <vtkm/worklet/DispatcherMapField.h>
+#include <vtkm/worklet/DispatcherMapTopology.h>
+#include <vtkm/worklet/WorkletMapField.h>
+#include <vtkm/worklet/WorkletMapTopology.h>
+
+#include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/ArrayHandleCounting.h>
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DataSetBuilderUniform.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/DynamicCellSet.h>
+#include <vtkm/cont/Timer.h>
+
+#include <vtkm/Bounds.h>
+#include <vtkm/CellShape.h>
+#include <vtkm/Math.h>
+#include <vtkm/VecFromPortalPermute.h>
+
+#include <vtkm/cont/testing/Testing.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+////
+//// BEGIN-EXAMPLE UniformBinGrid.cxx
+////
+// A regular grid of bins laid over the bounds of a data set. The bins are
+// sized so that each holds roughly the requested number of items. Axes along
+// which the bounds are flat get a single bin.
+struct UniformBinGrid
+{
+  typedef vtkm::Vec<vtkm::FloatDefault,3> PointType;
+
+  // Caps the number of bins along one axis so that very thin bounds do not
+  // produce huge grids.
+  enum { MAX_BINS_PER_AXIS = 1024 };
+
+  PointType MinPoint;
+  PointType MaxPoint;
+  PointType BinWidth;
+  PointType InverseBinWidth;
+  vtkm::Id3 Dimensions;
+  vtkm::FloatDefault Tolerance;
+
+  VTKM_CONT
+  UniformBinGrid()
+    : MinPoint(0), MaxPoint(0), BinWidth(1), InverseBinWidth(1),
+      Dimensions(1), Tolerance(0)
+  {  }
+
+  VTKM_CONT
+  UniformBinGrid(const vtkm::Bounds &bounds,
+                 vtkm::Id numItems,
+                 vtkm::Id itemsPerBin)
+  {
+    this->MinPoint = PointType(static_cast<vtkm::FloatDefault>(bounds.X.Min),
+                               static_cast<vtkm::FloatDefault>(bounds.Y.Min),
+                               static_cast<vtkm::FloatDefault>(bounds.Z.Min));
+    this->MaxPoint = PointType(static_cast<vtkm::FloatDefault>(bounds.X.Max),
+                               static_cast<vtkm::FloatDefault>(bounds.Y.Max),
+                               static_cast<vtkm::FloatDefault>(bounds.Z.Max));
+    PointType extent = this->MaxPoint - this->MinPoint;
+
+    // Pick a bin size so that the bins in the non-flat dimensions hold about
+    // itemsPerBin items each.
+    vtkm::Float64 targetBins =
+        vtkm::Max(1.0, static_cast<vtkm::Float64>(numItems)/
+                         static_cast<vtkm::Float64>(vtkm::Max(itemsPerBin,
+                                                              vtkm::Id(1))));
+    vtkm::Float64 volume = 1.0;
+    vtkm::IdComponent numDimensions = 0;
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      if (extent[dim] > 0)
+      {
+        volume *= extent[dim];
+        ++numDimensions;
+      }
+    }
+    vtkm::Float64 binSize = (numDimensions > 0)
+        ? vtkm::Pow(volume/targetBins, 1.0/numDimensions) : 1.0;
+
+    vtkm::FloatDefault diagonal = vtkm::Magnitude(extent);
+    this->Tolerance = (diagonal > 0) ? 1e-5f*diagonal : 1e-5f;
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      if (extent[dim] > 0)
+      {
+        this->Dimensions[dim] =
+            vtkm::Min(vtkm::Max(static_cast<vtkm::Id>(
+                                  vtkm::Ceil(extent[dim]/binSize)),
+                                vtkm::Id(1)),
+                      vtkm::Id(MAX_BINS_PER_AXIS));
+        this->BinWidth[dim] =
+            extent[dim]/static_cast<vtkm::FloatDefault>(this->Dimensions[dim]);
+      }
+      else
+      {
+        this->Dimensions[dim] = 1;
+        this->BinWidth[dim] = 1;
+      }
+      this->InverseBinWidth[dim] = 1/this->BinWidth[dim];
+    }
+  }
+
+  VTKM_EXEC_CONT
+  vtkm::Id GetNumberOfBins() const
+  {
+    return this->Dimensions[0]*this->Dimensions[1]*this->Dimensions[2];
+  }
+
+  // Returns true if the point is inside the bounds (within a small
+  // tolerance).
+  template<typename T>
+  VTKM_EXEC_CONT
+  bool Contains(const vtkm::Vec<T,3> &point) const
+  {
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      if ((point[dim] < this->MinPoint[dim] - this->Tolerance) ||
+          (point[dim] > this->MaxPoint[dim] + this->Tolerance))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the logical index of the bin containing the point. Points
+  // outside the bounds are clamped to the nearest bin.
+  template<typename T>
+  VTKM_EXEC_CONT
+  vtkm::Id3 GetBin(const vtkm::Vec<T,3> &point) const
+  {
+    vtkm::Id3 bin;
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      vtkm::FloatDefault position =
+          (static_cast<vtkm::FloatDefault>(point[dim]) - this->MinPoint[dim])*
+          this->InverseBinWidth[dim];
+      if (position <= 0)
+      {
+        bin[dim] = 0;
+      }
+      else
+      {
+        bin[dim] = vtkm::Min(static_cast<vtkm::Id>(position),
+                             this->Dimensions[dim] - 1);
+      }
+    }
+    return bin;
+  }
+
+  VTKM_EXEC_CONT
+  vtkm::Id GetBinIndex(const vtkm::Id3 &bin) const
+  {
+    return bin[0] + this->Dimensions[0]*(bin[1] + this->Dimensions[1]*bin[2]);
+  }
+};
+////
+//// END-EXAMPLE UniformBinGrid.cxx
+////
+
+////
+//// BEGIN-EXAMPLE CellLocator.cxx
+////
+// Returns true if the parametric coordinates are inside a cell of the given
+// shape and number of points, allowing a small tolerance at the boundary.
+VTKM_EXEC_CONT
+inline bool ParametricCoordinatesInside(
+    const vtkm::Vec<vtkm::FloatDefault,3> &pcoords,
+    vtkm::UInt8 shape,
+    vtkm::IdComponent numPoints)
+{
+  const vtkm::FloatDefault low = -1e-4f;
+  const vtkm::FloatDefault high = 1 + 1e-4f;
+  bool inUnitCube = (pcoords[0] >= low) && (pcoords[0] <= high) &&
+                    (pcoords[1] >= low) && (pcoords[1] <= high) &&
+                    (pcoords[2] >= low) && (pcoords[2] <= high);
+  if ((shape == vtkm::CELL_SHAPE_POLYGON) && (numPoints == 3))
+  {
+    // Polygons with three or four points use the parametric space of a
+    // triangle or quadrilateral.
+    shape = vtkm::CELL_SHAPE_TRIANGLE;
+  }
+  else if ((shape == vtkm::CELL_SHAPE_POLYGON) && (numPoints == 4))
+  {
+    shape = vtkm::CELL_SHAPE_QUAD;
+  }
+  switch (shape)
+  {
+    case vtkm::CELL_SHAPE_LINE:
+      return (pcoords[0] >= low) && (pcoords[0] <= high);
+    case vtkm::CELL_SHAPE_TRIANGLE:
+      return (pcoords[0] >= low) && (pcoords[1] >= low) &&
+             (pcoords[0] + pcoords[1] <= high);
+    case vtkm::CELL_SHAPE_POLYGON:
+    {
+      // The points of larger polygons are placed evenly on the circle of
+      // radius 0.5 around (0.5, 0.5), so the cell is the regular polygon
+      // inscribed in that circle. Each edge is at distance 0.5*cos(pi/n)
+      // from the center, measured along the middle of the edge's sector.
+      if (numPoints < 3) { return false; }
+      vtkm::FloatDefault x = pcoords[0] - 0.5f;
+      vtkm::FloatDefault y = pcoords[1] - 0.5f;
+      vtkm::FloatDefault sectorAngle =
+          static_cast<vtkm::FloatDefault>(2*vtkm::Pi())/
+          static_cast<vtkm::FloatDefault>(numPoints);
+      vtkm::FloatDefault angle = vtkm::ATan2(y, x);
+      if (angle < 0) { angle += static_cast<vtkm::FloatDefault>(2*vtkm::Pi()); }
+      vtkm::FloatDefault sector = vtkm::Floor(angle/sectorAngle);
+      vtkm::FloatDefault middleAngle = (sector + 0.5f)*sectorAngle;
+      return x*vtkm::Cos(middleAngle) + y*vtkm::Sin(middleAngle) <=
+             0.5f*vtkm::Cos(0.5f*sectorAngle) - low;
+    }
+    case vtkm::CELL_SHAPE_PIXEL:
+    case vtkm::CELL_SHAPE_QUAD:
+      return (pcoords[0] >= low) && (pcoords[0] <= high) &&
+             (pcoords[1] >= low) && (pcoords[1] <= high);
+    case vtkm::CELL_SHAPE_TETRA:
+      return (pcoords[0] >= low) && (pcoords[1] >= low) &&
+             (pcoords[2] >= low) &&
+             (pcoords[0] + pcoords[1] + pcoords[2] <= high);
+    case vtkm::CELL_SHAPE_WEDGE:
+      return inUnitCube && (pcoords[0] + pcoords[1] <= high);
+    case vtkm::CELL_SHAPE_VOXEL:
+    case vtkm::CELL_SHAPE_HEXAHEDRON:
+    case vtkm::CELL_SHAPE_PYRAMID:
+      return inUnitCube;
+    default:
+      return false;
+  }
+}
+
+// Tests whether the point is in the given cell. If it is, the parametric
+// coordinates of the point are returned in pcoords.
+template<typename CellSetType, typename CoordsPortalType>
+VTKM_EXEC
+bool PointInCell(const vtkm::Vec<vtkm::FloatDefault,3> &point,
+                 vtkm::Id cellId,
+                 const CellSetType &cellSet,
+                 const CoordsPortalType &coordsPortal,
+                 vtkm::Vec<vtkm::FloatDefault,3> &pcoords,
+                 const vtkm::exec::FunctorBase &worklet)
+{
+  typedef typename CoordsPortalType::ValueType CoordType;
+  typedef typename CellSetType::IndicesType IndicesType;
+
+  IndicesType pointIndices = cellSet.GetIndices(cellId);
+  vtkm::VecFromPortalPermute<IndicesType,CoordsPortalType>
+      cellPoints(&pointIndices, coordsPortal);
+  vtkm::IdComponent numPoints = cellPoints.GetNumberOfComponents();
+  if (numPoints < 1) { return false; }
+
+  // Checking the bounds of the cell first is much cheaper than inverting the
+  // interpolation, and it rejects most candidates.
+  CoordType minPoint = cellPoints[0];
+  CoordType maxPoint = minPoint;
+  for (vtkm::IdComponent pointIndex = 1; pointIndex < numPoints; ++pointIndex)
+  {
+    CoordType cellPoint = cellPoints[pointIndex];
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      minPoint[dim] = vtkm::Min(minPoint[dim], cellPoint[dim]);
+      maxPoint[dim] = vtkm::Max(maxPoint[dim], cellPoint[dim]);
+    }
+  }
+  vtkm::FloatDefault tolerance = 1e-5f*static_cast<vtkm::FloatDefault>(
+                                   vtkm::Magnitude(maxPoint - minPoint));
+  for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+  {
+    if ((point[dim] < minPoint[dim] - tolerance) ||
+        (point[dim] > maxPoint[dim] + tolerance))
+    {
+      return false;
+    }
+  }
+
+  typename CellSetType::CellShapeTag shape = cellSet.GetCellShape(cellId);
+  pcoords = vtkm::Vec<vtkm::FloatDefault,3>(
+        vtkm::exec::WorldCoordinatesToParametricCoordinates(
+          cellPoints, CoordType(point), shape, worklet));
+  return ParametricCoordinatesInside(pcoords, shape.Id, numPoints);
+}
+
+// Finds the cell containing each of a batch of points. The cells are placed
+// in the bins of a UniformBinGrid that their bounds overlap, so a query only
+// tests the few cells listed in the bin containing the point.
+class CellLocator
+{
+public:
+  struct CellBinRange : vtkm::worklet::WorkletMapPointToCell
+  {
+    typedef void ControlSignature(CellSetIn cellSet,
+                                  FieldInPoint<Vec3> coords,
+                                  FieldOutCell<Id3Type> minBin,
+                                  FieldOutCell<Id3Type> maxBin,
+                                  FieldOutCell<IdType> binCount);
+    typedef void ExecutionSignature(PointCount, _2, _3, _4, _5);
+    typedef _1 InputDomain;
+
+    UniformBinGrid Grid;
+
+    VTKM_CONT
+    CellBinRange(const UniformBinGrid &grid) : Grid(grid) {  }
+
+    template<typename CoordsVecType>
+    VTKM_EXEC
+    void operator()(vtkm::IdComponent numPoints,
+                    const CoordsVecType &coords,
+                    vtkm::Id3 &minBin,
+                    vtkm::Id3 &maxBin,
+                    vtkm::Id &binCount) const
+    {
+      minBin = maxBin = this->Grid.GetBin(coords[0]);
+      for (vtkm::IdComponent pointIndex = 1; pointIndex < numPoints; ++pointIndex)
+      {
+        vtkm::Id3 bin = this->Grid.GetBin(coords[pointIndex]);
+        for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+        {
+          minBin[dim] = vtkm::Min(minBin[dim], bin[dim]);
+          maxBin[dim] = vtkm::Max(maxBin[dim], bin[dim]);
+        }
+      }
+      vtkm::Id3 size = maxBin - minBin + vtkm::Id3(1);
+      binCount = size[0]*size[1]*size[2];
+    }
+  };
+
+  struct CellBinPairs : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<Id3Type> minBin,
+                                  FieldIn<Id3Type> maxBin,
+                                  FieldOut<IdType> binIndex,
+                                  FieldOut<IdType> cellId);
+    typedef void ExecutionSignature(_1, _2, InputIndex, VisitIndex, _3, _4);
+    typedef _1 InputDomain;
+
+    typedef vtkm::worklet::ScatterCountingFused ScatterType;
+    VTKM_CONT ScatterType GetScatter() const { return this->Scatter; }
+
+    UniformBinGrid Grid;
+    ScatterType Scatter;
+
+    VTKM_CONT
+    CellBinPairs(const UniformBinGrid &grid, const ScatterType &scatter)
+      : Grid(grid), Scatter(scatter) {  }
+
+    VTKM_EXEC
+    void operator()(const vtkm::Id3 &minBin,
+                    const vtkm::Id3 &maxBin,
+                    vtkm::Id inputIndex,
+                    vtkm::IdComponent visitIndex,
+                    vtkm::Id &binIndex,
+                    vtkm::Id &cellId) const
+    {
+      vtkm::Id3 size = maxBin - minBin + vtkm::Id3(1);
+      vtkm::Id3 bin(minBin[0] + visitIndex%size[0],
+                    minBin[1] + (visitIndex/size[0])%size[1],
+                    minBin[2] + visitIndex/(size[0]*size[1]));
+      binIndex = this->Grid.GetBinIndex(bin);
+      cellId = inputIndex;
+    }
+  };
+
+  struct FindCellWorklet : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<Vec3> point,
+                                  WholeCellSetIn<> cellSet,
+                                  WholeArrayIn<Vec3> coords,
+                                  WholeArrayIn<IdType> binOffsets,
+                                  WholeArrayIn<IdType> binCellIds,
+                                  FieldOut<IdType> cellId,
+                                  FieldOut<Vec3> pcoords);
+    typedef void ExecutionSignature(_1, _2, _3, _4, _5, _6, _7);
+    typedef _1 InputDomain;
+
+    UniformBinGrid Grid;
+
+    VTKM_CONT
+    FindCellWorklet(const UniformBinGrid &grid) : Grid(grid) {  }
+
+    template<typename CellSetType,
+             typename CoordsPortalType,
+             typename IdPortalType>
+    VTKM_EXEC
+    void operator()(const vtkm::Vec<vtkm::FloatDefault,3> &point,
+                    const CellSetType &cellSet,
+                    const CoordsPortalType &coordsPortal,
+                    const IdPortalType &binOffsets,
+                    const IdPortalType &binCellIds,
+                    vtkm::Id &cellId,
+                    vtkm::Vec<vtkm::FloatDefault,3> &pcoords) const
+    {
+      cellId = -1;
+      pcoords = vtkm::Vec<vtkm::FloatDefault,3>(0);
+      if (!this->Grid.Contains(point)) { return; }
+
+      vtkm::Id binIndex = this->Grid.GetBinIndex(this->Grid.GetBin(point));
+      vtkm::Id end = binOffsets.Get(binIndex+1);
+      for (vtkm::Id index = binOffsets.Get(binIndex); index < end; ++index)
+      {
+        vtkm::Id candidate = binCellIds.Get(index);
+        if (PointInCell(point, candidate, cellSet, coordsPortal, pcoords, *this))
+        {
+          cellId = candidate;
+          return;
+        }
+      }
+    }
+  };
+
+  VTKM_CONT
+  CellLocator() {  }
+
+  // Builds the bins. A cell is listed in every bin its bounds overlap, and
+  // the list is sorted by bin so that each bin's cells are contiguous.
+  template<typename Device>
+  VTKM_CONT
+  CellLocator(const vtkm::cont::DynamicCellSet &cellSet,
+              const vtkm::cont::CoordinateSystem &coords,
+              Device)
+    : CellSet(cellSet), Coordinates(coords.GetData())
+  {
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    this->Grid = UniformBinGrid(coords.GetBounds(),
+                                cellSet.GetNumberOfCells(),
+                                CELLS_PER_BIN);
+
+    vtkm::cont::ArrayHandle<vtkm::Id3> minBins;
+    vtkm::cont::ArrayHandle<vtkm::Id3> maxBins;
+    vtkm::cont::ArrayHandle<vtkm::Id> binCounts;
+    vtkm::worklet::DispatcherMapTopology<CellBinRange,Device>
+        rangeDispatcher(CellBinRange(this->Grid));
+    rangeDispatcher.Invoke(cellSet, coords.GetData(), minBins, maxBins, binCounts);
+
+    vtkm::worklet::ScatterCountingFused scatter(binCounts, Device());
+    vtkm::cont::ArrayHandle<vtkm::Id> binIndices;
+    vtkm::worklet::DispatcherMapField<CellBinPairs,Device>
+        pairDispatcher(CellBinPairs(this->Grid, scatter));
+    pairDispatcher.Invoke(minBins, maxBins, binIndices, this->BinCellIds);
+
+    Algorithm::SortByKey(binIndices, this->BinCellIds);
+
+    // The offset of each bin (plus one past the last) is the position of the
+    // first entry at or beyond that bin.
+    Algorithm::LowerBounds(
+          binIndices,
+          vtkm::cont::ArrayHandleCounting<vtkm::Id>(
+            0, 1, this->Grid.GetNumberOfBins()+1),
+          this->BinOffsets);
+  }
+
+  // For each point, returns the index of the containing cell (or -1 if no
+  // cell contains it) and the parametric coordinates of the point in it.
+  template<typename Device>
+  VTKM_CONT
+  void FindCells(
+      const vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > &points,
+      vtkm::cont::ArrayHandle<vtkm::Id> &cellIds,
+      vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > &pcoords,
+      Device) const
+  {
+    vtkm::worklet::DispatcherMapField<FindCellWorklet,Device>
+        dispatcher(FindCellWorklet(this->Grid));
+    dispatcher.Invoke(points,
+                      this->CellSet,
+                      this->Coordinates,
+                      this->BinOffsets,
+                      this->BinCellIds,
+                      cellIds,
+                      pcoords);
+  }
+
+  VTKM_CONT
+  const UniformBinGrid &GetGrid() const { return this->Grid; }
+
+private:
+  enum { CELLS_PER_BIN = 2 };
+
+  vtkm::cont::DynamicCellSet CellSet;
+  vtkm::cont::DynamicArrayHandleCoordinateSystem Coordinates;
+  UniformBinGrid Grid;
+  vtkm::cont::ArrayHandle<vtkm::Id> BinOffsets;
+  vtkm::cont::ArrayHandle<vtkm::Id> BinCellIds;
+};
+////
+//// END-EXAMPLE CellLocator.cxx
+////
+
+////
+//// BEGIN-EXAMPLE PointLocator.cxx
+////
+// Finds the nearest point of a data set to each of a batch of query points.
+// The points are sorted into the bins of a UniformBinGrid, and each query
+// searches outward from its own bin in shells of bins until no closer point
+// can exist.
+class PointLocator
+{
+public:
+  struct PointBinIndex : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<Vec3> coords,
+                                  FieldOut<IdType> binIndex);
+    typedef _2 ExecutionSignature(_1);
+    typedef _1 InputDomain;
+
+    UniformBinGrid Grid;
+
+    VTKM_CONT
+    PointBinIndex(const UniformBinGrid &grid) : Grid(grid) {  }
+
+    template<typename T>
+    VTKM_EXEC
+    vtkm::Id operator()(const vtkm::Vec<T,3> &point) const
+    {
+      return this->Grid.GetBinIndex(this->Grid.GetBin(point));
+    }
+  };
+
+  struct NearestPointWorklet : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<Vec3> query,
+                                  WholeArrayIn<Vec3> coords,
+                                  WholeArrayIn<IdType> binOffsets,
+                                  WholeArrayIn<IdType> binPointIds,
+                                  FieldOut<IdType> nearestId,
+                                  FieldOut<Scalar> distance);
+    typedef void ExecutionSignature(_1, _2, _3, _4, _5, _6);
+    typedef _1 InputDomain;
+
+    UniformBinGrid Grid;
+
+    VTKM_CONT
+    NearestPointWorklet(const UniformBinGrid &grid) : Grid(grid) {  }
+
+    template<typename CoordsPortalType, typename IdPortalType>
+    VTKM_EXEC
+    void operator()(const vtkm::Vec<vtkm::FloatDefault,3> &query,
+                    const CoordsPortalType &coordsPortal,
+                    const IdPortalType &binOffsets,
+                    const IdPortalType &binPointIds,
+                    vtkm::Id &nearestId,
+                    vtkm::FloatDefault &distance) const
+    {
+      const UniformBinGrid &grid = this->Grid;
+      vtkm::Id3 center = grid.GetBin(query);
+      vtkm::FloatDefault nearestDistance2 = 0;
+      nearestId = -1;
+
+      for (vtkm::Id shell = 0; ; ++shell)
+      {
+        vtkm::Id3 first;
+        vtkm::Id3 last;
+        for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+        {
+          first[dim] = vtkm::Max(center[dim] - shell, vtkm::Id(0));
+          last[dim] = vtkm::Min(center[dim] + shell, grid.Dimensions[dim] - 1);
+        }
+
+        // Visit only the bins on the surface of the shell. The inside was
+        // searched in earlier iterations.
+        vtkm::Id3 bin;
+        for (bin[2] = first[2]; bin[2] <= last[2]; ++bin[2])
+        {
+          for (bin[1] = first[1]; bin[1] <= last[1]; ++bin[1])
+          {
+            for (bin[0] = first[0]; bin[0] <= last[0]; ++bin[0])
+            {
+              vtkm::Id3 offset = bin - center;
+              if (vtkm::Max(vtkm::Abs(offset[0]),
+                            vtkm::Max(vtkm::Abs(offset[1]),
+                                      vtkm::Abs(offset[2]))) != shell)
+              {
+                continue;
+              }
+              vtkm::Id binIndex = grid.GetBinIndex(bin);
+              vtkm::Id end = binOffsets.Get(binIndex+1);
+              for (vtkm::Id index = binOffsets.Get(binIndex); index < end; ++index)
+              {
+                vtkm::Id pointId = binPointIds.Get(index);
+                vtkm::FloatDefault distance2 = static_cast<vtkm::FloatDefault>(
+                      vtkm::MagnitudeSquared(
+                        query - vtkm::Vec<vtkm::FloatDefault,3>(
+                          coordsPortal.Get(pointId))));
+                if ((nearestId < 0) || (distance2 < nearestDistance2))
+                {
+                  nearestId = pointId;
+                  nearestDistance2 = distance2;
+                }
+              }
+            }
+          }
+        }
+
+        // Any point outside the searched bins is at least as far as the
+        // nearest face of the searched block that has more bins beyond it.
+        bool moreBins = false;
+        vtkm::FloatDefault searchedRadius = 0;
+        for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+        {
+          if (center[dim] - shell > 0)
+          {
+            vtkm::FloatDefault gap =
+                query[dim] - (grid.MinPoint[dim] +
+                              static_cast<vtkm::FloatDefault>(center[dim]-shell)*
+                              grid.BinWidth[dim]);
+            searchedRadius = moreBins ? vtkm::Min(searchedRadius, gap) : gap;
+            moreBins = true;
+          }
+          if (center[dim] + shell < grid.Dimensions[dim] - 1)
+          {
+            vtkm::FloatDefault gap =
+                (grid.MinPoint[dim] +
+                 static_cast<vtkm::FloatDefault>(center[dim]+shell+1)*
+                 grid.BinWidth[dim]) - query[dim];
+            searchedRadius = moreBins ? vtkm::Min(searchedRadius, gap) : gap;
+            moreBins = true;
+          }
+        }
+        if (!moreBins) { break; }
+        if ((nearestId >= 0) &&
+            (nearestDistance2 <= searchedRadius*searchedRadius))
+        {
+          break;
+        }
+      }
+
+      distance = vtkm::Sqrt(nearestDistance2);
+    }
+  };
+
+  VTKM_CONT
+  PointLocator() {  }
+
+  template<typename Device>
+  VTKM_CONT
+  PointLocator(const vtkm::cont::CoordinateSystem &coords, Device)
+    : Coordinates(coords.GetData())
+  {
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    vtkm::Id numPoints = coords.GetData().GetNumberOfValues();
+    this->Grid = UniformBinGrid(coords.GetBounds(), numPoints, POINTS_PER_BIN);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> binIndices;
+    vtkm::worklet::DispatcherMapField<PointBinIndex,Device>
+        binDispatcher(PointBinIndex(this->Grid));
+    binDispatcher.Invoke(coords.GetData(), binIndices);
+
+    Algorithm::Copy(vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numPoints),
+                    this->BinPointIds);
+    Algorithm::SortByKey(binIndices, this->BinPointIds);
+    Algorithm::LowerBounds(
+          binIndices,
+          vtkm::cont::ArrayHandleCounting<vtkm::Id>(
+            0, 1, this->Grid.GetNumberOfBins()+1),
+          this->BinOffsets);
+  }
+
+  // For each query, returns the index of the nearest point and the distance
+  // to it. Queries outside the bounds of the points are allowed.
+  template<typename Device>
+  VTKM_CONT
+  void FindNearestNeighbors(
+      const vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > &queries,
+      vtkm::cont::ArrayHandle<vtkm::Id> &nearestIds,
+      vtkm::cont::ArrayHandle<vtkm::FloatDefault> &distances,
+      Device) const
+  {
+    vtkm::worklet::DispatcherMapField<NearestPointWorklet,Device>
+        dispatcher(NearestPointWorklet(this->Grid));
+    dispatcher.Invoke(queries,
+                      this->Coordinates,
+                      this->BinOffsets,
+                      this->BinPointIds,
+                      nearestIds,
+                      distances);
+  }
+
+private:
+  enum { POINTS_PER_BIN = 4 };
+
+  vtkm::cont::DynamicArrayHandleCoordinateSystem Coordinates;
+  UniformBinGrid Grid;
+  vtkm::cont::ArrayHandle<vtkm::Id> BinOffsets;
+  vtkm::cont::ArrayHandle<vtkm::Id> BinPointIds;
+};
+////
+//// END-EXAMPLE PointLocator.cxx
+////
+
+// Checks every cell for every point. Used to check the locator and as a
+// baseline for timing.
+struct BruteForceFindCell : vtkm::worklet::WorkletMapField
+{
+  typedef void ControlSignature(FieldIn<Vec3> point,
+                                WholeCellSetIn<> cellSet,
+                                WholeArrayIn<Vec3> coords,
+                                FieldOut<IdType> cellId,
+                                FieldOut<Vec3> pcoords);
+  typedef void ExecutionSignature(_1, _2, _3, _4, _5);
+  typedef _1 InputDomain;
+
+  template<typename CellSetType, typename CoordsPortalType>
+  VTKM_EXEC
+  void operator()(const vtkm::Vec<vtkm::FloatDefault,3> &point,
+                  const CellSetType &cellSet,
+                  const CoordsPortalType &coordsPortal,
+                  vtkm::Id &cellId,
+                  vtkm::Vec<vtkm::FloatDefault,3> &pcoords) const
+  {
+    for (cellId = 0; cellId < cellSet.GetNumberOfElements(); ++cellId)
+    {
+      if (PointInCell(point, cellId, cellSet, coordsPortal, pcoords, *this))
+      {
+        return;
+      }
+    }
+    cellId = -1;
+  }
+};
+
+struct BruteForceNearestPoint : vtkm::worklet::WorkletMapField
+{
+  typedef void ControlSignature(FieldIn<Vec3> query,
+                                WholeArrayIn<Vec3> coords,
+                                FieldOut<IdType> nearestId,
+                                FieldOut<Scalar> distance);
+  typedef void ExecutionSignature(_1, _2, _3, _4);
+  typedef _1 InputDomain;
+
+  template<typename CoordsPortalType>
+  VTKM_EXEC
+  void operator()(const vtkm::Vec<vtkm::FloatDefault,3> &query,
+                  const CoordsPortalType &coordsPortal,
+                  vtkm::Id &nearestId,
+                  vtkm::FloatDefault &distance) const
+  {
+    vtkm::FloatDefault nearestDistance2 = 0;
+    nearestId = -1;
+    for (vtkm::Id pointId = 0;
+         pointId < coordsPortal.GetNumberOfValues();
+         ++pointId)
+    {
+      vtkm::FloatDefault distance2 = static_cast<vtkm::FloatDefault>(
+            vtkm::MagnitudeSquared(
+              query - vtkm::Vec<vtkm::FloatDefault,3>(coordsPortal.Get(pointId))));
+      if ((nearestId < 0) || (distance2 < nearestDistance2))
+      {
+        nearestId = pointId;
+        nearestDistance2 = distance2;
+      }
+    }
+    distance = vtkm::Sqrt(nearestDistance2);
+  }
+};
+
+vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> >
+MakeRandomPoints(vtkm::Id numPoints,
+                 const vtkm::Vec<vtkm::FloatDefault,3> &minPoint,
+                 const vtkm::Vec<vtkm::FloatDefault,3> &maxPoint,
+                 std::mt19937 &generator)
+{
+  std::uniform_real_distribution<vtkm::FloatDefault> distribution(0, 1);
+
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > points;
+  points.Allocate(numPoints);
+  for (vtkm::Id index = 0; index < numPoints; ++index)
+  {
+    vtkm::Vec<vtkm::FloatDefault,3> point;
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      point[dim] = minPoint[dim] +
+          distribution(generator)*(maxPoint[dim] - minPoint[dim]);
+    }
+    points.GetPortalControl().Set(index, point);
+  }
+  return points;
+}
+
+void TryParametricCoordinatesInside()
+{
+  std::cout << "Checking parametric coordinates inside polygons."
+            << std::endl;
+
+  typedef vtkm::Vec<vtkm::FloatDefault,3> PCoordType;
+
+  // A pentagon has a vertex at (1, 0.5) and edges at distance
+  // 0.5*cos(pi/5) from the center everywhere else.
+  VTKM_TEST_ASSERT(ParametricCoordinatesInside(PCoordType(0.5f, 0.5f, 0.0f),
+                                               vtkm::CELL_SHAPE_POLYGON,
+                                               5),
+                   "Pentagon center not inside.");
+  VTKM_TEST_ASSERT(ParametricCoordinatesInside(PCoordType(0.99f, 0.5f, 0.0f),
+                                               vtkm::CELL_SHAPE_POLYGON,
+                                               5),
+                   "Point near pentagon vertex not inside.");
+  VTKM_TEST_ASSERT(!ParametricCoordinatesInside(PCoordType(0.5f, 0.01f, 0.0f),
+                                                vtkm::CELL_SHAPE_POLYGON,
+                                                5),
+                   "Point outside pentagon but inside circle is inside.");
+  VTKM_TEST_ASSERT(ParametricCoordinatesInside(PCoordType(0.5f, 0.1f, 0.0f),
+                                               vtkm::CELL_SHAPE_POLYGON,
+                                               5),
+                   "Point inside pentagon edge not inside.");
+
+  // Polygons with three or four points use the triangle and quad spaces.
+  VTKM_TEST_ASSERT(ParametricCoordinatesInside(PCoordType(0.9f, 0.05f, 0.0f),
+                                               vtkm::CELL_SHAPE_POLYGON,
+                                               3),
+                   "Triangular polygon point not inside.");
+  VTKM_TEST_ASSERT(ParametricCoordinatesInside(PCoordType(0.95f, 0.95f, 0.0f),
+                                               vtkm::CELL_SHAPE_POLYGON,
+                                               4),
+                   "Quadrilateral polygon corner not inside.");
+}
+
+void TryCellLocatorUniform()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id DIM = 32;
+  static const vtkm::Id NUM_QUERIES = 10000;
+
+  std::cout << "Locating points in a uniform grid of " << DIM*DIM*DIM
+            << " hexahedra." << std::endl;
+
+  vtkm::cont::DataSet dataSet =
+      vtkm::cont::DataSetBuilderUniform().Create(vtkm::Id3(DIM+1));
+
+  ////
+  //// BEGIN-EXAMPLE UseCellLocator.cxx
+  ////
+  CellLocator locator(dataSet.GetCellSet(),
+                      dataSet.GetCoordinateSystem(),
+                      Device());
+
+  vtkm::cont::ArrayHandle<vtkm::Id> cellIds;
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > pcoords;
+  ////
+  //// PAUSE-EXAMPLE
+  ////
+  std::mt19937 generator(42);
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > points =
+      MakeRandomPoints(NUM_QUERIES,
+                       vtkm::Vec<vtkm::FloatDefault,3>(-1),
+                       vtkm::Vec<vtkm::FloatDefault,3>(
+                         static_cast<vtkm::FloatDefault>(DIM+1)),
+                       generator);
+  ////
+  //// RESUME-EXAMPLE
+  ////
+  locator.FindCells(points, cellIds, pcoords, Device());
+  ////
+  //// END-EXAMPLE UseCellLocator.cxx
+  ////
+
+  VTKM_TEST_ASSERT(cellIds.GetNumberOfValues() == NUM_QUERIES,
+                   "Wrong number of results.");
+  const vtkm::FloatDefault size = static_cast<vtkm::FloatDefault>(DIM);
+  for (vtkm::Id index = 0; index < NUM_QUERIES; ++index)
+  {
+    vtkm::Vec<vtkm::FloatDefault,3> point =
+        points.GetPortalConstControl().Get(index);
+    vtkm::Id cellId = cellIds.GetPortalConstControl().Get(index);
+
+    // Points within the tolerance of the boundary may go either way.
+    bool outside = false;
+    bool inside = true;
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      outside |= ((point[dim] < -0.001f) || (point[dim] > size + 0.001f));
+      inside &= ((point[dim] > 0.001f) && (point[dim] < size - 0.001f));
+    }
+    if (outside)
+    {
+      VTKM_TEST_ASSERT(cellId == -1, "Found a cell for an outside point.");
+    }
+    if (inside)
+    {
+      VTKM_TEST_ASSERT(cellId >= 0, "Did not find a cell for an inside point.");
+    }
+    if (cellId < 0) { continue; }
+
+    // A point near a face may be found in either neighboring cell, so check
+    // that the parametric coordinates match the cell found.
+    vtkm::Id3 ijk(cellId%DIM, (cellId/DIM)%DIM, cellId/(DIM*DIM));
+    vtkm::Vec<vtkm::FloatDefault,3> pcoord =
+        pcoords.GetPortalConstControl().Get(index);
+    for (vtkm::IdComponent dim = 0; dim < 3; ++dim)
+    {
+      vtkm::FloatDefault expected =
+          point[dim] - static_cast<vtkm::FloatDefault>(ijk[dim]);
+      VTKM_TEST_ASSERT((expected > -0.001f) && (expected < 1.001f),
+                       "Found wrong cell.");
+      VTKM_TEST_ASSERT(test_equal(pcoord[dim], expected, 0.001),
+                       "Wrong parametric coordinates.");
+    }
+  }
+}
+
+// Uses the layout of benchmark::MakeTriangleGrid to check a cell id. Returns
+// true if the point is in the given triangle or within the tolerance of one
+// of its edges.
+bool PointNearTriangle(const vtkm::Vec<vtkm::FloatDefault,3> &point,
+                       vtkm::Id cellId,
+                       vtkm::Id dim)
+{
+  const vtkm::FloatDefault tolerance = 0.001f;
+  vtkm::Id square = cellId/2;
+  vtkm::FloatDefault x =
+      point[0] - static_cast<vtkm::FloatDefault>(square%dim);
+  vtkm::FloatDefault y =
+      point[1] - static_cast<vtkm::FloatDefault>(square/dim);
+  if ((x < -tolerance) || (x > 1 + tolerance) ||
+      (y < -tolerance) || (y > 1 + tolerance))
+  {
+    return false;
+  }
+  return (cellId%2 == 0) ? (x > y - tolerance) : (y > x - tolerance);
+}
+
+void TryCellLocatorTriangles()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id DIM = 256;
+  static const vtkm::Id NUM_QUERIES = 100000;
+  static const vtkm::Id NUM_BRUTE_FORCE_QUERIES = 200;
+
+  std::cout << "Locating points in " << 2*DIM*DIM << " triangles."
+            << std::endl;
+
+  vtkm::cont::DataSet dataSet = benchmark::MakeTriangleGrid(DIM);
+
+  vtkm::cont::Timer<Device> timer;
+  CellLocator locator(dataSet.GetCellSet(),
+                      dataSet.GetCoordinateSystem(),
+                      Device());
+  vtkm::Float64 buildTime = timer.GetElapsedTime();
+
+  // Some queries fall outside the grid so that points not found are also
+  // checked against brute force.
+  std::mt19937 generator(42);
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > points =
+      MakeRandomPoints(NUM_QUERIES,
+                       vtkm::Vec<vtkm::FloatDefault,3>(-8, -8, 0),
+                       vtkm::Vec<vtkm::FloatDefault,3>(
+                         static_cast<vtkm::FloatDefault>(DIM+8),
+                         static_cast<vtkm::FloatDefault>(DIM+8),
+                         0),
+                       generator);
+
+  vtkm::cont::ArrayHandle<vtkm::Id> cellIds;
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > pcoords;
+  // Run once to move everything to the device before timing.
+  locator.FindCells(points, cellIds, pcoords, Device());
+  timer.Reset();
+  locator.FindCells(points, cellIds, pcoords, Device());
+  vtkm::Float64 queryTime = timer.GetElapsedTime();
+
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > bruteForcePoints;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::CopySubRange(
+        points, 0, NUM_BRUTE_FORCE_QUERIES, bruteForcePoints);
+  vtkm::cont::ArrayHandle<vtkm::Id> bruteForceCellIds;
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > bruteForcePCoords;
+  timer.Reset();
+  vtkm::worklet::DispatcherMapField<BruteForceFindCell,Device>().Invoke(
+        bruteForcePoints,
+        dataSet.GetCellSet(),
+        dataSet.GetCoordinateSystem().GetData(),
+        bruteForceCellIds,
+        bruteForcePCoords);
+  vtkm::Float64 bruteForceTime = timer.GetElapsedTime();
+
+  std::cout << "  Build locator: " << buildTime << " s" << std::endl;
+  std::cout << "  Locator: "
+            << static_cast<vtkm::Float64>(NUM_QUERIES)/queryTime
+            << " queries/s" << std::endl;
+  std::cout << "  Brute force: "
+            << static_cast<vtkm::Float64>(NUM_BRUTE_FORCE_QUERIES)/bruteForceTime
+            << " queries/s" << std::endl;
+
+  const vtkm::FloatDefault size = static_cast<vtkm::FloatDefault>(DIM);
+  for (vtkm::Id index = 0; index < NUM_QUERIES; ++index)
+  {
+    vtkm::Vec<vtkm::FloatDefault,3> point =
+        points.GetPortalConstControl().Get(index);
+    vtkm::Id cellId = cellIds.GetPortalConstControl().Get(index);
+
+    // Points within the tolerance of the boundary may go either way.
+    bool outside = ((point[0] < -0.001f) || (point[0] > size + 0.001f) ||
+                    (point[1] < -0.001f) || (point[1] > size + 0.001f));
+    bool inside = ((point[0] > 0.001f) && (point[0] < size - 0.001f) &&
+                   (point[1] > 0.001f) && (point[1] < size - 0.001f));
+    if (outside)
+    {
+      VTKM_TEST_ASSERT(cellId == -1, "Found a cell for an outside point.");
+    }
+    if (inside)
+    {
+      VTKM_TEST_ASSERT(cellId >= 0, "Did not find a cell.");
+    }
+
+    // Points within the tolerance of an edge may be found in either neighbor.
+    if (cellId >= 0)
+    {
+      VTKM_TEST_ASSERT(PointNearTriangle(point, cellId, DIM),
+                       "Found wrong triangle.");
+    }
+  }
+
+  vtkm::Id numBruteForceOutside = 0;
+  for (vtkm::Id index = 0; index < NUM_BRUTE_FORCE_QUERIES; ++index)
+  {
+    vtkm::Vec<vtkm::FloatDefault,3> point =
+        bruteForcePoints.GetPortalConstControl().Get(index);
+    vtkm::Id cellId = cellIds.GetPortalConstControl().Get(index);
+    vtkm::Id bruteForceCellId =
+        bruteForceCellIds.GetPortalConstControl().Get(index);
+    if (bruteForceCellId < 0) { ++numBruteForceOutside; }
+    if (cellId == bruteForceCellId) { continue; }
+
+    // The two searches may only pick different triangles when the point is
+    // on an edge shared by both.
+    VTKM_TEST_ASSERT((cellId >= 0) && (bruteForceCellId >= 0),
+                     "Locator and brute force disagree.");
+    VTKM_TEST_ASSERT(PointNearTriangle(point, cellId, DIM) &&
+                     PointNearTriangle(point, bruteForceCellId, DIM),
+                     "Locator and brute force disagree.");
+  }
+  VTKM_TEST_ASSERT(numBruteForceOutside > 0,
+                   "No brute force query outside the grid.");
+}
+
+void TryPointLocator()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id NUM_POINTS = 100000;
+  static const vtkm::Id NUM_QUERIES = 100000;
+  static const vtkm::Id NUM_BRUTE_FORCE_QUERIES = 1000;
+
+  std::cout << "Finding nearest neighbors among " << NUM_POINTS << " points."
+            << std::endl;
+
+  std::mt19937 generator(42);
+  vtkm::cont::CoordinateSystem coords(
+        "coords",
+        MakeRandomPoints(NUM_POINTS,
+                         vtkm::Vec<vtkm::FloatDefault,3>(0),
+                         vtkm::Vec<vtkm::FloatDefault,3>(1),
+                         generator));
+  // Some queries fall outside the bounds of the points.
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > queries =
+      MakeRandomPoints(NUM_QUERIES,
+                       vtkm::Vec<vtkm::FloatDefault,3>(-0.1f),
+                       vtkm::Vec<vtkm::FloatDefault,3>(1.1f),
+                       generator);
+
+  vtkm::cont::Timer<Device> timer;
+  PointLocator locator(coords, Device());
+  vtkm::Float64 buildTime = timer.GetElapsedTime();
+
+  vtkm::cont::ArrayHandle<vtkm::Id> nearestIds;
+  vtkm::cont::ArrayHandle<vtkm::FloatDefault> distances;
+  // Run once to move everything to the device before timing.
+  locator.FindNearestNeighbors(queries, nearestIds, distances, Device());
+  timer.Reset();
+  locator.FindNearestNeighbors(queries, nearestIds, distances, Device());
+  vtkm::Float64 queryTime = timer.GetElapsedTime();
+
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > bruteForceQueries;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::CopySubRange(
+        queries, 0, NUM_BRUTE_FORCE_QUERIES, bruteForceQueries);
+  vtkm::cont::ArrayHandle<vtkm::Id> bruteForceIds;
+  vtkm::cont::ArrayHandle<vtkm::FloatDefault> bruteForceDistances;
+  timer.Reset();
+  vtkm::worklet::DispatcherMapField<BruteForceNearestPoint,Device>().Invoke(
+        bruteForceQueries,
+        coords.GetData(),
+        bruteForceIds,
+        bruteForceDistances);
+  vtkm::Float64 bruteForceTime = timer.GetElapsedTime();
+
+  std::cout << "  Build locator: " << buildTime << " s" << std::endl;
+  std::cout << "  Locator: "
+            << static_cast<vtkm::Float64>(NUM_QUERIES)/queryTime
+            << " queries/s" << std::endl;
+  std::cout << "  Brute force: "
+            << static_cast<vtkm::Float64>(NUM_BRUTE_FORCE_QUERIES)/bruteForceTime
+            << " queries/s" << std::endl;
+
+  for (vtkm::Id index = 0; index < NUM_BRUTE_FORCE_QUERIES; ++index)
+  {
+    // Compare distances rather than ids in case two points are equally near.
+    VTKM_TEST_ASSERT(
+          test_equal(distances.GetPortalConstControl().Get(index),
+                     bruteForceDistances.GetPortalConstControl().Get(index)),
+          "Locator did not find the nearest point.");
+  }
+}
+
+void Test()
+{
+  TryParametricCoordinatesInside();
+  TryCellLocatorUniform();
+  TryCellLocatorTriangles();
+  TryPointLocator();
+}
+
+} // anonymous namespace
+
+int Locators(int, char*[])
+{
+  return vtkm::cont::testing::Testing::Run(Test);
+}
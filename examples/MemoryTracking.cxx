@@ -0,0 +1,611 @@
+#include <vtkm/Assert.h>
+
+#include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/ArrayHandleCounting.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/StorageBasic.h>
+
+#include <vtkm/cont/internal/ArrayManagerExecutionShareWithControl.h>
+
+#include <vtkm/worklet/DispatcherMapField.h>
+#include <vtkm/worklet/WorkletMapField.h>
+
+#include <vtkm/cont/testing/Testing.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+////
+//// BEGIN-EXAMPLE MemoryTracker.cxx
+////
+struct MemoryUsage
+{
+  vtkm::UInt64 CurrentBytes;
+  vtkm::UInt64 PeakBytes;
+  vtkm::Id NumberOfAllocations;
+
+  VTKM_CONT
+  MemoryUsage() : CurrentBytes(0), PeakBytes(0), NumberOfAllocations(0) {  }
+
+  VTKM_CONT
+  void Allocate(vtkm::UInt64 numBytes)
+  {
+    this->CurrentBytes += numBytes;
+    this->NumberOfAllocations++;
+    if (this->CurrentBytes > this->PeakBytes)
+    {
+      this->PeakBytes = this->CurrentBytes;
+    }
+  }
+
+  VTKM_CONT
+  void Free(vtkm::UInt64 numBytes)
+  {
+    VTKM_ASSERT(numBytes <= this->CurrentBytes);
+    this->CurrentBytes -= numBytes;
+  }
+};
+
+enum MemoryEnvironment
+{
+  MEMORY_CONTROL,
+  MEMORY_EXECUTION
+};
+
+// Global record of array memory, kept per tag and per environment. The tag is
+// the name of the innermost MemoryTrackerScope active on the calling thread.
+class MemoryTracker
+{
+public:
+  VTKM_CONT
+  static MemoryTracker &Get()
+  {
+    static MemoryTracker tracker;
+    return tracker;
+  }
+
+  VTKM_CONT
+  std::string GetCurrentTag() const
+  {
+    const std::vector<std::string> &tagStack = GetTagStack();
+    return tagStack.empty() ? "untagged" : tagStack.back();
+  }
+
+  VTKM_CONT
+  void PushTag(const std::string &tag)
+  {
+    GetTagStack().push_back(tag);
+  }
+
+  VTKM_CONT
+  void PopTag()
+  {
+    VTKM_ASSERT(!GetTagStack().empty());
+    GetTagStack().pop_back();
+  }
+
+  VTKM_CONT
+  void RecordAllocation(const std::string &tag,
+                        MemoryEnvironment environment,
+                        vtkm::UInt64 numBytes)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Tags[tag][environment].Allocate(numBytes);
+    this->Totals[environment].Allocate(numBytes);
+  }
+
+  VTKM_CONT
+  void RecordFree(const std::string &tag,
+                  MemoryEnvironment environment,
+                  vtkm::UInt64 numBytes)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Tags[tag][environment].Free(numBytes);
+    this->Totals[environment].Free(numBytes);
+  }
+
+  VTKM_CONT
+  MemoryUsage GetUsage(const std::string &tag,
+                       MemoryEnvironment environment) const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    TagMapType::const_iterator tagUsage = this->Tags.find(tag);
+    if (tagUsage == this->Tags.end())
+    {
+      return MemoryUsage();
+    }
+    return tagUsage->second[environment];
+  }
+
+  VTKM_CONT
+  MemoryUsage GetTotalUsage(MemoryEnvironment environment) const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return this->Totals[environment];
+  }
+
+  VTKM_CONT
+  void WriteJSON(std::ostream &out) const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    out << "{\n  \"total\": ";
+    WriteEnvironmentsJSON(out, this->Totals);
+    out << ",\n  \"tags\": {";
+    for (TagMapType::const_iterator tagUsage = this->Tags.begin();
+         tagUsage != this->Tags.end();
+         tagUsage++)
+    {
+      out << ((tagUsage == this->Tags.begin()) ? "\n" : ",\n");
+      out << "    \"" << tagUsage->first << "\": ";
+      WriteEnvironmentsJSON(out, tagUsage->second);
+    }
+    out << "\n  }\n}\n";
+  }
+
+  // Forgets all recorded usage. Only meaningful when no tracked arrays exist.
+  VTKM_CONT
+  void Reset()
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Tags.clear();
+    this->Totals[MEMORY_CONTROL] = MemoryUsage();
+    this->Totals[MEMORY_EXECUTION] = MemoryUsage();
+  }
+
+private:
+  struct EnvironmentUsage
+  {
+    MemoryUsage Usage[2];
+
+    MemoryUsage &operator[](MemoryEnvironment environment)
+    {
+      return this->Usage[environment];
+    }
+    const MemoryUsage &operator[](MemoryEnvironment environment) const
+    {
+      return this->Usage[environment];
+    }
+  };
+
+  typedef std::map<std::string, EnvironmentUsage> TagMapType;
+
+  VTKM_CONT
+  MemoryTracker() {  }
+
+  // Each thread has its own stack of scopes, so the stack needs no lock and
+  // a scope on one thread does not tag allocations made on another.
+  VTKM_CONT
+  static std::vector<std::string> &GetTagStack()
+  {
+    static thread_local std::vector<std::string> tagStack;
+    return tagStack;
+  }
+
+  VTKM_CONT
+  static void WriteUsageJSON(std::ostream &out, const MemoryUsage &usage)
+  {
+    out << "{ \"current\": " << usage.CurrentBytes
+        << ", \"peak\": " << usage.PeakBytes
+        << ", \"allocations\": " << usage.NumberOfAllocations << " }";
+  }
+
+  VTKM_CONT
+  static void WriteEnvironmentsJSON(std::ostream &out,
+                                    const EnvironmentUsage &usage)
+  {
+    out << "{ \"control\": ";
+    WriteUsageJSON(out, usage[MEMORY_CONTROL]);
+    out << ", \"execution\": ";
+    WriteUsageJSON(out, usage[MEMORY_EXECUTION]);
+    out << " }";
+  }
+
+  mutable std::mutex Mutex;
+  TagMapType Tags;
+  EnvironmentUsage Totals;
+};
+
+// Attributes allocations made during its lifetime to the given tag.
+class MemoryTrackerScope
+{
+public:
+  VTKM_CONT
+  MemoryTrackerScope(const std::string &tag)
+  {
+    MemoryTracker::Get().PushTag(tag);
+  }
+
+  VTKM_CONT
+  ~MemoryTrackerScope()
+  {
+    MemoryTracker::Get().PopTag();
+  }
+};
+
+// Holds one recorded allocation. Frees are charged to the tag that allocated.
+class MemoryRecord
+{
+public:
+  VTKM_CONT
+  MemoryRecord(MemoryEnvironment environment)
+    : Environment(environment), NumberOfBytes(0) {  }
+
+  VTKM_CONT
+  ~MemoryRecord() { this->Set(0); }
+
+  VTKM_CONT
+  void Set(vtkm::UInt64 numBytes)
+  {
+    if (numBytes == this->NumberOfBytes) { return; }
+
+    MemoryTracker &tracker = MemoryTracker::Get();
+    if (this->NumberOfBytes > 0)
+    {
+      tracker.RecordFree(this->Tag, this->Environment, this->NumberOfBytes);
+    }
+    this->NumberOfBytes = numBytes;
+    if (this->NumberOfBytes > 0)
+    {
+      this->Tag = tracker.GetCurrentTag();
+      tracker.RecordAllocation(
+            this->Tag, this->Environment, this->NumberOfBytes);
+    }
+  }
+
+  // Gives back the bytes beyond numBytes without counting a new allocation.
+  VTKM_CONT
+  void Shrink(vtkm::UInt64 numBytes)
+  {
+    if (numBytes >= this->NumberOfBytes) { return; }
+
+    MemoryTracker::Get().RecordFree(
+          this->Tag, this->Environment, this->NumberOfBytes - numBytes);
+    this->NumberOfBytes = numBytes;
+  }
+
+private:
+  MemoryRecord(const MemoryRecord &);  // Not implemented
+  void operator=(const MemoryRecord &);  // Not implemented
+
+  MemoryEnvironment Environment;
+  vtkm::UInt64 NumberOfBytes;
+  std::string Tag;
+};
+////
+//// END-EXAMPLE MemoryTracker.cxx
+////
+
+} // anonymous namespace
+
+////
+//// BEGIN-EXAMPLE TrackedStorage.cxx
+////
+struct StorageTagTracked {  };
+
+namespace vtkm {
+namespace cont {
+namespace internal {
+
+// Basic storage that reports its allocations to the MemoryTracker.
+template<typename T>
+class Storage<T, StorageTagTracked>
+{
+  typedef vtkm::cont::internal::Storage<T, vtkm::cont::StorageTagBasic>
+      BasicStorageType;
+
+  struct Buffer
+  {
+    BasicStorageType BasicStorage;
+    MemoryRecord Record;
+
+    Buffer() : Record(MEMORY_CONTROL) {  }
+  };
+
+public:
+  typedef T ValueType;
+  typedef typename BasicStorageType::PortalType PortalType;
+  typedef typename BasicStorageType::PortalConstType PortalConstType;
+
+  VTKM_CONT
+  Storage() : Data(new Buffer) {  }
+
+  VTKM_CONT
+  PortalType GetPortal() { return this->Data->BasicStorage.GetPortal(); }
+
+  VTKM_CONT
+  PortalConstType GetPortalConst() const
+  {
+    return this->Data->BasicStorage.GetPortalConst();
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfValues() const
+  {
+    return this->Data->BasicStorage.GetNumberOfValues();
+  }
+
+  VTKM_CONT
+  void Allocate(vtkm::Id numberOfValues)
+  {
+    this->Data->BasicStorage.Allocate(numberOfValues);
+    this->RecordAllocation();
+  }
+
+  VTKM_CONT
+  void Shrink(vtkm::Id numberOfValues)
+  {
+    this->Data->BasicStorage.Shrink(numberOfValues);
+    this->Data->Record.Shrink(
+          static_cast<vtkm::UInt64>(numberOfValues)*sizeof(ValueType));
+  }
+
+  VTKM_CONT
+  void ReleaseResources()
+  {
+    this->Data->BasicStorage.ReleaseResources();
+    this->Data->Record.Set(0);
+  }
+
+  // Required for later use in ArrayTransfer class.
+  VTKM_CONT
+  BasicStorageType *GetBasicStorage() { return &this->Data->BasicStorage; }
+
+  VTKM_CONT
+  void RecordAllocation()
+  {
+    this->Data->Record.Set(
+          static_cast<vtkm::UInt64>(this->GetNumberOfValues())
+          * sizeof(ValueType));
+  }
+
+private:
+  std::shared_ptr<Buffer> Data;
+};
+
+template<typename T, typename Device>
+struct DeviceSharesControlMemory
+    : std::is_base_of<
+        vtkm::cont::internal::ArrayManagerExecutionShareWithControl<
+          T, vtkm::cont::StorageTagBasic>,
+        vtkm::cont::internal::ArrayManagerExecution<
+          T, vtkm::cont::StorageTagBasic, Device> >
+{  };
+
+// Uses the basic transfer and reports execution allocations. Devices that
+// share memory with the control environment allocate the control array
+// directly, so those allocations are charged to the control environment.
+template<typename T, typename Device>
+class ArrayTransfer<T, StorageTagTracked, Device>
+{
+  typedef vtkm::cont::internal::ArrayTransfer<
+      T, vtkm::cont::StorageTagBasic, Device> BasicTransferType;
+
+public:
+  typedef T ValueType;
+
+private:
+  typedef vtkm::cont::internal::Storage<T, StorageTagTracked> StorageType;
+
+public:
+  typedef typename StorageType::PortalType PortalControl;
+  typedef typename StorageType::PortalConstType PortalConstControl;
+
+  typedef typename BasicTransferType::PortalExecution PortalExecution;
+  typedef typename BasicTransferType::PortalConstExecution
+      PortalConstExecution;
+
+  VTKM_CONT
+  ArrayTransfer(StorageType *storage)
+    : Storage(storage),
+      Transfer(storage->GetBasicStorage()),
+      Record(MEMORY_EXECUTION) {  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfValues() const
+  {
+    return this->Transfer.GetNumberOfValues();
+  }
+
+  VTKM_CONT
+  PortalConstExecution PrepareForInput(bool updateData)
+  {
+    PortalConstExecution portal = this->Transfer.PrepareForInput(updateData);
+    this->RecordExecutionSize(this->Transfer.GetNumberOfValues());
+    return portal;
+  }
+
+  VTKM_CONT
+  PortalExecution PrepareForInPlace(bool updateData)
+  {
+    PortalExecution portal = this->Transfer.PrepareForInPlace(updateData);
+    this->RecordExecutionSize(this->Transfer.GetNumberOfValues());
+    return portal;
+  }
+
+  VTKM_CONT
+  PortalExecution PrepareForOutput(vtkm::Id numberOfValues)
+  {
+    PortalExecution portal = this->Transfer.PrepareForOutput(numberOfValues);
+    if (DeviceSharesControlMemory<T, Device>::value)
+    {
+      this->Storage->RecordAllocation();
+    }
+    else
+    {
+      this->RecordExecutionSize(numberOfValues);
+    }
+    return portal;
+  }
+
+  VTKM_CONT
+  void RetrieveOutputData(StorageType *storage) const
+  {
+    this->Transfer.RetrieveOutputData(storage->GetBasicStorage());
+    storage->RecordAllocation();
+  }
+
+  VTKM_CONT
+  void Shrink(vtkm::Id numberOfValues)
+  {
+    this->Transfer.Shrink(numberOfValues);
+    this->Record.Shrink(
+          static_cast<vtkm::UInt64>(numberOfValues)*sizeof(ValueType));
+  }
+
+  VTKM_CONT
+  void ReleaseResources()
+  {
+    this->Transfer.ReleaseResources();
+    this->Record.Set(0);
+  }
+
+private:
+  VTKM_CONT
+  void RecordExecutionSize(vtkm::Id numberOfValues)
+  {
+    if (!DeviceSharesControlMemory<T, Device>::value)
+    {
+      this->Record.Set(
+            static_cast<vtkm::UInt64>(numberOfValues)*sizeof(ValueType));
+    }
+  }
+
+  StorageType *Storage;
+  BasicTransferType Transfer;
+  MemoryRecord Record;
+};
+
+}
+}
+} // namespace vtkm::cont::internal
+////
+//// END-EXAMPLE TrackedStorage.cxx
+////
+
+namespace {
+
+////
+//// BEGIN-EXAMPLE ArrayHandleTracked.cxx
+////
+template<typename T>
+class ArrayHandleTracked
+    : public vtkm::cont::ArrayHandle<T, StorageTagTracked>
+{
+public:
+  VTKM_ARRAY_HANDLE_SUBCLASS(
+      ArrayHandleTracked,
+      (ArrayHandleTracked<T>),
+      (vtkm::cont::ArrayHandle<T, StorageTagTracked>));
+};
+////
+//// END-EXAMPLE ArrayHandleTracked.cxx
+////
+
+struct SquareValues : public vtkm::worklet::WorkletMapField
+{
+  typedef void ControlSignature(FieldIn<> input, FieldOut<> output);
+  typedef _2 ExecutionSignature(_1);
+
+  template<typename T>
+  VTKM_EXEC
+  T operator()(T value) const { return value*value; }
+};
+
+////
+//// BEGIN-EXAMPLE UsingMemoryTracker.cxx
+////
+VTKM_CONT
+vtkm::Id SumOfSquares(vtkm::Id numberOfValues)
+{
+  MemoryTrackerScope scope("SumOfSquares");
+
+  // This temporary is freed when the function returns.
+  ArrayHandleTracked<vtkm::Id> squares;
+  vtkm::worklet::DispatcherMapField<SquareValues> dispatcher;
+  dispatcher.Invoke(vtkm::cont::make_ArrayHandleCounting(
+                      vtkm::Id(0), vtkm::Id(1), numberOfValues),
+                    squares);
+
+  return vtkm::cont::DeviceAdapterAlgorithm<VTKM_DEFAULT_DEVICE_ADAPTER_TAG>::
+      Reduce(squares, vtkm::Id(0));
+}
+
+VTKM_CONT
+void ReportMemory(std::ostream &out)
+{
+  MemoryUsage usage = MemoryTracker::Get().GetTotalUsage(MEMORY_CONTROL);
+  out << "Control memory: " << usage.CurrentBytes << " bytes in use, "
+      << usage.PeakBytes << " bytes peak" << std::endl;
+
+  // Full report, broken down by tag.
+  MemoryTracker::Get().WriteJSON(out);
+}
+////
+//// END-EXAMPLE UsingMemoryTracker.cxx
+////
+
+void Test()
+{
+  MemoryTracker::Get().Reset();
+
+  const vtkm::Id ARRAY_SIZE = 1000;
+  vtkm::Id sum = SumOfSquares(ARRAY_SIZE);
+  VTKM_TEST_ASSERT(sum == (ARRAY_SIZE-1)*ARRAY_SIZE*(2*ARRAY_SIZE-1)/6,
+                   "Bad sum.");
+
+  MemoryUsage usage =
+      MemoryTracker::Get().GetUsage("SumOfSquares", MEMORY_CONTROL);
+  VTKM_TEST_ASSERT(usage.CurrentBytes == 0, "Temporary array leaked.");
+  VTKM_TEST_ASSERT(usage.PeakBytes == ARRAY_SIZE*sizeof(vtkm::Id),
+                   "Wrong peak memory.");
+  VTKM_TEST_ASSERT(usage.NumberOfAllocations == 1,
+                   "Wrong number of allocations.");
+
+  {
+    ArrayHandleTracked<vtkm::Float32> heldArray;
+    {
+      MemoryTrackerScope scope("HeldArray");
+      // Shrinking gives back bytes without counting another allocation.
+      heldArray.Allocate(200);
+      heldArray.Shrink(100);
+    }
+    // A copy of the array handle shares the memory and is not counted again.
+    ArrayHandleTracked<vtkm::Float32> heldCopy = heldArray;
+
+    usage = MemoryTracker::Get().GetTotalUsage(MEMORY_CONTROL);
+    VTKM_TEST_ASSERT(usage.CurrentBytes == 100*sizeof(vtkm::Float32),
+                     "Held array not counted.");
+    VTKM_TEST_ASSERT(usage.PeakBytes == ARRAY_SIZE*sizeof(vtkm::Id),
+                     "Wrong total peak memory.");
+    VTKM_TEST_ASSERT(MemoryTracker::Get().GetUsage("HeldArray",
+                                                   MEMORY_CONTROL).CurrentBytes
+                     == 100*sizeof(vtkm::Float32),
+                     "Held array not charged to tag.");
+    VTKM_TEST_ASSERT(MemoryTracker::Get().GetUsage(
+                       "HeldArray", MEMORY_CONTROL).NumberOfAllocations == 1,
+                     "Shrink counted as an allocation.");
+
+    std::stringstream report;
+    ReportMemory(report);
+    std::cout << report.str();
+    VTKM_TEST_ASSERT(report.str().find("\"HeldArray\"") != std::string::npos,
+                     "Tag missing from JSON report.");
+  }
+
+  usage = MemoryTracker::Get().GetTotalUsage(MEMORY_CONTROL);
+  VTKM_TEST_ASSERT(usage.CurrentBytes == 0, "Array memory not released.");
+}
+
+} // anonymous namespace
+
+int MemoryTracking(int, char *[])
+{
+  return vtkm::cont::testing::Testing::Run(Test);
+}
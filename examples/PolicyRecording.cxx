@@ -0,0 +1,403 @@
+#include <vtkm/cont/ArrayHandleUniformPointCoordinates.h>
+#include <vtkm/cont/CellSetExplicit.h>
+#include <vtkm/cont/CellSetSingleType.h>
+#include <vtkm/cont/CellSetStructured.h>
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DeviceAdapterListTag.h>
+#include <vtkm/cont/DynamicArrayHandle.h>
+#include <vtkm/cont/DynamicCellSet.h>
+
+#include <vtkm/filter/PointElevation.h>
+#include <vtkm/filter/PolicyBase.h>
+
+#include <vtkm/ListTag.h>
+#include <vtkm/TypeListTag.h>
+
+#include <vtkm/cont/testing/MakeTestDataSet.h>
+#include <vtkm/cont/testing/Testing.h>
+
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+////
+//// BEGIN-EXAMPLE RecordedTypeNames.cxx
+////
+// The C++ spelling of each type the recorder can recognize, used when writing
+// the policy header.
+template<typename T>
+struct RecordedName;
+
+#define RECORDED_NAME(...) \
+  template<> \
+  struct RecordedName<__VA_ARGS__> \
+  { \
+    static std::string Get() { return #__VA_ARGS__; } \
+  }
+
+RECORDED_NAME(vtkm::Int32);
+RECORDED_NAME(vtkm::Int64);
+RECORDED_NAME(vtkm::Float32);
+RECORDED_NAME(vtkm::Float64);
+RECORDED_NAME(vtkm::Vec<vtkm::Float32,3>);
+RECORDED_NAME(vtkm::Vec<vtkm::Float64,3>);
+
+RECORDED_NAME(vtkm::cont::StorageTagBasic);
+RECORDED_NAME(vtkm::cont::ArrayHandleUniformPointCoordinates::StorageTag);
+
+RECORDED_NAME(vtkm::cont::CellSetStructured<1>);
+RECORDED_NAME(vtkm::cont::CellSetStructured<2>);
+RECORDED_NAME(vtkm::cont::CellSetStructured<3>);
+RECORDED_NAME(vtkm::cont::CellSetExplicit<>);
+RECORDED_NAME(vtkm::cont::CellSetSingleType<>);
+
+#undef RECORDED_NAME
+
+typedef vtkm::TypeListTagCommon RecordedTypeCandidates;
+
+struct RecordedStorageCandidates
+    : vtkm::ListTagBase<vtkm::cont::StorageTagBasic,
+                        vtkm::cont::ArrayHandleUniformPointCoordinates::StorageTag>
+{  };
+
+struct RecordedStructuredCellSetCandidates
+    : vtkm::ListTagBase<vtkm::cont::CellSetStructured<1>,
+                        vtkm::cont::CellSetStructured<2>,
+                        vtkm::cont::CellSetStructured<3> >
+{  };
+
+struct RecordedUnstructuredCellSetCandidates
+    : vtkm::ListTagBase<vtkm::cont::CellSetExplicit<>,
+                        vtkm::cont::CellSetSingleType<> >
+{  };
+////
+//// END-EXAMPLE RecordedTypeNames.cxx
+////
+
+////
+//// BEGIN-EXAMPLE DispatchRecorder.cxx
+////
+// The names recorded for one of the lists in a policy. If anything is seen
+// that cannot be named, the generated policy keeps the default list.
+struct RecordedList
+{
+  std::set<std::string> Names;
+  bool Unrecognized;
+  std::string DefaultList;
+
+  RecordedList(const std::string &defaultList)
+    : Unrecognized(false), DefaultList(defaultList) {  }
+
+  std::string GetListTag() const
+  {
+    if (this->Unrecognized)
+    {
+      return this->DefaultList;
+    }
+    if (this->Names.empty())
+    {
+      return "vtkm::ListTagEmpty";
+    }
+
+    std::stringstream listTag;
+    listTag << "vtkm::ListTagBase<";
+    for (std::set<std::string>::const_iterator name = this->Names.begin();
+         name != this->Names.end();
+         name++)
+    {
+      listTag << ((name == this->Names.begin()) ? "" : ", ") << *name;
+    }
+    listTag << ">";
+    return listTag.str();
+  }
+};
+
+template<typename DynamicArrayType>
+struct RecordArrayTypeFunctor
+{
+  const DynamicArrayType *Array;
+  RecordedList *Types;
+  RecordedList *Storages;
+  bool *Found;
+
+  template<typename T>
+  struct StorageFunctor
+  {
+    const RecordArrayTypeFunctor *Parent;
+
+    template<typename Storage>
+    VTKM_CONT
+    void operator()(Storage) const
+    {
+      this->template Check<Storage>(
+            typename vtkm::cont::internal::IsValidArrayHandle<T,Storage>::type());
+    }
+
+    template<typename Storage>
+    VTKM_CONT
+    void Check(std::true_type) const
+    {
+      if (this->Parent->Array->template IsTypeAndStorage<T,Storage>())
+      {
+        this->Parent->Types->Names.insert(RecordedName<T>::Get());
+        this->Parent->Storages->Names.insert(RecordedName<Storage>::Get());
+        *this->Parent->Found = true;
+      }
+    }
+
+    template<typename Storage>
+    VTKM_CONT
+    void Check(std::false_type) const {  }
+  };
+
+  template<typename T>
+  VTKM_CONT
+  void operator()(T) const
+  {
+    StorageFunctor<T> storageFunctor = { this };
+    vtkm::ListForEach(storageFunctor, RecordedStorageCandidates());
+  }
+};
+
+struct RecordCellSetTypeFunctor
+{
+  const vtkm::cont::DynamicCellSet *CellSet;
+  RecordedList *CellSets;
+  bool *Found;
+
+  template<typename CellSetType>
+  VTKM_CONT
+  void operator()(CellSetType) const
+  {
+    if (this->CellSet->IsType<CellSetType>())
+    {
+      this->CellSets->Names.insert(RecordedName<CellSetType>::Get());
+      *this->Found = true;
+    }
+  }
+};
+
+// Records the concrete types of all the data that pass through it. This is
+// meant to be turned on for representative runs of a pipeline and then used
+// to write a policy that only lists the types that were seen.
+class DispatchRecorder
+{
+public:
+  VTKM_CONT
+  DispatchRecorder()
+    : FieldTypes("VTKM_DEFAULT_TYPE_LIST_TAG"),
+      FieldStorages("VTKM_DEFAULT_STORAGE_LIST_TAG"),
+      CoordinateTypes("VTKM_DEFAULT_COORDINATE_SYSTEM_TYPE_LIST_TAG"),
+      CoordinateStorages("VTKM_DEFAULT_COORDINATE_SYSTEM_STORAGE_LIST_TAG"),
+      StructuredCellSets("vtkm::cont::CellSetListTagStructured"),
+      UnstructuredCellSets("vtkm::cont::CellSetListTagUnstructured")
+  {  }
+
+  VTKM_CONT
+  void RecordDataSet(const vtkm::cont::DataSet &dataSet)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+
+    for (vtkm::Id fieldIndex = 0;
+         fieldIndex < dataSet.GetNumberOfFields();
+         fieldIndex++)
+    {
+      this->RecordArray(dataSet.GetField(fieldIndex).GetData(),
+                        this->FieldTypes,
+                        this->FieldStorages);
+    }
+    for (vtkm::Id coordIndex = 0;
+         coordIndex < dataSet.GetNumberOfCoordinateSystems();
+         coordIndex++)
+    {
+      this->RecordArray(dataSet.GetCoordinateSystem(coordIndex).GetData(),
+                        this->CoordinateTypes,
+                        this->CoordinateStorages);
+    }
+    for (vtkm::Id cellSetIndex = 0;
+         cellSetIndex < dataSet.GetNumberOfCellSets();
+         cellSetIndex++)
+    {
+      this->RecordCellSet(dataSet.GetCellSet(cellSetIndex));
+    }
+  }
+
+  VTKM_CONT
+  void WritePolicyHeader(std::ostream &out, const std::string &policyName) const
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+
+    out << "// Generated by DispatchRecorder from the types seen at run time.\n"
+        << "#ifndef " << policyName << "_h\n"
+        << "#define " << policyName << "_h\n\n"
+        << "#include <vtkm/cont/ArrayHandleUniformPointCoordinates.h>\n"
+        << "#include <vtkm/cont/CellSetListTag.h>\n"
+        << "#include <vtkm/cont/DeviceAdapterListTag.h>\n"
+        << "#include <vtkm/cont/StorageListTag.h>\n"
+        << "#include <vtkm/filter/PolicyBase.h>\n"
+        << "#include <vtkm/ListTag.h>\n"
+        << "#include <vtkm/TypeListTag.h>\n\n"
+        << "struct " << policyName << " : vtkm::filter::PolicyBase<"
+        << policyName << ">\n"
+        << "{\n"
+        << "  typedef " << this->FieldTypes.GetListTag()
+        << " FieldTypeList;\n"
+        << "  typedef " << this->FieldStorages.GetListTag()
+        << " FieldStorageList;\n"
+        << "  typedef " << this->CoordinateTypes.GetListTag()
+        << " CoordinateTypeList;\n"
+        << "  typedef " << this->CoordinateStorages.GetListTag()
+        << " CoordinateStorageList;\n"
+        << "  typedef " << this->StructuredCellSets.GetListTag()
+        << " StructuredCellSetList;\n"
+        << "  typedef " << this->UnstructuredCellSets.GetListTag()
+        << " UnstructuredCellSetList;\n"
+        << "  typedef vtkm::ListTagJoin<StructuredCellSetList,"
+        << "UnstructuredCellSetList> AllCellSetList;\n"
+        << "  typedef VTKM_DEFAULT_DEVICE_ADAPTER_LIST_TAG DeviceAdapterList;\n"
+        << "};\n\n"
+        << "#endif //" << policyName << "_h\n";
+  }
+
+private:
+  template<typename DynamicArrayType>
+  VTKM_CONT
+  static void RecordArray(const DynamicArrayType &array,
+                          RecordedList &types,
+                          RecordedList &storages)
+  {
+    bool found = false;
+    RecordArrayTypeFunctor<DynamicArrayType> functor =
+      { &array, &types, &storages, &found };
+    vtkm::ListForEach(functor, RecordedTypeCandidates());
+    if (!found)
+    {
+      types.Unrecognized = true;
+      storages.Unrecognized = true;
+    }
+  }
+
+  VTKM_CONT
+  void RecordCellSet(const vtkm::cont::DynamicCellSet &cellSet)
+  {
+    bool found = false;
+    RecordCellSetTypeFunctor structuredFunctor =
+      { &cellSet, &this->StructuredCellSets, &found };
+    vtkm::ListForEach(structuredFunctor,
+                      RecordedStructuredCellSetCandidates());
+    RecordCellSetTypeFunctor unstructuredFunctor =
+      { &cellSet, &this->UnstructuredCellSets, &found };
+    vtkm::ListForEach(unstructuredFunctor,
+                      RecordedUnstructuredCellSetCandidates());
+    if (!found)
+    {
+      this->StructuredCellSets.Unrecognized = true;
+      this->UnstructuredCellSets.Unrecognized = true;
+    }
+  }
+
+  mutable std::mutex Mutex;
+  RecordedList FieldTypes;
+  RecordedList FieldStorages;
+  RecordedList CoordinateTypes;
+  RecordedList CoordinateStorages;
+  RecordedList StructuredCellSets;
+  RecordedList UnstructuredCellSets;
+};
+////
+//// END-EXAMPLE DispatchRecorder.cxx
+////
+
+////
+//// BEGIN-EXAMPLE RecordedPolicy.cxx
+////
+// Policy written by DispatchRecorder after running the pipeline on a uniform
+// grid with scalar fields.
+struct PolicyRecordedUniform
+    : vtkm::filter::PolicyBase<PolicyRecordedUniform>
+{
+  typedef vtkm::ListTagBase<vtkm::Float32> FieldTypeList;
+  typedef vtkm::ListTagBase<vtkm::cont::StorageTagBasic> FieldStorageList;
+  typedef vtkm::ListTagBase<vtkm::Vec<vtkm::Float32,3> > CoordinateTypeList;
+  typedef vtkm::ListTagBase<
+      vtkm::cont::ArrayHandleUniformPointCoordinates::StorageTag>
+    CoordinateStorageList;
+  typedef vtkm::ListTagBase<vtkm::cont::CellSetStructured<3> >
+    StructuredCellSetList;
+  typedef vtkm::ListTagEmpty UnstructuredCellSetList;
+  typedef vtkm::ListTagJoin<StructuredCellSetList,UnstructuredCellSetList>
+    AllCellSetList;
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_LIST_TAG DeviceAdapterList;
+};
+////
+//// END-EXAMPLE RecordedPolicy.cxx
+////
+
+void Test()
+{
+  vtkm::cont::testing::MakeTestDataSet makeData;
+
+  ////
+  //// BEGIN-EXAMPLE UsingDispatchRecorder.cxx
+  ////
+  DispatchRecorder recorder;
+
+  // Record each data set that goes through the pipeline.
+  vtkm::cont::DataSet uniformData = makeData.Make3DUniformDataSet0();
+  recorder.RecordDataSet(uniformData);
+
+  // After the representative runs, write the narrowed policy.
+  std::stringstream policyHeader;
+  recorder.WritePolicyHeader(policyHeader, "PolicyRecordedUniform");
+  ////
+  //// END-EXAMPLE UsingDispatchRecorder.cxx
+  ////
+  std::cout << policyHeader.str();
+
+  std::string header = policyHeader.str();
+  VTKM_TEST_ASSERT(
+        header.find("typedef vtkm::ListTagBase<vtkm::Float32> FieldTypeList;")
+        != std::string::npos,
+        "Field types not recorded.");
+  VTKM_TEST_ASSERT(
+        header.find("ArrayHandleUniformPointCoordinates::StorageTag>"
+                    " CoordinateStorageList;") != std::string::npos,
+        "Coordinate storage not recorded.");
+  VTKM_TEST_ASSERT(
+        header.find("vtkm::ListTagBase<vtkm::cont::CellSetStructured<3>>"
+                    " StructuredCellSetList;") != std::string::npos,
+        "Cell set not recorded.");
+  VTKM_TEST_ASSERT(
+        header.find("typedef vtkm::ListTagEmpty UnstructuredCellSetList;")
+        != std::string::npos,
+        "Unexpected unstructured cell set.");
+
+  // Recording an explicit data set adds its types.
+  recorder.RecordDataSet(makeData.Make3DExplicitDataSet0());
+  policyHeader.str("");
+  recorder.WritePolicyHeader(policyHeader, "PolicyRecordedAll");
+  header = policyHeader.str();
+  VTKM_TEST_ASSERT(header.find("vtkm::cont::CellSetExplicit<>")
+                   != std::string::npos,
+                   "Explicit cell set not recorded.");
+
+  // The recorded policy works with the filters.
+  vtkm::filter::PointElevation elevationFilter;
+  elevationFilter.SetOutputFieldName("elevation");
+  vtkm::filter::ResultField result =
+      elevationFilter.Execute(uniformData,
+                              uniformData.GetCoordinateSystem(),
+                              PolicyRecordedUniform());
+  VTKM_TEST_ASSERT(result.IsValid(), "Filter failed with recorded policy.");
+}
+
+} // anonymous namespace
+
+int PolicyRecording(int, char *[])
+{
+  return vtkm::cont::testing::Testing::Run(Test);
+}
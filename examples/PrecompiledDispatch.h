@@ -0,0 +1,52 @@
+#ifndef vtkm_examples_PrecompiledDispatch_h
+#define vtkm_examples_PrecompiledDispatch_h
+
+////
+//// BEGIN-EXAMPLE PrecompiledDispatchHeader.cxx
+////
+#include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/CellSetExplicit.h>
+#include <vtkm/cont/CellSetSingleType.h>
+#include <vtkm/cont/CellSetStructured.h>
+#include <vtkm/cont/DynamicArrayHandle.h>
+#include <vtkm/cont/DynamicCellSet.h>
+
+namespace precompiled {
+
+// Field value types compiled into the library.
+struct FieldTypes
+    : vtkm::ListTagBase<vtkm::Float32,
+                        vtkm::Float64,
+                        vtkm::Vec<vtkm::Float32,3>,
+                        vtkm::Vec<vtkm::Float64,3> >
+{  };
+
+// Cell set types compiled into the library.
+struct CellSetTypes
+    : vtkm::ListTagBase<vtkm::cont::CellSetStructured<2>,
+                        vtkm::cont::CellSetStructured<3>,
+                        vtkm::cont::CellSetExplicit<>,
+                        vtkm::cont::CellSetSingleType<> >
+{  };
+
+// Averages a cell field onto the points of the cell set. This is only
+// declared here. The library instantiates it for every combination of
+// FieldTypes and CellSetTypes, and other combinations will not link.
+template<typename T, typename CellSetType>
+VTKM_CONT
+void AverageCellToPoint(const CellSetType &cellSet,
+                        const vtkm::cont::ArrayHandle<T> &cellField,
+                        vtkm::cont::ArrayHandle<T> &pointField);
+
+// Resolves the dynamic types and calls one of the instantiations above.
+VTKM_CONT
+vtkm::cont::DynamicArrayHandle
+AverageCellToPoint(const vtkm::cont::DynamicCellSet &cellSet,
+                   const vtkm::cont::DynamicArrayHandle &cellField);
+
+} // namespace precompiled
+////
+//// END-EXAMPLE PrecompiledDispatchHeader.cxx
+////
+
+#endif //vtkm_examples_PrecompiledDispatch_h
@@ -0,0 +1,26 @@
+// Compiled only by the precompiled-dispatch-comparison target. Compare with
+// LocalDispatchComparison.cxx, which does the same without the library.
+
+#include "PrecompiledDispatch.h"
+
+#include <vtkm/cont/DataSet.h>
+
+#include <string>
+
+VTKM_CONT
+vtkm::cont::DataSet
+CompareAverageCellFieldToPoints(const vtkm::cont::DataSet &inData,
+                                const std::string &fieldName)
+{
+  vtkm::cont::Field inField = inData.GetField(fieldName);
+
+  vtkm::cont::DynamicArrayHandle outFieldData =
+      precompiled::AverageCellToPoint(
+        inData.GetCellSet(inField.GetAssocCellSet()), inField.GetData());
+
+  vtkm::cont::DataSet outData = inData;
+  outData.AddField(vtkm::cont::Field(fieldName + "_point",
+                                     vtkm::cont::Field::ASSOC_POINTS,
+                                     outFieldData));
+  return outData;
+}
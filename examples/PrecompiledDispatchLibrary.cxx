@@ -0,0 +1,126 @@
+////
+//// BEGIN-EXAMPLE PrecompiledDispatchLibrary.cxx
+////
+#include "PrecompiledDispatch.h"
+
+#include <vtkm/cont/StorageListTag.h>
+
+#include <vtkm/worklet/DispatcherMapTopology.h>
+#include <vtkm/worklet/WorkletMapTopology.h>
+
+#include <vtkm/VecTraits.h>
+
+namespace precompiled {
+
+namespace {
+
+class AverageCellField : public vtkm::worklet::WorkletMapCellToPoint
+{
+public:
+  typedef void ControlSignature(CellSetIn cellSet,
+                                FieldInCell<> inputCellField,
+                                FieldOut<> outputPointField);
+  typedef void ExecutionSignature(CellCount, _2, _3);
+  using InputDomain = _1;
+
+  template<typename InputCellFieldType, typename T>
+  VTKM_EXEC
+  void operator()(vtkm::IdComponent numCells,
+                  const InputCellFieldType &inputCellField,
+                  T &fieldAverage) const
+  {
+    typedef typename vtkm::VecTraits<T>::ComponentType ComponentType;
+
+    fieldAverage = T(ComponentType(0));
+    for (vtkm::IdComponent cellIndex = 0; cellIndex < numCells; cellIndex++)
+    {
+      fieldAverage = fieldAverage + inputCellField[cellIndex];
+    }
+    fieldAverage = fieldAverage / T(static_cast<ComponentType>(numCells));
+  }
+};
+
+template<typename CellSetType>
+struct AverageFieldFunctor
+{
+  const CellSetType *CellSet;
+  vtkm::cont::DynamicArrayHandle *Result;
+
+  template<typename T>
+  VTKM_CONT
+  void operator()(const vtkm::cont::ArrayHandle<T> &cellField) const
+  {
+    vtkm::cont::ArrayHandle<T> pointField;
+    AverageCellToPoint(*this->CellSet, cellField, pointField);
+    *this->Result = pointField;
+  }
+};
+
+struct AverageCellSetFunctor
+{
+  vtkm::cont::DynamicArrayHandle CellField;
+  vtkm::cont::DynamicArrayHandle *Result;
+
+  template<typename CellSetType>
+  VTKM_CONT
+  void operator()(const CellSetType &cellSet) const
+  {
+    AverageFieldFunctor<CellSetType> fieldFunctor = { &cellSet, this->Result };
+    this->CellField.ResetTypeList(FieldTypes()).
+        ResetStorageList(vtkm::cont::StorageListTagBasic()).
+        CastAndCall(fieldFunctor);
+  }
+};
+
+} // anonymous namespace
+
+template<typename T, typename CellSetType>
+VTKM_CONT
+void AverageCellToPoint(const CellSetType &cellSet,
+                        const vtkm::cont::ArrayHandle<T> &cellField,
+                        vtkm::cont::ArrayHandle<T> &pointField)
+{
+  vtkm::worklet::DispatcherMapTopology<AverageCellField> dispatcher;
+  dispatcher.Invoke(cellSet, cellField, pointField);
+}
+
+VTKM_CONT
+vtkm::cont::DynamicArrayHandle
+AverageCellToPoint(const vtkm::cont::DynamicCellSet &cellSet,
+                   const vtkm::cont::DynamicArrayHandle &cellField)
+{
+  vtkm::cont::DynamicArrayHandle result;
+  AverageCellSetFunctor cellSetFunctor = { cellField, &result };
+  cellSet.ResetCellSetList(CellSetTypes()).CastAndCall(cellSetFunctor);
+  return result;
+}
+
+// Explicitly instantiate every combination listed in the header. These are
+// the only copies of the worklet that get compiled.
+#define PRECOMPILED_INSTANTIATE(T, CellSetType) \
+  template VTKM_CONT void AverageCellToPoint<T, CellSetType>( \
+      const CellSetType &, \
+      const vtkm::cont::ArrayHandle<T> &, \
+      vtkm::cont::ArrayHandle<T> &)
+
+#define PRECOMPILED_INSTANTIATE_FIELD(T) \
+  PRECOMPILED_INSTANTIATE(T, vtkm::cont::CellSetStructured<2>); \
+  PRECOMPILED_INSTANTIATE(T, vtkm::cont::CellSetStructured<3>); \
+  PRECOMPILED_INSTANTIATE(T, vtkm::cont::CellSetExplicit<>); \
+  PRECOMPILED_INSTANTIATE(T, vtkm::cont::CellSetSingleType<>)
+
+typedef vtkm::Vec<vtkm::Float32,3> Vec3Float32;
+typedef vtkm::Vec<vtkm::Float64,3> Vec3Float64;
+
+PRECOMPILED_INSTANTIATE_FIELD(vtkm::Float32);
+PRECOMPILED_INSTANTIATE_FIELD(vtkm::Float64);
+PRECOMPILED_INSTANTIATE_FIELD(Vec3Float32);
+PRECOMPILED_INSTANTIATE_FIELD(Vec3Float64);
+
+#undef PRECOMPILED_INSTANTIATE_FIELD
+#undef PRECOMPILED_INSTANTIATE
+
+} // namespace precompiled
+////
+//// END-EXAMPLE PrecompiledDispatchLibrary.cxx
+////
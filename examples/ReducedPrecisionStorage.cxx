@@ -0,0 +1,432 @@
+#include <vtkm/Types.h>
+
+////
+//// BEGIN-EXAMPLE HalfFloatFunctors.cxx
+////
+// Converts IEEE half precision values (stored as vtkm::UInt16) to Float32.
+struct HalfToFloat32
+{
+  VTKM_EXEC_CONT
+  vtkm::Float32 operator()(vtkm::UInt16 half) const
+  {
+    vtkm::UInt32 sign = static_cast<vtkm::UInt32>(half & 0x8000u) << 16;
+    vtkm::UInt32 exponent = (half >> 10) & 0x1Fu;
+    vtkm::UInt32 mantissa = half & 0x3FFu;
+
+    if (exponent == 0)
+    {
+      // Zero or subnormal. The value is mantissa * 2^-24, which is exact.
+      vtkm::Float32 magnitude =
+          static_cast<vtkm::Float32>(mantissa)*5.9604644775390625e-8f;
+      return sign ? -magnitude : magnitude;
+    }
+
+    union { vtkm::Float32 Value; vtkm::UInt32 Bits; } convert;
+    if (exponent == 0x1Fu)
+    {
+      // Infinity or NaN.
+      convert.Bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else
+    {
+      // Normal value. Rebias the exponent from 15 to 127.
+      convert.Bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    return convert.Value;
+  }
+};
+
+// Converts Float32 values to IEEE half precision with round to nearest even.
+struct Float32ToHalf
+{
+  VTKM_EXEC_CONT
+  vtkm::UInt16 operator()(vtkm::Float32 value) const
+  {
+    union { vtkm::Float32 Value; vtkm::UInt32 Bits; } convert;
+    convert.Value = value;
+    vtkm::UInt32 sign = (convert.Bits >> 16) & 0x8000u;
+    vtkm::UInt32 absBits = convert.Bits & 0x7FFFFFFFu;
+
+    vtkm::UInt32 halfBits;
+    if (absBits >= 0x7F800000u)
+    {
+      // Infinity or NaN (keep NaN quiet).
+      halfBits = 0x7C00u | ((absBits > 0x7F800000u) ? 0x0200u : 0u);
+    }
+    else if (absBits >= 0x47800000u)
+    {
+      // Too large for half precision.
+      halfBits = 0x7C00u;
+    }
+    else if (absBits >= 0x38800000u)
+    {
+      // Normal value. Rebias the exponent and round off 13 mantissa bits. A
+      // carry out of the mantissa correctly increments the exponent (and
+      // rounds to infinity at the top of the range).
+      halfBits = (absBits - 0x38000000u) >> 13;
+      vtkm::UInt32 remainder = absBits & 0x1FFFu;
+      if ((remainder > 0x1000u) ||
+          ((remainder == 0x1000u) && ((halfBits & 1u) != 0)))
+      {
+        halfBits++;
+      }
+    }
+    else if (absBits >= 0x33000000u)
+    {
+      // Subnormal half value.
+      vtkm::UInt32 exponent = absBits >> 23;
+      vtkm::UInt32 mantissa = (absBits & 0x7FFFFFu) | 0x800000u;
+      vtkm::UInt32 shift = 126 - exponent;
+      halfBits = mantissa >> shift;
+      vtkm::UInt32 remainder = mantissa & ((1u << shift) - 1);
+      vtkm::UInt32 halfway = 1u << (shift - 1);
+      if ((remainder > halfway) ||
+          ((remainder == halfway) && ((halfBits & 1u) != 0)))
+      {
+        halfBits++;
+      }
+    }
+    else
+    {
+      // Rounds to zero.
+      halfBits = 0;
+    }
+
+    return static_cast<vtkm::UInt16>(sign | halfBits);
+  }
+};
+////
+//// END-EXAMPLE HalfFloatFunctors.cxx
+////
+
+////
+//// BEGIN-EXAMPLE ArrayHandleHalf.cxx
+////
+#include <vtkm/cont/ArrayHandleTransform.h>
+
+class ArrayHandleHalf
+    : public vtkm::cont::ArrayHandleTransform<
+          vtkm::Float32,
+          vtkm::cont::ArrayHandle<vtkm::UInt16>,
+          HalfToFloat32,
+          Float32ToHalf>
+{
+public:
+  VTKM_ARRAY_HANDLE_SUBCLASS_NT(
+      ArrayHandleHalf,
+      (vtkm::cont::ArrayHandleTransform<
+         vtkm::Float32,
+         vtkm::cont::ArrayHandle<vtkm::UInt16>,
+         HalfToFloat32,
+         Float32ToHalf>)
+      );
+
+  VTKM_CONT
+  ArrayHandleHalf(const vtkm::cont::ArrayHandle<vtkm::UInt16> &halfArray)
+    : Superclass(halfArray, HalfToFloat32(), Float32ToHalf()) {  }
+};
+////
+//// END-EXAMPLE ArrayHandleHalf.cxx
+////
+
+////
+//// BEGIN-EXAMPLE QuantizeFunctors.cxx
+////
+// StoreType is expected to be an unsigned integer type such as vtkm::UInt8
+// or vtkm::UInt16. The full range of the type maps linearly to the range
+// [Offset, Offset + Scale*max].
+template<typename StoreType>
+struct DequantizeFunctor
+{
+  VTKM_EXEC_CONT
+  DequantizeFunctor(vtkm::Float32 offset = 0, vtkm::Float32 scale = 1)
+    : Offset(offset), Scale(scale) {  }
+
+  VTKM_EXEC_CONT
+  vtkm::Float32 operator()(StoreType level) const
+  {
+    return this->Offset + this->Scale*static_cast<vtkm::Float32>(level);
+  }
+
+  vtkm::Float32 Offset;
+  vtkm::Float32 Scale;
+};
+
+template<typename StoreType>
+struct QuantizeFunctor
+{
+  VTKM_EXEC_CONT
+  QuantizeFunctor(vtkm::Float32 offset = 0, vtkm::Float32 scale = 1)
+    : Offset(offset), Scale(scale) {  }
+
+  VTKM_EXEC_CONT
+  StoreType operator()(vtkm::Float32 value) const
+  {
+    const vtkm::Float32 maxLevel =
+        static_cast<vtkm::Float32>(static_cast<StoreType>(-1));
+    if (!(this->Scale > 0)) { return 0; }
+
+    vtkm::Float32 level = (value - this->Offset)/this->Scale + 0.5f;
+    if (level < 0) { level = 0; }
+    if (level > maxLevel) { level = maxLevel; }
+    return static_cast<StoreType>(level);
+  }
+
+  vtkm::Float32 Offset;
+  vtkm::Float32 Scale;
+};
+////
+//// END-EXAMPLE QuantizeFunctors.cxx
+////
+
+////
+//// BEGIN-EXAMPLE ArrayHandleQuantized.cxx
+////
+#include <vtkm/Range.h>
+
+template<typename StoreType>
+class ArrayHandleQuantized
+    : public vtkm::cont::ArrayHandleTransform<
+          vtkm::Float32,
+          vtkm::cont::ArrayHandle<StoreType>,
+          DequantizeFunctor<StoreType>,
+          QuantizeFunctor<StoreType> >
+{
+public:
+  VTKM_ARRAY_HANDLE_SUBCLASS(
+      ArrayHandleQuantized,
+      (ArrayHandleQuantized<StoreType>),
+      (vtkm::cont::ArrayHandleTransform<
+         vtkm::Float32,
+         vtkm::cont::ArrayHandle<StoreType>,
+         DequantizeFunctor<StoreType>,
+         QuantizeFunctor<StoreType> >)
+      );
+
+  VTKM_CONT
+  ArrayHandleQuantized(const vtkm::cont::ArrayHandle<StoreType> &levels,
+                       const vtkm::Range &range)
+    : Superclass(levels,
+                 DequantizeFunctor<StoreType>(GetOffset(range),
+                                              GetScale(range)),
+                 QuantizeFunctor<StoreType>(GetOffset(range),
+                                            GetScale(range)))
+  {  }
+
+  // The largest error introduced by quantizing a value in the range.
+  VTKM_CONT
+  static vtkm::Float32 GetMaxError(const vtkm::Range &range)
+  {
+    return 0.5f*GetScale(range);
+  }
+
+private:
+  VTKM_CONT
+  static vtkm::Float32 GetOffset(const vtkm::Range &range)
+  {
+    return static_cast<vtkm::Float32>(range.Min);
+  }
+
+  VTKM_CONT
+  static vtkm::Float32 GetScale(const vtkm::Range &range)
+  {
+    return static_cast<vtkm::Float32>(
+          range.Length()/static_cast<vtkm::Float64>(static_cast<StoreType>(-1)));
+  }
+};
+////
+//// END-EXAMPLE ArrayHandleQuantized.cxx
+////
+
+////
+//// BEGIN-EXAMPLE ReducePrecision.cxx
+////
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayRangeCompute.h>
+#include <vtkm/cont/DeviceAdapter.h>
+
+template<typename InArrayType, typename Device>
+VTKM_CONT
+ArrayHandleHalf ConvertToHalf(const InArrayType &input, Device)
+{
+  // Copying into the transformed array converts the values with the inverse
+  // functor as they are written.
+  ArrayHandleHalf halfArray((vtkm::cont::ArrayHandle<vtkm::UInt16>()));
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+        vtkm::cont::make_ArrayHandleCast<vtkm::Float32>(input), halfArray);
+  return halfArray;
+}
+
+template<typename StoreType, typename InArrayType, typename Device>
+VTKM_CONT
+ArrayHandleQuantized<StoreType> Quantize(const InArrayType &input, Device)
+{
+  vtkm::Range range =
+      vtkm::cont::ArrayRangeCompute(input).GetPortalConstControl().Get(0);
+
+  ArrayHandleQuantized<StoreType> quantizedArray(
+        vtkm::cont::ArrayHandle<StoreType>(), range);
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+        vtkm::cont::make_ArrayHandleCast<vtkm::Float32>(input), quantizedArray);
+  return quantizedArray;
+}
+////
+//// END-EXAMPLE ReducePrecision.cxx
+////
+
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/Field.h>
+
+#include <vtkm/filter/PointElevation.h>
+
+#include <vtkm/Math.h>
+
+#include <vtkm/cont/testing/MakeTestDataSet.h>
+#include <vtkm/cont/testing/Testing.h>
+
+namespace {
+
+typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+void CheckHalf(vtkm::Float32 value, vtkm::UInt16 expectedBits)
+{
+  vtkm::UInt16 halfBits = Float32ToHalf()(value);
+  VTKM_TEST_ASSERT(halfBits == expectedBits, "Bad half conversion.");
+}
+
+void TryHalfConversion()
+{
+  std::cout << "Trying half conversion." << std::endl;
+
+  CheckHalf(0.0f, 0x0000);
+  CheckHalf(-0.0f, 0x8000);
+  CheckHalf(1.0f, 0x3C00);
+  CheckHalf(-2.0f, 0xC000);
+  CheckHalf(65504.0f, 0x7BFF);
+  CheckHalf(70000.0f, 0x7C00);
+  CheckHalf(vtkm::Infinity32(), 0x7C00);
+  CheckHalf(5.9604644775390625e-8f, 0x0001);
+  CheckHalf(1e-9f, 0x0000);
+  VTKM_TEST_ASSERT(vtkm::IsNan(HalfToFloat32()(Float32ToHalf()(vtkm::Nan32()))),
+                   "NaN not preserved.");
+
+  // Every finite half value should survive a round trip.
+  for (vtkm::UInt32 bits = 0; bits < 0x10000u; bits++)
+  {
+    vtkm::UInt16 half = static_cast<vtkm::UInt16>(bits);
+    if ((half & 0x7C00u) == 0x7C00u) { continue; }
+    VTKM_TEST_ASSERT(Float32ToHalf()(HalfToFloat32()(half)) == half,
+                     "Half round trip failed.");
+  }
+}
+
+void TryArrayHandleHalf()
+{
+  std::cout << "Trying half array." << std::endl;
+
+  const vtkm::Id ARRAY_SIZE = 1000;
+  vtkm::cont::ArrayHandle<vtkm::Float32> colors;
+  colors.Allocate(ARRAY_SIZE);
+  for (vtkm::Id index = 0; index < ARRAY_SIZE; index++)
+  {
+    colors.GetPortalControl().Set(
+          index, vtkm::Sin(static_cast<vtkm::Float32>(index)*0.01f));
+  }
+
+  ////
+  //// BEGIN-EXAMPLE UsingArrayHandleHalf.cxx
+  ////
+  ArrayHandleHalf halfColors = ConvertToHalf(colors, Device());
+  ////
+  //// END-EXAMPLE UsingArrayHandleHalf.cxx
+  ////
+
+  VTKM_TEST_ASSERT(halfColors.GetNumberOfValues() == ARRAY_SIZE,
+                   "Half array has wrong size.");
+
+  // Read back through the execution environment.
+  vtkm::cont::ArrayHandle<vtkm::Float32> restored;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(halfColors, restored);
+  for (vtkm::Id index = 0; index < ARRAY_SIZE; index++)
+  {
+    vtkm::Float32 original = colors.GetPortalConstControl().Get(index);
+    vtkm::Float32 value = restored.GetPortalConstControl().Get(index);
+    // Half precision has 11 significant bits.
+    VTKM_TEST_ASSERT(vtkm::Abs(value - original) <=
+                       vtkm::Abs(original)*0.00049f + 6e-8f,
+                     "Half value too far off.");
+    VTKM_TEST_ASSERT(value == halfColors.GetPortalConstControl().Get(index),
+                     "Control and execution conversion differ.");
+  }
+}
+
+template<typename StoreType>
+void TryQuantizedPressure()
+{
+  std::cout << "Trying quantized pressure with "
+            << sizeof(StoreType)*8 << " bits." << std::endl;
+
+  vtkm::filter::PointElevation elevationFilter;
+  elevationFilter.SetOutputFieldName("pressure");
+  elevationFilter.SetLowPoint(0.0, 0.0, 0.0);
+  elevationFilter.SetHighPoint(0.0, 0.0, 2000.0);
+  elevationFilter.SetRange(101325.0, 77325.0);
+
+  vtkm::cont::DataSet dataSet =
+      vtkm::cont::testing::MakeTestDataSet().Make3DRegularDataSet0();
+  vtkm::filter::ResultField result =
+      elevationFilter.Execute(dataSet, dataSet.GetCoordinateSystem());
+  VTKM_TEST_ASSERT(result.IsValid(), "Elevation failed.");
+
+  vtkm::cont::ArrayHandle<vtkm::Float64> pressure;
+  result.FieldAs(pressure);
+
+  ////
+  //// BEGIN-EXAMPLE UsingArrayHandleQuantized.cxx
+  ////
+  ArrayHandleQuantized<StoreType> quantizedPressure =
+      Quantize<StoreType>(pressure, Device());
+
+  // The quantized array can be added to a data set like any other array.
+  vtkm::cont::DataSet outData = result.GetDataSet();
+  outData.AddField(vtkm::cont::Field("pressure_quantized",
+                                     vtkm::cont::Field::ASSOC_POINTS,
+                                     quantizedPressure));
+  ////
+  //// END-EXAMPLE UsingArrayHandleQuantized.cxx
+  ////
+
+  vtkm::Range range =
+      vtkm::cont::ArrayRangeCompute(pressure).GetPortalConstControl().Get(0);
+  // Allow for the precision of Float32 at the magnitude of the values.
+  vtkm::Float64 allowedError =
+      ArrayHandleQuantized<StoreType>::GetMaxError(range) +
+      vtkm::Abs(range.Max)*1e-6;
+
+  vtkm::cont::ArrayHandle<vtkm::Float32> restored;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(quantizedPressure, restored);
+  VTKM_TEST_ASSERT(restored.GetNumberOfValues() == pressure.GetNumberOfValues(),
+                   "Quantized array has wrong size.");
+  for (vtkm::Id index = 0; index < pressure.GetNumberOfValues(); index++)
+  {
+    vtkm::Float64 original = pressure.GetPortalConstControl().Get(index);
+    vtkm::Float64 value = restored.GetPortalConstControl().Get(index);
+    VTKM_TEST_ASSERT(vtkm::Abs(value - original) <= allowedError,
+                     "Quantized value too far off.");
+  }
+}
+
+void Test()
+{
+  TryHalfConversion();
+  TryArrayHandleHalf();
+  TryQuantizedPressure<vtkm::UInt8>();
+  TryQuantizedPressure<vtkm::UInt16>();
+}
+
+} // anonymous namespace
+
+int ReducedPrecisionStorage(int, char *[])
+{
+  return vtkm::cont::testing::Testing::Run(Test);
+}
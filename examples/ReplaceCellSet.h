@@ -0,0 +1,50 @@
+#ifndef vtkm_examples_ReplaceCellSet_h
+#define vtkm_examples_ReplaceCellSet_h
+
+////
+//// BEGIN-EXAMPLE ReplaceCellSet.cxx
+////
+#include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DynamicCellSet.h>
+
+namespace vtkm {
+namespace cont {
+
+// Returns a copy of the data set with the cell set at the given index
+// replaced. The other cell sets, the coordinate systems, and the fields are
+// shared with the original data set and keep their order, so the cell set
+// indices of the fields remain valid.
+VTKM_CONT
+inline vtkm::cont::DataSet
+ReplaceCellSet(const vtkm::cont::DataSet &dataSetIn,
+               vtkm::Id cellSetIndex,
+               const vtkm::cont::DynamicCellSet &cellSet)
+{
+  vtkm::cont::DataSet dataSetOut;
+  for (vtkm::Id index = 0; index < dataSetIn.GetNumberOfCellSets(); ++index)
+  {
+    dataSetOut.AddCellSet(
+          (index == cellSetIndex) ? cellSet : dataSetIn.GetCellSet(index));
+  }
+  for (vtkm::IdComponent coordIndex = 0;
+       coordIndex < dataSetIn.GetNumberOfCoordinateSystems();
+       ++coordIndex)
+  {
+    dataSetOut.AddCoordinateSystem(dataSetIn.GetCoordinateSystem(coordIndex));
+  }
+  for (vtkm::IdComponent fieldIndex = 0;
+       fieldIndex < dataSetIn.GetNumberOfFields();
+       ++fieldIndex)
+  {
+    dataSetOut.AddField(dataSetIn.GetField(fieldIndex));
+  }
+  return dataSetOut;
+}
+
+}
+} // namespace vtkm::cont
+////
+//// END-EXAMPLE ReplaceCellSet.cxx
+////
+
+#endif //vtkm_examples_ReplaceCellSet_h
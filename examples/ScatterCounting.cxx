@@ -1,4 +1,12 @@
+#include "ScatterCountingFused.h"
+
+#include <vtkm/cont/ArrayHandleConstant.h>
+#include <vtkm/cont/ArrayHandlePermutation.h>
 #include <vtkm/cont/ArrayHandleUniformPointCoordinates.h>
+#include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/Timer.h>
+
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/worklet/DispatcherMapField.h>
 #include <vtkm/worklet/ScatterCounting.h>
@@ -116,6 +124,379 @@ struct ClipPoints
 //// END-EXAMPLE ScatterCounting.cxx
 ////
 
+////
+//// BEGIN-EXAMPLE BitMask.cxx
+////
+// Number of flags packed into each word of a bit mask.
+const vtkm::Id BITS_PER_MASK_WORD = 32;
+
+VTKM_EXEC_CONT
+inline vtkm::Id CountBitsInWord(vtkm::UInt32 word)
+{
+  word = word - ((word >> 1) & 0x55555555u);
+  word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+  word = (word + (word >> 4)) & 0x0F0F0F0Fu;
+  return static_cast<vtkm::Id>((word*0x01010101u) >> 24);
+}
+
+template<typename WordPortalType, typename CountPortalType>
+struct BitMaskCountFunctor : public vtkm::exec::FunctorBase
+{
+  WordPortalType Words;
+  CountPortalType Counts;
+
+  VTKM_CONT
+  BitMaskCountFunctor(const WordPortalType &words,
+                      const CountPortalType &counts)
+    : Words(words), Counts(counts) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id wordIndex) const
+  {
+    this->Counts.Set(wordIndex, CountBitsInWord(
+                       static_cast<vtkm::UInt32>(this->Words.Get(wordIndex))));
+  }
+};
+
+template<typename WordPortalType,
+         typename OffsetPortalType,
+         typename IndexPortalType>
+struct BitMaskCompactFunctor : public vtkm::exec::FunctorBase
+{
+  WordPortalType Words;
+  OffsetPortalType Offsets;
+  IndexPortalType Indices;
+
+  VTKM_CONT
+  BitMaskCompactFunctor(const WordPortalType &words,
+                        const OffsetPortalType &offsets,
+                        const IndexPortalType &indices)
+    : Words(words), Offsets(offsets), Indices(indices) {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id wordIndex) const
+  {
+    vtkm::UInt32 word = static_cast<vtkm::UInt32>(this->Words.Get(wordIndex));
+    vtkm::Id outIndex = this->Offsets.Get(wordIndex);
+    while (word != 0)
+    {
+      // The bits below the lowest set bit give its position.
+      vtkm::UInt32 lowestBit = word & (~word + 1);
+      vtkm::Id bitIndex = CountBitsInWord(lowestBit - 1);
+      this->Indices.Set(outIndex, wordIndex*BITS_PER_MASK_WORD + bitIndex);
+      outIndex++;
+      word &= word - 1;
+    }
+  }
+};
+
+// Holds one flag per value packed 32 to a word. The words are vtkm::Int32 so
+// that they can be used as an atomic array.
+class BitMask
+{
+public:
+  typedef vtkm::cont::ArrayHandle<vtkm::Int32> WordArrayType;
+
+  VTKM_CONT
+  BitMask() : NumberOfBits(0) {  }
+
+  // Allocates the mask with all flags cleared.
+  template<typename Device>
+  VTKM_CONT
+  void Allocate(vtkm::Id numberOfBits, Device)
+  {
+    this->NumberOfBits = numberOfBits;
+    vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+          vtkm::cont::make_ArrayHandleConstant(vtkm::Int32(0),
+                                               this->GetNumberOfWords()),
+          this->Words);
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfBits() const { return this->NumberOfBits; }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfWords() const
+  {
+    return (this->NumberOfBits + BITS_PER_MASK_WORD - 1)/BITS_PER_MASK_WORD;
+  }
+
+  VTKM_CONT
+  WordArrayType &GetWords() { return this->Words; }
+  VTKM_CONT
+  const WordArrayType &GetWords() const { return this->Words; }
+
+  VTKM_CONT
+  bool GetBit(vtkm::Id index) const
+  {
+    vtkm::UInt32 word = static_cast<vtkm::UInt32>(
+          this->Words.GetPortalConstControl().Get(index/BITS_PER_MASK_WORD));
+    return ((word >> (index%BITS_PER_MASK_WORD)) & 1u) != 0;
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  vtkm::Id CountSetBits(Device) const
+  {
+    vtkm::cont::ArrayHandle<vtkm::Id> wordCounts;
+    this->CountBitsPerWord(wordCounts, Device());
+    return vtkm::cont::DeviceAdapterAlgorithm<Device>::Reduce(
+          wordCounts, vtkm::Id(0));
+  }
+
+  // Returns the indices of all set flags in increasing order.
+  template<typename Device>
+  VTKM_CONT
+  vtkm::cont::ArrayHandle<vtkm::Id> CompactIndices(Device) const
+  {
+    typedef typename WordArrayType::
+        template ExecutionTypes<Device>::PortalConst WordPortalType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::PortalConst OffsetPortalType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::Portal IndexPortalType;
+
+    vtkm::cont::ArrayHandle<vtkm::Id> wordCounts;
+    this->CountBitsPerWord(wordCounts, Device());
+
+    vtkm::cont::ArrayHandle<vtkm::Id> wordOffsets;
+    vtkm::Id numSetBits =
+        vtkm::cont::DeviceAdapterAlgorithm<Device>::ScanExclusive(
+          wordCounts, wordOffsets);
+
+    vtkm::cont::ArrayHandle<vtkm::Id> indices;
+    BitMaskCompactFunctor<WordPortalType,OffsetPortalType,IndexPortalType>
+        functor(this->Words.PrepareForInput(Device()),
+                wordOffsets.PrepareForInput(Device()),
+                indices.PrepareForOutput(numSetBits, Device()));
+    vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(
+          functor, this->GetNumberOfWords());
+
+    return indices;
+  }
+
+private:
+  template<typename Device>
+  VTKM_CONT
+  void CountBitsPerWord(vtkm::cont::ArrayHandle<vtkm::Id> &wordCounts,
+                        Device) const
+  {
+    typedef typename WordArrayType::
+        template ExecutionTypes<Device>::PortalConst WordPortalType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::Portal CountPortalType;
+
+    vtkm::Id numWords = this->GetNumberOfWords();
+    BitMaskCountFunctor<WordPortalType,CountPortalType>
+        functor(this->Words.PrepareForInput(Device()),
+                wordCounts.PrepareForOutput(numWords, Device()));
+    vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(functor, numWords);
+  }
+
+  WordArrayType Words;
+  vtkm::Id NumberOfBits;
+};
+////
+//// END-EXAMPLE BitMask.cxx
+////
+
+////
+//// BEGIN-EXAMPLE ClipPointsBitMask.cxx
+////
+struct ClipPointsBitMask
+{
+  class Mark : public vtkm::worklet::WorkletMapField
+  {
+  public:
+    typedef void ControlSignature(FieldIn<Vec3> points,
+                                  AtomicArrayInOut<> maskWords);
+    typedef void ExecutionSignature(_1, _2, WorkIndex);
+    using InputDomain = _1;
+
+    template<typename T>
+    VTKM_CONT
+    Mark(const vtkm::Vec<T,3> &boundsMin, const vtkm::Vec<T,3> &boundsMax)
+      : BoundsMin(boundsMin[0], boundsMin[1], boundsMin[2]),
+        BoundsMax(boundsMax[0], boundsMax[1], boundsMax[2])
+    {  }
+
+    template<typename T, typename AtomicArrayType>
+    VTKM_EXEC
+    void operator()(const vtkm::Vec<T,3> &point,
+                    const AtomicArrayType &maskWords,
+                    vtkm::Id pointIndex) const
+    {
+      if (!((this->BoundsMin[0] < point[0]) &&
+            (this->BoundsMin[1] < point[1]) &&
+            (this->BoundsMin[2] < point[2]) &&
+            (this->BoundsMax[0] > point[0]) &&
+            (this->BoundsMax[1] > point[1]) &&
+            (this->BoundsMax[2] > point[2])))
+      {
+        return;
+      }
+
+      // Other threads set other bits in the same word, so set the bit with an
+      // atomic compare and swap loop.
+      vtkm::Id wordIndex = pointIndex/BITS_PER_MASK_WORD;
+      vtkm::Int32 bit = static_cast<vtkm::Int32>(
+            vtkm::UInt32(1) << (pointIndex%BITS_PER_MASK_WORD));
+      vtkm::Int32 expected = 0;
+      while (true)
+      {
+        vtkm::Int32 actual =
+            maskWords.CompareAndSwap(wordIndex, expected | bit, expected);
+        if (actual == expected) { break; }
+        expected = actual;
+      }
+    }
+
+  private:
+    vtkm::Vec<vtkm::FloatDefault,3> BoundsMin;
+    vtkm::Vec<vtkm::FloatDefault,3> BoundsMax;
+  };
+
+  template<typename T, typename Storage, typename DeviceAdapterTag>
+  VTKM_CONT
+  static vtkm::cont::ArrayHandle<vtkm::Vec<T,3> >
+  Run(const vtkm::cont::ArrayHandle<vtkm::Vec<T,3>, Storage> &pointArray,
+      vtkm::Vec<T,3> boundsMin,
+      vtkm::Vec<T,3> boundsMax,
+      DeviceAdapterTag)
+  {
+    BitMask mask;
+    mask.Allocate(pointArray.GetNumberOfValues(), DeviceAdapterTag());
+
+    ClipPointsBitMask::Mark workletMark(boundsMin, boundsMax);
+    vtkm::worklet::DispatcherMapField<ClipPointsBitMask::Mark, DeviceAdapterTag>
+        dispatcherMark(workletMark);
+    dispatcherMark.Invoke(pointArray, mask.GetWords());
+
+    // Compact directly from the bit mask and gather the passed points.
+    vtkm::cont::ArrayHandle<vtkm::Id> passedIndices =
+        mask.CompactIndices(DeviceAdapterTag());
+
+    vtkm::cont::ArrayHandle<vtkm::Vec<T,3> > clippedPointsArray;
+    vtkm::cont::DeviceAdapterAlgorithm<DeviceAdapterTag>::Copy(
+          vtkm::cont::make_ArrayHandlePermutation(passedIndices, pointArray),
+          clippedPointsArray);
+
+    return clippedPointsArray;
+  }
+};
+////
+//// END-EXAMPLE ClipPointsBitMask.cxx
+////
+
+void TryBitMask()
+{
+  std::cout << "Trying bit mask." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  // Use a size that does not fill the last word.
+  const vtkm::Id NUM_BITS = 1000;
+  BitMask mask;
+  mask.Allocate(NUM_BITS, Device());
+  VTKM_TEST_ASSERT(mask.GetNumberOfWords() == 32, "Wrong number of words.");
+  VTKM_TEST_ASSERT(mask.CountSetBits(Device()) == 0, "Mask not cleared.");
+
+  // Set every third bit.
+  vtkm::cont::ArrayHandle<vtkm::Int32>::PortalControl wordPortal =
+      mask.GetWords().GetPortalControl();
+  for (vtkm::Id index = 0; index < NUM_BITS; index += 3)
+  {
+    vtkm::Id wordIndex = index/BITS_PER_MASK_WORD;
+    vtkm::UInt32 word = static_cast<vtkm::UInt32>(wordPortal.Get(wordIndex));
+    word |= vtkm::UInt32(1) << (index%BITS_PER_MASK_WORD);
+    wordPortal.Set(wordIndex, static_cast<vtkm::Int32>(word));
+  }
+
+  VTKM_TEST_ASSERT(mask.CountSetBits(Device()) == 334, "Wrong bit count.");
+  vtkm::cont::ArrayHandle<vtkm::Id> indices = mask.CompactIndices(Device());
+  VTKM_TEST_ASSERT(indices.GetNumberOfValues() == 334,
+                   "Wrong number of compacted indices.");
+  for (vtkm::Id index = 0; index < 334; index++)
+  {
+    VTKM_TEST_ASSERT(indices.GetPortalConstControl().Get(index) == 3*index,
+                     "Wrong compacted index.");
+    VTKM_TEST_ASSERT(mask.GetBit(3*index), "Bit not set.");
+  }
+  VTKM_TEST_ASSERT(!mask.GetBit(1), "Bit wrongly set.");
+}
+
+void TryScatterCountingFused()
+{
+  std::cout << "Trying fused scatter counting." << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  // Counts cycle through 0 to 3 so that some inputs are skipped and others
+  // are visited several times.
+  const vtkm::Id NUM_INPUTS = 100000;
+  vtkm::cont::ArrayHandle<vtkm::IdComponent> countArray;
+  countArray.Allocate(NUM_INPUTS);
+  for (vtkm::Id index = 0; index < NUM_INPUTS; index++)
+  {
+    countArray.GetPortalControl().Set(
+          index, static_cast<vtkm::IdComponent>((index*7)%4));
+  }
+
+  // Build each scatter once before timing so that neither measurement
+  // includes moving the counts to the device or starting up the device.
+  {
+    vtkm::worklet::ScatterCounting warmUp(countArray, Device());
+    vtkm::worklet::ScatterCountingFused fusedWarmUp(countArray, Device());
+  }
+
+  vtkm::cont::Timer<Device> timer;
+  vtkm::worklet::ScatterCounting scatter(countArray, Device());
+  vtkm::Float64 scatterTime = timer.GetElapsedTime();
+
+  timer.Reset();
+  vtkm::worklet::ScatterCountingFused fusedScatter(countArray, Device());
+  vtkm::Float64 fusedTime = timer.GetElapsedTime();
+
+  std::cout << "  ScatterCounting construction: " << scatterTime << " s"
+            << std::endl;
+  std::cout << "  ScatterCountingFused construction: " << fusedTime << " s"
+            << std::endl;
+
+  vtkm::cont::ArrayHandle<vtkm::Id> outputToInputMap =
+      scatter.GetOutputToInputMap(NUM_INPUTS);
+  vtkm::cont::ArrayHandle<vtkm::IdComponent> visitArray =
+      scatter.GetVisitArray(NUM_INPUTS);
+  vtkm::cont::ArrayHandle<vtkm::Id> fusedOutputToInputMap =
+      fusedScatter.GetOutputToInputMap(NUM_INPUTS);
+  vtkm::cont::ArrayHandle<vtkm::IdComponent> fusedVisitArray =
+      fusedScatter.GetVisitArray(NUM_INPUTS);
+
+  vtkm::Id numOutputs = scatter.GetOutputRange(NUM_INPUTS);
+  VTKM_TEST_ASSERT(fusedScatter.GetOutputRange(NUM_INPUTS) == numOutputs,
+                   "Wrong number of outputs.");
+  VTKM_TEST_ASSERT(fusedOutputToInputMap.GetNumberOfValues() == numOutputs,
+                   "Wrong output to input map size.");
+  VTKM_TEST_ASSERT(fusedVisitArray.GetNumberOfValues() == numOutputs,
+                   "Wrong visit array size.");
+  for (vtkm::Id index = 0; index < numOutputs; index++)
+  {
+    VTKM_TEST_ASSERT(
+          fusedOutputToInputMap.GetPortalConstControl().Get(index) ==
+          outputToInputMap.GetPortalConstControl().Get(index),
+          "Bad output to input map.");
+    VTKM_TEST_ASSERT(
+          fusedVisitArray.GetPortalConstControl().Get(index) ==
+          visitArray.GetPortalConstControl().Get(index),
+          "Bad visit array.");
+  }
+
+  // Copies share the arrays.
+  vtkm::worklet::ScatterCountingFused scatterCopy = fusedScatter;
+  VTKM_TEST_ASSERT(scatterCopy.GetOutputToInputMap(NUM_INPUTS) ==
+                   fusedScatter.GetOutputToInputMap(NUM_INPUTS),
+                   "Scatter copy does not share arrays.");
+}
+
 void Run()
 {
   std::cout << "Trying clip points." << std::endl;
@@ -136,6 +517,26 @@ void Run()
   std::cout << std::endl;
   VTKM_TEST_ASSERT(clippedPoints.GetNumberOfValues() == 512,
                    "Unexpected number of output points.");
+
+  TryScatterCountingFused();
+
+  TryBitMask();
+
+  std::cout << "Trying clip points with bit mask." << std::endl;
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::FloatDefault,3> > maskClippedPoints =
+      ClipPointsBitMask::Run(points,
+                             boundsMin,
+                             boundsMax,
+                             VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+  VTKM_TEST_ASSERT(maskClippedPoints.GetNumberOfValues() == 512,
+                   "Unexpected number of output points.");
+  for (vtkm::Id index = 0; index < 512; index++)
+  {
+    VTKM_TEST_ASSERT(
+          test_equal(maskClippedPoints.GetPortalConstControl().Get(index),
+                     clippedPoints.GetPortalConstControl().Get(index)),
+          "Bit mask clip gave different point.");
+  }
 }
 
 } // anonymous namespace
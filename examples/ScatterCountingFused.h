@@ -0,0 +1,148 @@
+#ifndef vtkm_examples_ScatterCountingFused_h
+#define vtkm_examples_ScatterCountingFused_h
+
+////
+//// BEGIN-EXAMPLE ScatterCountingFused.cxx
+////
+#include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/DeviceAdapter.h>
+
+#include <vtkm/exec/FunctorBase.h>
+
+namespace vtkm {
+namespace worklet {
+
+namespace detail {
+
+// Writes all the output entries for one input in one go. The offset of the
+// first output comes from an exclusive scan of the counts, so each input owns
+// a contiguous block of the output and no search is necessary.
+template<typename CountPortalType,
+         typename OffsetPortalType,
+         typename OutputToInputPortalType,
+         typename VisitPortalType>
+struct ScatterCountingFusedFunctor : public vtkm::exec::FunctorBase
+{
+  CountPortalType Counts;
+  OffsetPortalType Offsets;
+  OutputToInputPortalType OutputToInputMap;
+  VisitPortalType Visits;
+
+  VTKM_CONT
+  ScatterCountingFusedFunctor(const CountPortalType &counts,
+                              const OffsetPortalType &offsets,
+                              const OutputToInputPortalType &outputToInputMap,
+                              const VisitPortalType &visits)
+    : Counts(counts),
+      Offsets(offsets),
+      OutputToInputMap(outputToInputMap),
+      Visits(visits)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id inputIndex) const
+  {
+    vtkm::Id outputIndex = this->Offsets.Get(inputIndex);
+    vtkm::IdComponent count =
+        static_cast<vtkm::IdComponent>(this->Counts.Get(inputIndex));
+    for (vtkm::IdComponent visitIndex = 0; visitIndex < count; ++visitIndex)
+    {
+      this->OutputToInputMap.Set(outputIndex, inputIndex);
+      this->Visits.Set(outputIndex, visitIndex);
+      ++outputIndex;
+    }
+  }
+};
+
+} // namespace detail
+
+// A drop-in replacement for ScatterCounting. The output to input map and the
+// visit array are built together with one scan and one pass over the input.
+// Copies of the scatter share the same arrays, so a scatter can be built once
+// and handed to any number of worklets and dispatchers.
+class ScatterCountingFused
+{
+public:
+  using OutputToInputMapType = vtkm::cont::ArrayHandle<vtkm::Id>;
+  using VisitArrayType = vtkm::cont::ArrayHandle<vtkm::IdComponent>;
+
+  VTKM_CONT
+  ScatterCountingFused() : NumberOfOutputs(0) {  }
+
+  template<typename CountArrayType, typename Device>
+  VTKM_CONT
+  ScatterCountingFused(const CountArrayType &countArray, Device)
+  {
+    VTKM_IS_ARRAY_HANDLE(CountArrayType);
+    VTKM_IS_DEVICE_ADAPTER_TAG(Device);
+
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    vtkm::Id numInputs = countArray.GetNumberOfValues();
+
+    vtkm::cont::ArrayHandle<vtkm::Id> offsets;
+    this->NumberOfOutputs =
+        Algorithm::ScanExclusive(
+          vtkm::cont::make_ArrayHandleCast<vtkm::Id>(countArray), offsets);
+
+    using CountPortalType =
+        typename CountArrayType::template ExecutionTypes<Device>::PortalConst;
+    using OffsetPortalType =
+        typename vtkm::cont::ArrayHandle<vtkm::Id>::
+          template ExecutionTypes<Device>::PortalConst;
+    using OutputToInputPortalType =
+        typename OutputToInputMapType::template ExecutionTypes<Device>::Portal;
+    using VisitPortalType =
+        typename VisitArrayType::template ExecutionTypes<Device>::Portal;
+
+    detail::ScatterCountingFusedFunctor<CountPortalType,
+                                        OffsetPortalType,
+                                        OutputToInputPortalType,
+                                        VisitPortalType>
+        functor(countArray.PrepareForInput(Device()),
+                offsets.PrepareForInput(Device()),
+                this->OutputToInputMap.PrepareForOutput(this->NumberOfOutputs,
+                                                        Device()),
+                this->VisitArray.PrepareForOutput(this->NumberOfOutputs,
+                                                  Device()));
+    Algorithm::Schedule(functor, numInputs);
+  }
+
+  template<typename RangeType>
+  VTKM_CONT
+  vtkm::Id GetOutputRange(RangeType) const
+  {
+    return this->NumberOfOutputs;
+  }
+
+  template<typename RangeType>
+  VTKM_CONT
+  OutputToInputMapType GetOutputToInputMap(RangeType) const
+  {
+    return this->OutputToInputMap;
+  }
+
+  template<typename RangeType>
+  VTKM_CONT
+  VisitArrayType GetVisitArray(RangeType) const
+  {
+    return this->VisitArray;
+  }
+
+  VTKM_CONT
+  vtkm::Id GetNumberOfOutputs() const { return this->NumberOfOutputs; }
+
+private:
+  vtkm::Id NumberOfOutputs;
+  OutputToInputMapType OutputToInputMap;
+  VisitArrayType VisitArray;
+};
+
+}
+} // namespace vtkm::worklet
+////
+//// END-EXAMPLE ScatterCountingFused.cxx
+////
+
+#endif //vtkm_examples_ScatterCountingFused_h
@@ -1,16 +1,28 @@
 #include <vtkm/Math.h>
 #include <vtkm/Range.h>
+#include <vtkm/VecTraits.h>
 
 #include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/ArrayHandleCompositeVector.h>
 #include <vtkm/cont/ArrayHandleConstant.h>
 #include <vtkm/cont/ArrayRangeCompute.h>
 #include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/Timer.h>
+
+#include <vtkm/cont/cuda/internal/DeviceAdapterTagCuda.h>
+#include <vtkm/cont/serial/internal/DeviceAdapterTagSerial.h>
+
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/worklet/DispatcherMapField.h>
 #include <vtkm/worklet/WorkletMapField.h>
 
 #include <vtkm/cont/testing/Testing.h>
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 struct SimpleHistogram
 {
   ////
@@ -75,6 +87,794 @@ struct SimpleHistogram
   }
 };
 
+////
+//// BEGIN-EXAMPLE StripedHistogram.cxx
+////
+// The number of threads a device runs at once, which sets how many private
+// copies of the bins are worth making.
+template<typename Device>
+struct HistogramParallelism
+{
+  VTKM_CONT
+  static vtkm::Id Get()
+  {
+    return std::max(
+          static_cast<vtkm::Id>(std::thread::hardware_concurrency()),
+          vtkm::Id(1));
+  }
+};
+
+template<>
+struct HistogramParallelism<vtkm::cont::DeviceAdapterTagSerial>
+{
+  VTKM_CONT
+  static vtkm::Id Get() { return 1; }
+};
+
+template<>
+struct HistogramParallelism<vtkm::cont::DeviceAdapterTagCuda>
+{
+  // Enough threads to fill a large GPU.
+  VTKM_CONT
+  static vtkm::Id Get() { return 16384; }
+};
+
+struct StripedHistogram
+{
+  // Private bin rows are padded to a whole number of 64-byte cache lines so
+  // that threads counting different stripes never write to the same line.
+  static const vtkm::Id BINS_PER_CACHE_LINE = 64/sizeof(vtkm::Int32);
+
+  template<typename InputPortalType, typename BinPortalType>
+  struct CountStripe : public vtkm::exec::FunctorBase
+  {
+    InputPortalType Input;
+    BinPortalType Bins;
+    vtkm::Range HistogramRange;
+    vtkm::Id NumberOfBins;
+    vtkm::Id StripeSize;
+    vtkm::Id BinStride;
+
+    VTKM_CONT
+    CountStripe(const InputPortalType &input,
+                const BinPortalType &bins,
+                const vtkm::Range &histogramRange,
+                vtkm::Id numBins,
+                vtkm::Id stripeSize,
+                vtkm::Id binStride)
+      : Input(input),
+        Bins(bins),
+        HistogramRange(histogramRange),
+        NumberOfBins(numBins),
+        StripeSize(stripeSize),
+        BinStride(binStride)
+    {  }
+
+    VTKM_EXEC
+    void operator()(vtkm::Id stripe) const
+    {
+      // Each stripe owns one row of bins, so no atomics are needed. The row
+      // is cleared here rather than in a separate fill pass.
+      vtkm::Id binOffset = stripe*this->BinStride;
+      for (vtkm::Id bin = 0; bin < this->NumberOfBins; ++bin)
+      {
+        this->Bins.Set(binOffset + bin, 0);
+      }
+
+      vtkm::Id begin = stripe*this->StripeSize;
+      vtkm::Id end = vtkm::Min(begin + this->StripeSize,
+                               this->Input.GetNumberOfValues());
+      for (vtkm::Id index = begin; index < end; ++index)
+      {
+        vtkm::Float64 interp =
+            (this->Input.Get(index) - this->HistogramRange.Min)/
+            this->HistogramRange.Length();
+        vtkm::Id bin = static_cast<vtkm::Id>(interp*this->NumberOfBins);
+        if (bin < 0) { bin = 0; }
+        if (bin >= this->NumberOfBins) { bin = this->NumberOfBins - 1; }
+
+        this->Bins.Set(binOffset + bin, this->Bins.Get(binOffset + bin) + 1);
+      }
+    }
+  };
+
+  template<typename BinPortalType, typename HistogramPortalType>
+  struct MergeStripes : public vtkm::exec::FunctorBase
+  {
+    BinPortalType Bins;
+    HistogramPortalType Histogram;
+    vtkm::Id NumberOfStripes;
+    vtkm::Id BinStride;
+
+    VTKM_CONT
+    MergeStripes(const BinPortalType &bins,
+                 const HistogramPortalType &histogram,
+                 vtkm::Id numStripes,
+                 vtkm::Id binStride)
+      : Bins(bins),
+        Histogram(histogram),
+        NumberOfStripes(numStripes),
+        BinStride(binStride)
+    {  }
+
+    VTKM_EXEC
+    void operator()(vtkm::Id bin) const
+    {
+      vtkm::Int32 total = 0;
+      for (vtkm::Id stripe = 0; stripe < this->NumberOfStripes; ++stripe)
+      {
+        total += this->Bins.Get(stripe*this->BinStride + bin);
+      }
+      this->Histogram.Set(bin, total);
+    }
+  };
+
+  // Returns the number of private copies of the bins to count into, or 0 if
+  // a single shared atomic histogram should be used instead. numThreads is
+  // the number of threads the device runs at once.
+  VTKM_CONT
+  static vtkm::Id NumberOfStripes(vtkm::Id numValues,
+                                  vtkm::Id numBins,
+                                  vtkm::Id numThreads)
+  {
+    // A single thread has no atomic collisions to avoid.
+    if (numThreads < 2)
+    {
+      return 0;
+    }
+
+    // Give each thread a few stripes so that the load stays balanced.
+    vtkm::Id numStripes = std::min(4*numThreads, numValues);
+
+    // Merging costs one read per private bin. When that is more than the
+    // number of values, there are so many bins for so few threads that
+    // atomic collisions are rare, and the shared histogram is faster.
+    if ((numStripes < 2) || (numStripes*numBins > numValues))
+    {
+      return 0;
+    }
+    return numStripes;
+  }
+
+  template<typename InputArray, typename Device>
+  VTKM_CONT
+  static vtkm::cont::ArrayHandle<vtkm::Int32>
+  Run(const InputArray &input, vtkm::Id numberOfBins, Device)
+  {
+    VTKM_IS_ARRAY_HANDLE(InputArray);
+
+    vtkm::Id numValues = input.GetNumberOfValues();
+    vtkm::Id numStripes =
+        NumberOfStripes(numValues,
+                        numberOfBins,
+                        HistogramParallelism<Device>::Get());
+    if (numStripes < 1)
+    {
+      return SimpleHistogram::Run(input, numberOfBins, Device());
+    }
+
+    vtkm::Range range =
+        vtkm::cont::ArrayRangeCompute(input).GetPortalConstControl().Get(0);
+
+    vtkm::Id stripeSize = (numValues + numStripes - 1)/numStripes;
+    vtkm::Id binStride =
+        ((numberOfBins + BINS_PER_CACHE_LINE - 1)/BINS_PER_CACHE_LINE)*
+        BINS_PER_CACHE_LINE;
+
+    using InputPortalType =
+        typename InputArray::template ExecutionTypes<Device>::PortalConst;
+    using BinArrayType = vtkm::cont::ArrayHandle<vtkm::Int32>;
+    using BinPortalType =
+        typename BinArrayType::template ExecutionTypes<Device>::Portal;
+    using BinPortalConstType =
+        typename BinArrayType::template ExecutionTypes<Device>::PortalConst;
+
+    BinArrayType stripeBins;
+    CountStripe<InputPortalType, BinPortalType> countFunctor(
+          input.PrepareForInput(Device()),
+          stripeBins.PrepareForOutput(numStripes*binStride, Device()),
+          range,
+          numberOfBins,
+          stripeSize,
+          binStride);
+    vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(countFunctor,
+                                                         numStripes);
+
+    BinArrayType histogram;
+    MergeStripes<BinPortalConstType, BinPortalType> mergeFunctor(
+          stripeBins.PrepareForInput(Device()),
+          histogram.PrepareForOutput(numberOfBins, Device()),
+          numStripes,
+          binStride);
+    vtkm::cont::DeviceAdapterAlgorithm<Device>::Schedule(mergeFunctor,
+                                                         numberOfBins);
+
+    return histogram;
+  }
+};
+////
+//// END-EXAMPLE StripedHistogram.cxx
+////
+
+////
+//// BEGIN-EXAMPLE FusedHistogramPasses.cxx
+////
+enum HistogramBinning
+{
+  HISTOGRAM_BINNING_FIXED,    // Bins of equal width between min and max
+  HISTOGRAM_BINNING_LOG,      // Bins of equal width in log10 of the values
+  HISTOGRAM_BINNING_QUANTILE  // Bins holding (about) equal numbers of values
+};
+
+// Pass 1: each stripe finds, for every component, the minimum, the maximum,
+// and the smallest positive value (needed for log bins).
+template<typename InputPortalType, typename RangePortalType>
+struct StripeRanges : public vtkm::exec::FunctorBase
+{
+  using ValueType = typename InputPortalType::ValueType;
+  using VecTraits = vtkm::VecTraits<ValueType>;
+  static const vtkm::IdComponent NUM_COMPONENTS = VecTraits::NUM_COMPONENTS;
+
+  InputPortalType Input;
+  RangePortalType Ranges;
+  vtkm::Id StripeSize;
+
+  VTKM_CONT
+  StripeRanges(const InputPortalType &input,
+               const RangePortalType &ranges,
+               vtkm::Id stripeSize)
+    : Input(input), Ranges(ranges), StripeSize(stripeSize)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id stripe) const
+  {
+    vtkm::Vec<vtkm::Vec<vtkm::Float64,3>,NUM_COMPONENTS> ranges(
+          vtkm::make_Vec(vtkm::Infinity64(),
+                         vtkm::NegativeInfinity64(),
+                         vtkm::Infinity64()));
+
+    vtkm::Id begin = stripe*this->StripeSize;
+    vtkm::Id end = vtkm::Min(begin + this->StripeSize,
+                             this->Input.GetNumberOfValues());
+    for (vtkm::Id index = begin; index < end; ++index)
+    {
+      ValueType value = this->Input.Get(index);
+      for (vtkm::IdComponent c = 0; c < NUM_COMPONENTS; ++c)
+      {
+        vtkm::Float64 v =
+            static_cast<vtkm::Float64>(VecTraits::GetComponent(value, c));
+        ranges[c][0] = vtkm::Min(ranges[c][0], v);
+        ranges[c][1] = vtkm::Max(ranges[c][1], v);
+        if (v > 0) { ranges[c][2] = vtkm::Min(ranges[c][2], v); }
+      }
+    }
+
+    for (vtkm::IdComponent c = 0; c < NUM_COMPONENTS; ++c)
+    {
+      this->Ranges.Set(stripe*NUM_COMPONENTS + c, ranges[c]);
+    }
+  }
+};
+
+// Pass 2: each stripe counts every component into its own private bins.
+template<typename InputPortalType, typename BinPortalType>
+struct StripeCounts : public vtkm::exec::FunctorBase
+{
+  using ValueType = typename InputPortalType::ValueType;
+  using VecTraits = vtkm::VecTraits<ValueType>;
+  static const vtkm::IdComponent NUM_COMPONENTS = VecTraits::NUM_COMPONENTS;
+
+  InputPortalType Input;
+  BinPortalType Bins;
+  vtkm::Vec<vtkm::Range,NUM_COMPONENTS> BinRanges;
+  bool UseLog;
+  vtkm::Id NumberOfBins;
+  vtkm::Id StripeSize;
+  vtkm::Id BinStride;
+
+  VTKM_CONT
+  StripeCounts(const InputPortalType &input,
+               const BinPortalType &bins,
+               const vtkm::Vec<vtkm::Range,NUM_COMPONENTS> &binRanges,
+               bool useLog,
+               vtkm::Id numBins,
+               vtkm::Id stripeSize,
+               vtkm::Id binStride)
+    : Input(input),
+      Bins(bins),
+      BinRanges(binRanges),
+      UseLog(useLog),
+      NumberOfBins(numBins),
+      StripeSize(stripeSize),
+      BinStride(binStride)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id stripe) const
+  {
+    vtkm::Id stripeOffset = stripe*NUM_COMPONENTS*this->BinStride;
+    for (vtkm::Id bin = 0; bin < NUM_COMPONENTS*this->BinStride; ++bin)
+    {
+      this->Bins.Set(stripeOffset + bin, 0);
+    }
+
+    vtkm::Id begin = stripe*this->StripeSize;
+    vtkm::Id end = vtkm::Min(begin + this->StripeSize,
+                             this->Input.GetNumberOfValues());
+    for (vtkm::Id index = begin; index < end; ++index)
+    {
+      ValueType value = this->Input.Get(index);
+      for (vtkm::IdComponent c = 0; c < NUM_COMPONENTS; ++c)
+      {
+        vtkm::Float64 v =
+            static_cast<vtkm::Float64>(VecTraits::GetComponent(value, c));
+        if (this->UseLog)
+        {
+          // Log10 of a non-positive value is -inf or NaN, both of which end
+          // up in the first bin.
+          v = vtkm::Log10(v);
+        }
+        const vtkm::Range &range = this->BinRanges[c];
+        vtkm::Float64 interp = (range.Length() > 0)
+            ? ((v - range.Min)/range.Length())*this->NumberOfBins
+            : 0;
+        vtkm::Id bin;
+        if (!(interp > 0)) { bin = 0; }
+        else if (interp >= this->NumberOfBins) { bin = this->NumberOfBins-1; }
+        else { bin = static_cast<vtkm::Id>(interp); }
+
+        vtkm::Id binIndex = stripeOffset + c*this->BinStride + bin;
+        this->Bins.Set(binIndex, this->Bins.Get(binIndex) + 1);
+      }
+    }
+  }
+};
+
+// Adds up the private bins of all stripes.
+template<typename BinPortalType, typename HistogramPortalType>
+struct MergeStripeCounts : public vtkm::exec::FunctorBase
+{
+  BinPortalType Bins;
+  HistogramPortalType Histogram;
+  vtkm::Id NumberOfStripes;
+  vtkm::Id NumberOfBins;
+  vtkm::Id BinStride;
+  vtkm::IdComponent NumberOfComponents;
+
+  VTKM_CONT
+  MergeStripeCounts(const BinPortalType &bins,
+                    const HistogramPortalType &histogram,
+                    vtkm::Id numStripes,
+                    vtkm::Id numBins,
+                    vtkm::Id binStride,
+                    vtkm::IdComponent numComponents)
+    : Bins(bins),
+      Histogram(histogram),
+      NumberOfStripes(numStripes),
+      NumberOfBins(numBins),
+      BinStride(binStride),
+      NumberOfComponents(numComponents)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id index) const
+  {
+    vtkm::Id component = index/this->NumberOfBins;
+    vtkm::Id bin = index%this->NumberOfBins;
+    vtkm::Id total = 0;
+    for (vtkm::Id stripe = 0; stripe < this->NumberOfStripes; ++stripe)
+    {
+      total += this->Bins.Get(
+            (stripe*this->NumberOfComponents + component)*this->BinStride + bin);
+    }
+    this->Histogram.Set(index, total);
+  }
+};
+////
+//// END-EXAMPLE FusedHistogramPasses.cxx
+////
+
+////
+//// BEGIN-EXAMPLE FusedHistogram.cxx
+////
+struct FieldHistogram
+{
+  vtkm::Range Range;
+
+  // NumberOfBins+1 values. Bin i holds values in [BinEdges[i],BinEdges[i+1]).
+  std::vector<vtkm::Float64> BinEdges;
+
+  std::vector<vtkm::Id> Counts;
+};
+
+// Computes histograms for every component of the input in two passes over
+// the data: one to find the ranges and one to count. To histogram several
+// scalar fields in the same passes, combine them with an
+// ArrayHandleCompositeVector.
+class FusedHistogram
+{
+public:
+  // Quantile bins are found by first counting this many fine fixed bins for
+  // each requested bin and then grouping the fine bins.
+  static const vtkm::Id QUANTILE_REFINEMENT = 256;
+
+  // numberOfThreads overrides the parallelism of the device used to choose
+  // the number of stripes. Leave it 0 to use HistogramParallelism.
+  VTKM_CONT
+  FusedHistogram(vtkm::Id numberOfBins,
+                 HistogramBinning binning = HISTOGRAM_BINNING_FIXED,
+                 vtkm::Id numberOfThreads = 0)
+    : NumberOfBins(numberOfBins),
+      Binning(binning),
+      NumberOfThreads(numberOfThreads)
+  {  }
+
+  template<typename InputArray, typename Device>
+  VTKM_CONT
+  std::vector<FieldHistogram> Run(const InputArray &input, Device) const
+  {
+    VTKM_IS_ARRAY_HANDLE(InputArray);
+
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+    using InputPortalType =
+        typename InputArray::template ExecutionTypes<Device>::PortalConst;
+    using RangeFunctor = StripeRanges<
+        InputPortalType,
+        typename vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float64,3> >::
+          template ExecutionTypes<Device>::Portal>;
+    static const vtkm::IdComponent NUM_COMPONENTS =
+        RangeFunctor::NUM_COMPONENTS;
+
+    vtkm::Id numValues = input.GetNumberOfValues();
+    vtkm::Id numCountBins = (this->Binning == HISTOGRAM_BINNING_QUANTILE)
+        ? this->NumberOfBins*QUANTILE_REFINEMENT
+        : this->NumberOfBins;
+
+    // Give each thread a few stripes, but do not make so many stripes that
+    // merging the private bins costs more than counting.
+    vtkm::Id numThreads = (this->NumberOfThreads > 0)
+        ? this->NumberOfThreads
+        : HistogramParallelism<Device>::Get();
+    vtkm::Id numStripes = std::max(
+          vtkm::Id(1),
+          std::min(4*numThreads, numValues/(numCountBins*NUM_COMPONENTS)));
+    vtkm::Id stripeSize =
+        std::max((numValues + numStripes - 1)/numStripes, vtkm::Id(1));
+    // Rounding the stripe size up can leave stripes at the end with nothing
+    // to count, so drop them.
+    numStripes = (numValues + stripeSize - 1)/stripeSize;
+
+    // Pass 1: ranges.
+    vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float64,3> > stripeRanges;
+    RangeFunctor rangeFunctor(
+          input.PrepareForInput(Device()),
+          stripeRanges.PrepareForOutput(numStripes*NUM_COMPONENTS, Device()),
+          stripeSize);
+    Algorithm::Schedule(rangeFunctor, numStripes);
+
+    std::vector<FieldHistogram> histograms(NUM_COMPONENTS);
+    vtkm::Vec<vtkm::Range,NUM_COMPONENTS> binRanges;
+    for (vtkm::IdComponent c = 0; c < NUM_COMPONENTS; ++c)
+    {
+      vtkm::Float64 minPositive = vtkm::Infinity64();
+      for (vtkm::Id stripe = 0; stripe < numStripes; ++stripe)
+      {
+        vtkm::Vec<vtkm::Float64,3> stripeRange =
+            stripeRanges.GetPortalConstControl().Get(stripe*NUM_COMPONENTS+c);
+        if (stripeRange[0] > stripeRange[1])
+        {
+          // An empty stripe reports an inverted range.
+          continue;
+        }
+        histograms[c].Range.Include(stripeRange[0]);
+        histograms[c].Range.Include(stripeRange[1]);
+        minPositive = vtkm::Min(minPositive, stripeRange[2]);
+      }
+
+      if (this->Binning == HISTOGRAM_BINNING_LOG)
+      {
+        // If there are no positive values, everything goes in the first bin.
+        binRanges[c] = (minPositive <= histograms[c].Range.Max)
+            ? vtkm::Range(vtkm::Log10(minPositive),
+                          vtkm::Log10(histograms[c].Range.Max))
+            : vtkm::Range(0, 0);
+      }
+      else
+      {
+        binRanges[c] = histograms[c].Range;
+      }
+    }
+
+    // Pass 2: counts.
+    vtkm::Id binStride =
+        ((numCountBins + BINS_PER_CACHE_LINE - 1)/BINS_PER_CACHE_LINE)*
+        BINS_PER_CACHE_LINE;
+    using BinArrayType = vtkm::cont::ArrayHandle<vtkm::Id>;
+    using BinPortalType =
+        typename BinArrayType::template ExecutionTypes<Device>::Portal;
+    using BinPortalConstType =
+        typename BinArrayType::template ExecutionTypes<Device>::PortalConst;
+
+    BinArrayType stripeBins;
+    StripeCounts<InputPortalType, BinPortalType> countFunctor(
+          input.PrepareForInput(Device()),
+          stripeBins.PrepareForOutput(numStripes*NUM_COMPONENTS*binStride,
+                                      Device()),
+          binRanges,
+          this->Binning == HISTOGRAM_BINNING_LOG,
+          numCountBins,
+          stripeSize,
+          binStride);
+    Algorithm::Schedule(countFunctor, numStripes);
+
+    BinArrayType counts;
+    MergeStripeCounts<BinPortalConstType, BinPortalType> mergeFunctor(
+          stripeBins.PrepareForInput(Device()),
+          counts.PrepareForOutput(NUM_COMPONENTS*numCountBins, Device()),
+          numStripes,
+          numCountBins,
+          binStride,
+          NUM_COMPONENTS);
+    Algorithm::Schedule(mergeFunctor, NUM_COMPONENTS*numCountBins);
+
+    typename BinArrayType::PortalConstControl countPortal =
+        counts.GetPortalConstControl();
+    for (vtkm::IdComponent c = 0; c < NUM_COMPONENTS; ++c)
+    {
+      this->FinishHistogram(countPortal,
+                            c*numCountBins,
+                            numCountBins,
+                            numValues,
+                            binRanges[c],
+                            histograms[c]);
+    }
+
+    return histograms;
+  }
+
+private:
+  static const vtkm::Id BINS_PER_CACHE_LINE = 64/sizeof(vtkm::Id);
+
+  vtkm::Id NumberOfBins;
+  HistogramBinning Binning;
+  vtkm::Id NumberOfThreads;
+
+  template<typename CountPortalType>
+  VTKM_CONT
+  void FinishHistogram(const CountPortalType &countPortal,
+                       vtkm::Id countOffset,
+                       vtkm::Id numCountBins,
+                       vtkm::Id numValues,
+                       const vtkm::Range &binRange,
+                       FieldHistogram &histogram) const
+  {
+    histogram.BinEdges.resize(static_cast<std::size_t>(this->NumberOfBins+1));
+    histogram.Counts.resize(static_cast<std::size_t>(this->NumberOfBins));
+
+    vtkm::Float64 countBinWidth = binRange.Length()/numCountBins;
+
+    if (this->Binning != HISTOGRAM_BINNING_QUANTILE)
+    {
+      for (vtkm::Id bin = 0; bin < this->NumberOfBins; ++bin)
+      {
+        histogram.Counts[static_cast<std::size_t>(bin)] =
+            countPortal.Get(countOffset + bin);
+      }
+      for (vtkm::Id edge = 0; edge <= this->NumberOfBins; ++edge)
+      {
+        vtkm::Float64 edgeValue = binRange.Min + edge*countBinWidth;
+        histogram.BinEdges[static_cast<std::size_t>(edge)] =
+            (this->Binning == HISTOGRAM_BINNING_LOG)
+            ? vtkm::Pow(10.0, edgeValue)
+            : edgeValue;
+      }
+      return;
+    }
+
+    // Group the fine bins so that each output bin closes once the running
+    // total passes the next quantile.
+    histogram.BinEdges[0] = binRange.Min;
+    vtkm::Id cumulative = 0;
+    vtkm::Id fineBin = 0;
+    for (vtkm::Id bin = 0; bin < this->NumberOfBins; ++bin)
+    {
+      vtkm::Id target = (numValues*(bin+1))/this->NumberOfBins;
+      vtkm::Id binCount = 0;
+      while ((fineBin < numCountBins) &&
+             ((cumulative < target) || (bin == this->NumberOfBins-1)))
+      {
+        vtkm::Id fineCount = countPortal.Get(countOffset + fineBin);
+        binCount += fineCount;
+        cumulative += fineCount;
+        ++fineBin;
+      }
+      histogram.Counts[static_cast<std::size_t>(bin)] = binCount;
+      histogram.BinEdges[static_cast<std::size_t>(bin+1)] =
+          binRange.Min + fineBin*countBinWidth;
+    }
+  }
+};
+////
+//// END-EXAMPLE FusedHistogram.cxx
+////
+
+VTKM_CONT
+static inline void TryFusedHistogram()
+{
+  std::cout << "Try fused histogram of several fields" << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  static const vtkm::Id ARRAY_SIZE = 1000000;
+  static const vtkm::Id NUM_BINS = 10;
+  vtkm::cont::ArrayHandle<vtkm::Float32> field1;
+  vtkm::cont::ArrayHandle<vtkm::Float32> field2;
+  vtkm::cont::ArrayHandle<vtkm::Float32> field3;
+  field1.Allocate(ARRAY_SIZE);
+  field2.Allocate(ARRAY_SIZE);
+  field3.Allocate(ARRAY_SIZE);
+  for (vtkm::Id index = 0; index < ARRAY_SIZE; ++index)
+  {
+    vtkm::Float32 t = static_cast<vtkm::Float32>(index)/ARRAY_SIZE;
+    field1.GetPortalControl().Set(index, t);
+    field2.GetPortalControl().Set(index, t*t);
+    field3.GetPortalControl().Set(index, vtkm::Pow(10.0f, 3*t));
+  }
+
+  vtkm::cont::Timer<Device> timer;
+  vtkm::cont::ArrayHandle<vtkm::Int32> separateHistograms[3] = {
+    SimpleHistogram::Run(field1, NUM_BINS, Device()),
+    SimpleHistogram::Run(field2, NUM_BINS, Device()),
+    SimpleHistogram::Run(field3, NUM_BINS, Device())
+  };
+  vtkm::Float64 separateTime = timer.GetElapsedTime();
+
+  timer.Reset();
+  std::vector<FieldHistogram> fusedHistograms =
+      FusedHistogram(NUM_BINS).Run(
+        vtkm::cont::make_ArrayHandleCompositeVector(field1, 0,
+                                                    field2, 0,
+                                                    field3, 0),
+        Device());
+  vtkm::Float64 fusedTime = timer.GetElapsedTime();
+
+  std::cout << "  Three passes per field: " << separateTime << " s"
+            << std::endl;
+  std::cout << "  Two fused passes: " << fusedTime << " s" << std::endl;
+
+  VTKM_TEST_ASSERT(fusedHistograms.size() == 3, "Wrong number of histograms.");
+  for (std::size_t field = 0; field < 3; ++field)
+  {
+    for (vtkm::Id bin = 0; bin < NUM_BINS; ++bin)
+    {
+      VTKM_TEST_ASSERT(
+            fusedHistograms[field].Counts[static_cast<std::size_t>(bin)] ==
+            separateHistograms[field].GetPortalConstControl().Get(bin),
+            "Fused histogram does not match separate histogram.");
+    }
+  }
+
+  std::cout << "Try log histogram" << std::endl;
+  std::vector<FieldHistogram> logHistograms =
+      FusedHistogram(3, HISTOGRAM_BINNING_LOG).Run(field3, Device());
+  VTKM_TEST_ASSERT(logHistograms.size() == 1, "Wrong number of histograms.");
+  VTKM_TEST_ASSERT(test_equal(logHistograms[0].BinEdges[1], 10.0, 0.001) &&
+                   test_equal(logHistograms[0].BinEdges[2], 100.0, 0.001),
+                   "Bad log bin edges.");
+  for (std::size_t bin = 0; bin < 3; ++bin)
+  {
+    VTKM_TEST_ASSERT(test_equal(logHistograms[0].Counts[bin],
+                                ARRAY_SIZE/3,
+                                0.001),
+                     "Bad log bin count.");
+  }
+
+  std::cout << "Try quantile histogram" << std::endl;
+  std::vector<FieldHistogram> quantileHistograms =
+      FusedHistogram(NUM_BINS, HISTOGRAM_BINNING_QUANTILE).Run(field2,
+                                                               Device());
+  vtkm::Id total = 0;
+  for (std::size_t bin = 0; bin < static_cast<std::size_t>(NUM_BINS); ++bin)
+  {
+    VTKM_TEST_ASSERT(test_equal(quantileHistograms[0].Counts[bin],
+                                ARRAY_SIZE/NUM_BINS,
+                                0.1),
+                     "Quantile bins not balanced.");
+    VTKM_TEST_ASSERT(quantileHistograms[0].BinEdges[bin] <
+                     quantileHistograms[0].BinEdges[bin+1],
+                     "Quantile bin edges not increasing.");
+    total += quantileHistograms[0].Counts[bin];
+  }
+  VTKM_TEST_ASSERT(total == ARRAY_SIZE, "Quantile histogram lost values.");
+
+  // 1001 values in 10 bins with 25 threads asks for 4*25 = 100 stripes of
+  // ceil(1001/100) = 11 values. Only ceil(1001/11) = 91 of them hold values,
+  // so the last 9 stripes are empty.
+  std::cout << "Try fused histogram with uneven stripes" << std::endl;
+  static const vtkm::Id UNEVEN_SIZE = 1001;
+  vtkm::cont::ArrayHandle<vtkm::Float32> unevenField;
+  unevenField.Allocate(UNEVEN_SIZE);
+  for (vtkm::Id index = 0; index < UNEVEN_SIZE; ++index)
+  {
+    unevenField.GetPortalControl().Set(index,
+                                       static_cast<vtkm::Float32>(index));
+  }
+  std::vector<FieldHistogram> unevenHistograms =
+      FusedHistogram(NUM_BINS, HISTOGRAM_BINNING_FIXED, 25).Run(unevenField,
+                                                                Device());
+  VTKM_TEST_ASSERT(test_equal(unevenHistograms[0].Range,
+                              vtkm::Range(0, UNEVEN_SIZE-1)),
+                   "Bad range with uneven stripes.");
+  for (std::size_t bin = 0; bin < static_cast<std::size_t>(NUM_BINS); ++bin)
+  {
+    // The maximum value is clamped into the last bin.
+    vtkm::Id expected =
+        (bin == static_cast<std::size_t>(NUM_BINS-1)) ? 101 : 100;
+    VTKM_TEST_ASSERT(unevenHistograms[0].Counts[bin] == expected,
+                     "Bad count with uneven stripes.");
+  }
+}
+
+VTKM_CONT
+static inline void TrySkewedHistogram()
+{
+  std::cout << "Try histograms of skewed data" << std::endl;
+
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  // Nine of every ten values land in the same bin, which makes the atomic
+  // adds of the shared histogram collide constantly.
+  static const vtkm::Id ARRAY_SIZE = 1000000;
+  static const vtkm::Id NUM_BINS = 16;
+  vtkm::cont::ArrayHandle<vtkm::Float32> inputArray;
+  inputArray.Allocate(ARRAY_SIZE);
+  for (vtkm::Id index = 0; index < ARRAY_SIZE; ++index)
+  {
+    vtkm::Float32 value = (index%10 == 0)
+        ? static_cast<vtkm::Float32>(index)/ARRAY_SIZE
+        : 0.5f;
+    inputArray.GetPortalControl().Set(index, value);
+  }
+
+  vtkm::Id numThreads = HistogramParallelism<Device>::Get();
+  VTKM_TEST_ASSERT(
+        (StripedHistogram::NumberOfStripes(ARRAY_SIZE, NUM_BINS, numThreads)
+         > 0) == (numThreads > 1),
+        "Skewed data should use private bins on parallel devices.");
+
+  // Run both once so that neither timing includes moving the input to the
+  // device or warming the caches.
+  SimpleHistogram::Run(inputArray, NUM_BINS, Device());
+  StripedHistogram::Run(inputArray, NUM_BINS, Device());
+
+  vtkm::cont::Timer<Device> timer;
+  vtkm::cont::ArrayHandle<vtkm::Int32> atomicHistogram =
+      SimpleHistogram::Run(inputArray, NUM_BINS, Device());
+  vtkm::Float64 atomicTime = timer.GetElapsedTime();
+
+  timer.Reset();
+  vtkm::cont::ArrayHandle<vtkm::Int32> stripedHistogram =
+      StripedHistogram::Run(inputArray, NUM_BINS, Device());
+  vtkm::Float64 stripedTime = timer.GetElapsedTime();
+
+  std::cout << "  Shared atomic bins: " << atomicTime << " s" << std::endl;
+  std::cout << "  Striped private bins: " << stripedTime << " s" << std::endl;
+
+  VTKM_TEST_ASSERT(stripedHistogram.GetNumberOfValues() == NUM_BINS,
+                   "Bad array size");
+  vtkm::Int32 total = 0;
+  for (vtkm::Id index = 0; index < NUM_BINS; ++index)
+  {
+    vtkm::Int32 binSize = stripedHistogram.GetPortalConstControl().Get(index);
+    VTKM_TEST_ASSERT(
+          binSize == atomicHistogram.GetPortalConstControl().Get(index),
+          "Striped histogram does not match atomic histogram.");
+    total += binSize;
+  }
+  VTKM_TEST_ASSERT(total == ARRAY_SIZE, "Histogram lost values.");
+}
+
 VTKM_CONT
 static inline void TrySimpleHistogram()
 {
@@ -97,6 +897,24 @@ static inline void TrySimpleHistogram()
     vtkm::Int32 binSize = histogram.GetPortalConstControl().Get(index);
     VTKM_TEST_ASSERT(binSize == 2, "Bad bin size.");
   }
+
+  // With this many bins for so few values the striped histogram falls back
+  // to the shared atomic bins.
+  VTKM_TEST_ASSERT(StripedHistogram::NumberOfStripes(ARRAY_SIZE,
+                                                     ARRAY_SIZE/2,
+                                                     4) == 0,
+                   "Small input should use shared bins.");
+  histogram = StripedHistogram::Run(inputArray,
+                                    ARRAY_SIZE/2,
+                                    VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+  for (vtkm::Id index = 0; index < histogram.GetNumberOfValues(); ++index)
+  {
+    vtkm::Int32 binSize = histogram.GetPortalConstControl().Get(index);
+    VTKM_TEST_ASSERT(binSize == 2, "Bad bin size.");
+  }
+
+  TrySkewedHistogram();
+  TryFusedHistogram();
 }
 
 int SimpleHistogram(int, char *[])
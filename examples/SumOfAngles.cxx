@@ -1,13 +1,24 @@
 #include <vtkm/worklet/DispatcherMapTopology.h>
 #include <vtkm/worklet/WorkletMapTopology.h>
 
+#include <vtkm/worklet/DispatcherMapField.h>
+#include <vtkm/worklet/WorkletMapField.h>
+
 #include <vtkm/cont/ArrayHandle.h>
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayHandleCounting.h>
+#include <vtkm/cont/ArrayHandlePermutation.h>
 #include <vtkm/cont/CellSetExplicit.h>
+#include <vtkm/cont/CellSetSingleType.h>
 #include <vtkm/cont/DataSet.h>
+#include <vtkm/cont/DataSetBuilderExplicit.h>
 #include <vtkm/cont/DataSetFieldAdd.h>
 #include <vtkm/cont/DeviceAdapter.h>
+#include <vtkm/cont/ErrorBadValue.h>
+#include <vtkm/cont/Timer.h>
 
 #include <vtkm/exec/CellEdge.h>
+#include <vtkm/exec/FunctorBase.h>
 
 #include <vtkm/Math.h>
 #include <vtkm/VectorAnalysis.h>
@@ -17,6 +28,10 @@
 
 #include <vtkm/cont/testing/Testing.h>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 struct GaussianCurvature
 {
   // This worklet computes the sum of the angles of all polygons connected
@@ -198,7 +213,801 @@ static void TrySumOfAngles()
   writer.WriteDataSet(dataSet);
 }
 
+////
+//// BEGIN-EXAMPLE MeshReorder.cxx
+////
+enum MeshOrdering
+{
+  MESH_ORDERING_MORTON,                // Z-order curve through the points
+  MESH_ORDERING_HILBERT,               // Hilbert curve through the points
+  MESH_ORDERING_REVERSE_CUTHILL_MCKEE  // Breadth first over the mesh edges
+};
+
+// Renumbers the points and cells of a mesh so that elements that are near
+// each other also have nearby indices. Worklets that gather point data
+// through the connectivity then read memory with much better locality. All
+// point and cell fields are permuted with the mesh.
+struct MeshReorder
+{
+  // Bits per axis of the space filling curve keys. Three axes fit in 32 bits.
+  static const vtkm::UInt32 CURVE_BITS = 10;
+
+  // Puts two zero bits between each of the low 10 bits of x.
+  VTKM_EXEC_CONT
+  static vtkm::UInt32 SpreadBits(vtkm::UInt32 x)
+  {
+    x &= 0x000003FF;
+    x = (x | (x << 16)) & 0x030000FF;
+    x = (x | (x <<  8)) & 0x0300F00F;
+    x = (x | (x <<  4)) & 0x030C30C3;
+    x = (x | (x <<  2)) & 0x09249249;
+    return x;
+  }
+
+  VTKM_EXEC_CONT
+  static vtkm::UInt32 MortonKey(const vtkm::Vec<vtkm::UInt32,3> &cell)
+  {
+    return SpreadBits(cell[0]) | (SpreadBits(cell[1]) << 1) |
+        (SpreadBits(cell[2]) << 2);
+  }
+
+  // Hilbert index using the transpose method in "Programming the Hilbert
+  // curve" by Skilling (AIP Conference Proceedings 707, 2004).
+  VTKM_EXEC_CONT
+  static vtkm::UInt32 HilbertKey(vtkm::Vec<vtkm::UInt32,3> x)
+  {
+    const vtkm::UInt32 m = vtkm::UInt32(1) << (CURVE_BITS - 1);
+
+    // Inverse undo excess work.
+    for (vtkm::UInt32 q = m; q > 1; q >>= 1)
+    {
+      vtkm::UInt32 p = q - 1;
+      for (vtkm::IdComponent i = 0; i < 3; ++i)
+      {
+        if (x[i] & q)
+        {
+          x[0] ^= p;
+        }
+        else
+        {
+          vtkm::UInt32 t = (x[0] ^ x[i]) & p;
+          x[0] ^= t;
+          x[i] ^= t;
+        }
+      }
+    }
+
+    // Gray encode.
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    vtkm::UInt32 t = 0;
+    for (vtkm::UInt32 q = m; q > 1; q >>= 1)
+    {
+      if (x[2] & q) { t ^= q - 1; }
+    }
+    x[0] ^= t;
+    x[1] ^= t;
+    x[2] ^= t;
+
+    // Interleave the transposed bits, most significant first.
+    vtkm::UInt32 key = 0;
+    for (vtkm::Int32 bit = CURVE_BITS - 1; bit >= 0; --bit)
+    {
+      for (vtkm::IdComponent i = 0; i < 3; ++i)
+      {
+        key = (key << 1) | ((x[i] >> bit) & 1);
+      }
+    }
+    return key;
+  }
+
+  struct PointCurveKeys : vtkm::worklet::WorkletMapField
+  {
+    typedef void ControlSignature(FieldIn<Vec3> coords, FieldOut<> keys);
+    typedef _2 ExecutionSignature(_1);
+
+    vtkm::Vec<vtkm::Float64,3> Origin;
+    vtkm::Vec<vtkm::Float64,3> Scale;
+    MeshOrdering Ordering;
+
+    VTKM_CONT
+    PointCurveKeys(const vtkm::Bounds &bounds, MeshOrdering ordering)
+      : Ordering(ordering)
+    {
+      vtkm::Float64 maxCell = static_cast<vtkm::Float64>((1 << CURVE_BITS) - 1);
+      this->Origin = vtkm::make_Vec(bounds.X.Min, bounds.Y.Min, bounds.Z.Min);
+      vtkm::Vec<vtkm::Float64,3> length = vtkm::make_Vec(bounds.X.Length(),
+                                                         bounds.Y.Length(),
+                                                         bounds.Z.Length());
+      for (vtkm::IdComponent i = 0; i < 3; ++i)
+      {
+        this->Scale[i] = (length[i] > 0) ? maxCell/length[i] : 0;
+      }
+    }
+
+    template<typename CoordType>
+    VTKM_EXEC
+    vtkm::UInt32 operator()(const CoordType &coord) const
+    {
+      vtkm::Vec<vtkm::UInt32,3> cell;
+      for (vtkm::IdComponent i = 0; i < 3; ++i)
+      {
+        cell[i] = static_cast<vtkm::UInt32>(
+              (static_cast<vtkm::Float64>(coord[i]) - this->Origin[i])*
+              this->Scale[i]);
+      }
+      return (this->Ordering == MESH_ORDERING_HILBERT)
+          ? HilbertKey(cell) : MortonKey(cell);
+    }
+  };
+
+  // Orders a cell by the lowest new index of its points, so cells follow the
+  // point order whichever way it was computed.
+  template<typename Device>
+  struct CellOrderKeys : public vtkm::exec::FunctorBase
+  {
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::PortalConst IdPortalConstType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::IdComponent>::
+        template ExecutionTypes<Device>::PortalConst NumIndicesPortalType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::Portal IdPortalType;
+
+    IdPortalConstType Offsets;
+    NumIndicesPortalType NumIndices;
+    IdPortalConstType Connectivity;
+    IdPortalConstType PointOldToNew;
+    IdPortalType Keys;
+
+    VTKM_CONT
+    CellOrderKeys(const IdPortalConstType &offsets,
+                  const NumIndicesPortalType &numIndices,
+                  const IdPortalConstType &connectivity,
+                  const IdPortalConstType &pointOldToNew,
+                  const IdPortalType &keys)
+      : Offsets(offsets),
+        NumIndices(numIndices),
+        Connectivity(connectivity),
+        PointOldToNew(pointOldToNew),
+        Keys(keys)
+    {  }
+
+    VTKM_EXEC
+    void operator()(vtkm::Id cellIndex) const
+    {
+      vtkm::Id offset = this->Offsets.Get(cellIndex);
+      vtkm::IdComponent numPoints = this->NumIndices.Get(cellIndex);
+      vtkm::Id key = this->PointOldToNew.GetNumberOfValues();
+      for (vtkm::IdComponent i = 0; i < numPoints; ++i)
+      {
+        key = vtkm::Min(key,
+                        this->PointOldToNew.Get(this->Connectivity.Get(offset+i)));
+      }
+      this->Keys.Set(cellIndex, key);
+    }
+  };
+
+  template<typename Device>
+  struct InvertPermutation : public vtkm::exec::FunctorBase
+  {
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::PortalConst IdPortalConstType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::Portal IdPortalType;
+
+    IdPortalConstType NewToOld;
+    IdPortalType OldToNew;
+
+    VTKM_CONT
+    InvertPermutation(const IdPortalConstType &newToOld,
+                      const IdPortalType &oldToNew)
+      : NewToOld(newToOld), OldToNew(oldToNew)
+    {  }
+
+    VTKM_EXEC
+    void operator()(vtkm::Id newIndex) const
+    {
+      this->OldToNew.Set(this->NewToOld.Get(newIndex), newIndex);
+    }
+  };
+
+  // Writes the point indices of each new cell, renumbered to the new points.
+  template<typename Device>
+  struct RemapConnectivity : public vtkm::exec::FunctorBase
+  {
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::PortalConst IdPortalConstType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::IdComponent>::
+        template ExecutionTypes<Device>::PortalConst NumIndicesPortalType;
+    typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::Portal IdPortalType;
+
+    IdPortalConstType CellNewToOld;
+    IdPortalConstType OldOffsets;
+    NumIndicesPortalType OldNumIndices;
+    IdPortalConstType OldConnectivity;
+    IdPortalConstType PointOldToNew;
+    IdPortalConstType NewOffsets;
+    IdPortalType NewConnectivity;
+
+    VTKM_CONT
+    RemapConnectivity(const IdPortalConstType &cellNewToOld,
+                      const IdPortalConstType &oldOffsets,
+                      const NumIndicesPortalType &oldNumIndices,
+                      const IdPortalConstType &oldConnectivity,
+                      const IdPortalConstType &pointOldToNew,
+                      const IdPortalConstType &newOffsets,
+                      const IdPortalType &newConnectivity)
+      : CellNewToOld(cellNewToOld),
+        OldOffsets(oldOffsets),
+        OldNumIndices(oldNumIndices),
+        OldConnectivity(oldConnectivity),
+        PointOldToNew(pointOldToNew),
+        NewOffsets(newOffsets),
+        NewConnectivity(newConnectivity)
+    {  }
+
+    VTKM_EXEC
+    void operator()(vtkm::Id newCellIndex) const
+    {
+      vtkm::Id oldCellIndex = this->CellNewToOld.Get(newCellIndex);
+      vtkm::Id inOffset = this->OldOffsets.Get(oldCellIndex);
+      vtkm::Id outOffset = this->NewOffsets.Get(newCellIndex);
+      vtkm::IdComponent numPoints = this->OldNumIndices.Get(oldCellIndex);
+      for (vtkm::IdComponent i = 0; i < numPoints; ++i)
+      {
+        this->NewConnectivity.Set(
+              outOffset + i,
+              this->PointOldToNew.Get(this->OldConnectivity.Get(inOffset + i)));
+      }
+    }
+  };
+
+  // Used with CastAndCall to gather any field array through a permutation.
+  template<typename Device>
+  struct PermuteArrayFunctor
+  {
+    vtkm::cont::ArrayHandle<vtkm::Id> NewToOld;
+    vtkm::cont::DynamicArrayHandle *Result;
+
+    template<typename T, typename Storage>
+    VTKM_CONT
+    void operator()(const vtkm::cont::ArrayHandle<T,Storage> &array) const
+    {
+      vtkm::cont::ArrayHandle<T> permuted;
+      vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+            vtkm::cont::make_ArrayHandlePermutation(this->NewToOld, array),
+            permuted);
+      *this->Result = vtkm::cont::DynamicArrayHandle(permuted);
+    }
+  };
+
+  template<typename Device, typename DynamicArrayType>
+  VTKM_CONT
+  static vtkm::cont::DynamicArrayHandle
+  PermuteArray(const DynamicArrayType &array,
+               const vtkm::cont::ArrayHandle<vtkm::Id> &newToOld)
+  {
+    vtkm::cont::DynamicArrayHandle result;
+    PermuteArrayFunctor<Device> functor;
+    functor.NewToOld = newToOld;
+    functor.Result = &result;
+    array.CastAndCall(functor);
+    return result;
+  }
+
+  // Reverse Cuthill-McKee is a sequential breadth first search, so it runs in
+  // the control environment.
+  VTKM_CONT
+  static vtkm::cont::ArrayHandle<vtkm::Id>
+  ReverseCuthillMcKee(const vtkm::cont::CellSetExplicit<> &cellSet)
+  {
+    vtkm::Id numPoints = cellSet.GetNumberOfPoints();
+
+    // Points are adjacent when they share a cell.
+    std::vector<std::vector<vtkm::Id> > neighbors(
+          static_cast<std::size_t>(numPoints));
+    vtkm::cont::ArrayHandle<vtkm::IdComponent>::PortalConstControl
+        numIndicesPortal =
+          cellSet.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                     vtkm::TopologyElementTagCell())
+          .GetPortalConstControl();
+    vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl connectivityPortal =
+        cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                     vtkm::TopologyElementTagCell())
+        .GetPortalConstControl();
+    vtkm::Id offset = 0;
+    for (vtkm::Id cellIndex = 0;
+         cellIndex < numIndicesPortal.GetNumberOfValues();
+         ++cellIndex)
+    {
+      vtkm::IdComponent numCellPoints = numIndicesPortal.Get(cellIndex);
+      for (vtkm::IdComponent i = 0; i < numCellPoints; ++i)
+      {
+        vtkm::Id pointI = connectivityPortal.Get(offset + i);
+        for (vtkm::IdComponent j = 0; j < numCellPoints; ++j)
+        {
+          if (i != j)
+          {
+            neighbors[static_cast<std::size_t>(pointI)].push_back(
+                  connectivityPortal.Get(offset + j));
+          }
+        }
+      }
+      offset += numCellPoints;
+    }
+    for (std::size_t pointIndex = 0; pointIndex < neighbors.size(); ++pointIndex)
+    {
+      std::vector<vtkm::Id> &list = neighbors[pointIndex];
+      std::sort(list.begin(), list.end());
+      list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+
+    struct LessDegree
+    {
+      const std::vector<std::vector<vtkm::Id> > *Neighbors;
+      bool operator()(vtkm::Id a, vtkm::Id b) const
+      {
+        std::size_t degreeA = (*this->Neighbors)[static_cast<std::size_t>(a)].size();
+        std::size_t degreeB = (*this->Neighbors)[static_cast<std::size_t>(b)].size();
+        return (degreeA < degreeB) || ((degreeA == degreeB) && (a < b));
+      }
+    };
+    LessDegree lessDegree;
+    lessDegree.Neighbors = &neighbors;
+
+    // Start each connected component from a point of lowest degree.
+    std::vector<vtkm::Id> startOrder(static_cast<std::size_t>(numPoints));
+    for (vtkm::Id pointIndex = 0; pointIndex < numPoints; ++pointIndex)
+    {
+      startOrder[static_cast<std::size_t>(pointIndex)] = pointIndex;
+    }
+    std::sort(startOrder.begin(), startOrder.end(), lessDegree);
+
+    std::vector<bool> visited(static_cast<std::size_t>(numPoints), false);
+    std::vector<vtkm::Id> order;
+    order.reserve(static_cast<std::size_t>(numPoints));
+    std::vector<vtkm::Id> nextPoints;
+    for (std::size_t startIndex = 0; startIndex < startOrder.size(); ++startIndex)
+    {
+      vtkm::Id start = startOrder[startIndex];
+      if (visited[static_cast<std::size_t>(start)]) { continue; }
+      visited[static_cast<std::size_t>(start)] = true;
+      std::size_t head = order.size();
+      order.push_back(start);
+      while (head < order.size())
+      {
+        vtkm::Id pointIndex = order[head++];
+        const std::vector<vtkm::Id> &list =
+            neighbors[static_cast<std::size_t>(pointIndex)];
+        nextPoints.clear();
+        for (std::size_t i = 0; i < list.size(); ++i)
+        {
+          if (!visited[static_cast<std::size_t>(list[i])])
+          {
+            visited[static_cast<std::size_t>(list[i])] = true;
+            nextPoints.push_back(list[i]);
+          }
+        }
+        std::sort(nextPoints.begin(), nextPoints.end(), lessDegree);
+        order.insert(order.end(), nextPoints.begin(), nextPoints.end());
+      }
+    }
+
+    vtkm::cont::ArrayHandle<vtkm::Id> newToOld;
+    newToOld.Allocate(numPoints);
+    vtkm::cont::ArrayHandle<vtkm::Id>::PortalControl newToOldPortal =
+        newToOld.GetPortalControl();
+    for (vtkm::Id newIndex = 0; newIndex < numPoints; ++newIndex)
+    {
+      newToOldPortal.Set(newIndex,
+                         order[static_cast<std::size_t>(numPoints-newIndex-1)]);
+    }
+    return newToOld;
+  }
+
+  // Gets the cell set of a data set as a CellSetExplicit<>, copying the
+  // arrays of a CellSetSingleType<> if necessary.
+  template<typename Device>
+  VTKM_CONT
+  static vtkm::cont::CellSetExplicit<>
+  GetExplicitCellSet(const vtkm::cont::DynamicCellSet &dynamicCellSet, Device)
+  {
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    if (dynamicCellSet.IsType<vtkm::cont::CellSetExplicit<> >())
+    {
+      vtkm::cont::CellSetExplicit<> cellSet;
+      dynamicCellSet.CopyTo(cellSet);
+      return cellSet;
+    }
+    if (dynamicCellSet.IsType<vtkm::cont::CellSetSingleType<> >())
+    {
+      vtkm::cont::CellSetSingleType<> singleTypeCellSet;
+      dynamicCellSet.CopyTo(singleTypeCellSet);
+      vtkm::cont::ArrayHandle<vtkm::UInt8> shapes;
+      Algorithm::Copy(
+            singleTypeCellSet.GetShapesArray(vtkm::TopologyElementTagPoint(),
+                                             vtkm::TopologyElementTagCell()),
+            shapes);
+      vtkm::cont::ArrayHandle<vtkm::IdComponent> numIndices;
+      Algorithm::Copy(
+            singleTypeCellSet.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                                 vtkm::TopologyElementTagCell()),
+            numIndices);
+      vtkm::cont::CellSetExplicit<> cellSet(singleTypeCellSet.GetName());
+      cellSet.Fill(singleTypeCellSet.GetNumberOfPoints(),
+                   shapes,
+                   numIndices,
+                   singleTypeCellSet.GetConnectivityArray(
+                     vtkm::TopologyElementTagPoint(),
+                     vtkm::TopologyElementTagCell()));
+      return cellSet;
+    }
+    throw vtkm::cont::ErrorBadValue("Mesh reorder requires an explicit cell set.");
+  }
+
+  template<typename Device>
+  VTKM_CONT
+  static vtkm::cont::DataSet Run(const vtkm::cont::DataSet &dataSetIn,
+                                 MeshOrdering ordering,
+                                 Device)
+  {
+    using Algorithm = vtkm::cont::DeviceAdapterAlgorithm<Device>;
+
+    // Other cell sets would index the old point order, and their cell fields
+    // would no longer match, so only data sets with one cell set are handled.
+    if (dataSetIn.GetNumberOfCellSets() != 1)
+    {
+      throw vtkm::cont::ErrorBadValue(
+            "Mesh reorder requires a data set with exactly one cell set.");
+    }
+
+    vtkm::cont::CellSetExplicit<> cellSet =
+        GetExplicitCellSet(dataSetIn.GetCellSet(), Device());
+    vtkm::Id numPoints = cellSet.GetNumberOfPoints();
+    vtkm::Id numCells = cellSet.GetNumberOfCells();
+
+    vtkm::cont::ArrayHandle<vtkm::UInt8> shapes =
+        cellSet.GetShapesArray(vtkm::TopologyElementTagPoint(),
+                               vtkm::TopologyElementTagCell());
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> numIndices =
+        cellSet.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                   vtkm::TopologyElementTagCell());
+    vtkm::cont::ArrayHandle<vtkm::Id> connectivity =
+        cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                     vtkm::TopologyElementTagCell());
+    vtkm::cont::ArrayHandle<vtkm::Id> offsets;
+    Algorithm::ScanExclusive(
+          vtkm::cont::make_ArrayHandleCast<vtkm::Id>(numIndices), offsets);
+
+    // New order of the points.
+    vtkm::cont::ArrayHandle<vtkm::Id> pointNewToOld;
+    if (ordering == MESH_ORDERING_REVERSE_CUTHILL_MCKEE)
+    {
+      pointNewToOld = ReverseCuthillMcKee(cellSet);
+    }
+    else
+    {
+      const vtkm::cont::CoordinateSystem &coords =
+          dataSetIn.GetCoordinateSystem();
+      vtkm::cont::ArrayHandle<vtkm::UInt32> pointKeys;
+      vtkm::worklet::DispatcherMapField<PointCurveKeys,Device>
+          dispatcher(PointCurveKeys(coords.GetBounds(), ordering));
+      dispatcher.Invoke(coords.GetData(), pointKeys);
+      Algorithm::Copy(vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numPoints),
+                      pointNewToOld);
+      Algorithm::SortByKey(pointKeys, pointNewToOld);
+    }
+
+    vtkm::cont::ArrayHandle<vtkm::Id> pointOldToNew;
+    Algorithm::Schedule(
+          InvertPermutation<Device>(
+            pointNewToOld.PrepareForInput(Device()),
+            pointOldToNew.PrepareForOutput(numPoints, Device())),
+          numPoints);
+
+    // New order of the cells.
+    vtkm::cont::ArrayHandle<vtkm::Id> cellKeys;
+    Algorithm::Schedule(
+          CellOrderKeys<Device>(offsets.PrepareForInput(Device()),
+                                numIndices.PrepareForInput(Device()),
+                                connectivity.PrepareForInput(Device()),
+                                pointOldToNew.PrepareForInput(Device()),
+                                cellKeys.PrepareForOutput(numCells, Device())),
+          numCells);
+    vtkm::cont::ArrayHandle<vtkm::Id> cellNewToOld;
+    Algorithm::Copy(vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numCells),
+                    cellNewToOld);
+    Algorithm::SortByKey(cellKeys, cellNewToOld);
+
+    // Build the reordered cell set.
+    vtkm::cont::ArrayHandle<vtkm::UInt8> newShapes;
+    Algorithm::Copy(vtkm::cont::make_ArrayHandlePermutation(cellNewToOld, shapes),
+                    newShapes);
+    vtkm::cont::ArrayHandle<vtkm::IdComponent> newNumIndices;
+    Algorithm::Copy(
+          vtkm::cont::make_ArrayHandlePermutation(cellNewToOld, numIndices),
+          newNumIndices);
+    vtkm::cont::ArrayHandle<vtkm::Id> newOffsets;
+    vtkm::Id connectivitySize = Algorithm::ScanExclusive(
+          vtkm::cont::make_ArrayHandleCast<vtkm::Id>(newNumIndices), newOffsets);
+    vtkm::cont::ArrayHandle<vtkm::Id> newConnectivity;
+    Algorithm::Schedule(
+          RemapConnectivity<Device>(
+            cellNewToOld.PrepareForInput(Device()),
+            offsets.PrepareForInput(Device()),
+            numIndices.PrepareForInput(Device()),
+            connectivity.PrepareForInput(Device()),
+            pointOldToNew.PrepareForInput(Device()),
+            newOffsets.PrepareForInput(Device()),
+            newConnectivity.PrepareForOutput(connectivitySize, Device())),
+          numCells);
+
+    vtkm::cont::CellSetExplicit<> newCellSet(cellSet.GetName());
+    newCellSet.Fill(numPoints,
+                    newShapes,
+                    newNumIndices,
+                    newConnectivity,
+                    newOffsets);
+
+    // Permute coordinates and fields to match.
+    vtkm::cont::DataSet dataSetOut;
+    dataSetOut.AddCellSet(newCellSet);
+    for (vtkm::IdComponent coordIndex = 0;
+         coordIndex < dataSetIn.GetNumberOfCoordinateSystems();
+         ++coordIndex)
+    {
+      const vtkm::cont::CoordinateSystem &coords =
+          dataSetIn.GetCoordinateSystem(coordIndex);
+      dataSetOut.AddCoordinateSystem(
+            vtkm::cont::CoordinateSystem(
+              coords.GetName(),
+              PermuteArray<Device>(coords.GetData(), pointNewToOld)));
+    }
+    for (vtkm::IdComponent fieldIndex = 0;
+         fieldIndex < dataSetIn.GetNumberOfFields();
+         ++fieldIndex)
+    {
+      const vtkm::cont::Field &field = dataSetIn.GetField(fieldIndex);
+      switch (field.GetAssociation())
+      {
+        case vtkm::cont::Field::ASSOC_POINTS:
+          dataSetOut.AddField(
+                vtkm::cont::Field(field.GetName(),
+                                  vtkm::cont::Field::ASSOC_POINTS,
+                                  PermuteArray<Device>(field.GetData(),
+                                                       pointNewToOld)));
+          break;
+        case vtkm::cont::Field::ASSOC_CELL_SET:
+          dataSetOut.AddField(
+                vtkm::cont::Field(field.GetName(),
+                                  vtkm::cont::Field::ASSOC_CELL_SET,
+                                  field.GetAssocCellSet(),
+                                  PermuteArray<Device>(field.GetData(),
+                                                       cellNewToOld)));
+          break;
+        default:
+          dataSetOut.AddField(field);
+          break;
+      }
+    }
+    return dataSetOut;
+  }
+};
+////
+//// END-EXAMPLE MeshReorder.cxx
+////
+
+// Counts the misses of a small direct mapped cache while reading the point
+// coordinates in connectivity order, which is the access pattern of a
+// topology worklet. Hardware counters are not portable, so this stands in for
+// them.
+VTKM_CONT
+static vtkm::Id EstimateCacheMisses(const vtkm::cont::CellSetExplicit<> &cellSet,
+                                    vtkm::Id bytesPerPoint,
+                                    vtkm::Id cacheBytes)
+{
+  static const vtkm::Id CACHE_LINE_BYTES = 64;
+
+  std::vector<vtkm::Id> cacheLines(
+        static_cast<std::size_t>(cacheBytes/CACHE_LINE_BYTES), -1);
+  vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl connectivityPortal =
+      cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                   vtkm::TopologyElementTagCell())
+      .GetPortalConstControl();
+
+  vtkm::Id misses = 0;
+  for (vtkm::Id index = 0; index < connectivityPortal.GetNumberOfValues(); ++index)
+  {
+    vtkm::Id line = (connectivityPortal.Get(index)*bytesPerPoint)/CACHE_LINE_BYTES;
+    vtkm::Id &slot = cacheLines[static_cast<std::size_t>(line) % cacheLines.size()];
+    if (slot != line)
+    {
+      ++misses;
+      slot = line;
+    }
+  }
+  return misses;
+}
+
+// A triangulated grid whose points and cells are numbered in random order,
+// like meshes written by many external tools.
+VTKM_CONT
+static vtkm::cont::DataSet MakeShuffledTriangleGrid(vtkm::Id dim)
+{
+  vtkm::Id numPoints = (dim+1)*(dim+1);
+  std::vector<vtkm::Id> pointOrder(static_cast<std::size_t>(numPoints));
+  for (vtkm::Id pointIndex = 0; pointIndex < numPoints; ++pointIndex)
+  {
+    pointOrder[static_cast<std::size_t>(pointIndex)] = pointIndex;
+  }
+  std::mt19937 generator(42);
+  std::shuffle(pointOrder.begin(), pointOrder.end(), generator);
+
+  std::vector<vtkm::Vec<vtkm::Float32,3> > coords(
+        static_cast<std::size_t>(numPoints));
+  for (vtkm::Id j = 0; j <= dim; ++j)
+  {
+    for (vtkm::Id i = 0; i <= dim; ++i)
+    {
+      // Add a bump so the angle sums are not all the same.
+      vtkm::Float32 x = static_cast<vtkm::Float32>(i)/static_cast<vtkm::Float32>(dim);
+      vtkm::Float32 y = static_cast<vtkm::Float32>(j)/static_cast<vtkm::Float32>(dim);
+      coords[static_cast<std::size_t>(pointOrder[static_cast<std::size_t>(j*(dim+1)+i)])] =
+          vtkm::make_Vec(x, y, 0.25f*vtkm::Sin(3.0f*x)*vtkm::Cos(5.0f*y));
+    }
+  }
+
+  std::vector<vtkm::Vec<vtkm::Id,3> > triangles;
+  for (vtkm::Id j = 0; j < dim; ++j)
+  {
+    for (vtkm::Id i = 0; i < dim; ++i)
+    {
+      vtkm::Id p0 = pointOrder[static_cast<std::size_t>(j*(dim+1)+i)];
+      vtkm::Id p1 = pointOrder[static_cast<std::size_t>(j*(dim+1)+i+1)];
+      vtkm::Id p2 = pointOrder[static_cast<std::size_t>((j+1)*(dim+1)+i)];
+      vtkm::Id p3 = pointOrder[static_cast<std::size_t>((j+1)*(dim+1)+i+1)];
+      triangles.push_back(vtkm::make_Vec(p0, p1, p3));
+      triangles.push_back(vtkm::make_Vec(p0, p3, p2));
+    }
+  }
+  std::shuffle(triangles.begin(), triangles.end(), generator);
+
+  std::vector<vtkm::UInt8> shapes(triangles.size(), vtkm::CELL_SHAPE_TRIANGLE);
+  std::vector<vtkm::IdComponent> numIndices(triangles.size(), 3);
+  std::vector<vtkm::Id> connectivity;
+  for (std::size_t cellIndex = 0; cellIndex < triangles.size(); ++cellIndex)
+  {
+    connectivity.push_back(triangles[cellIndex][0]);
+    connectivity.push_back(triangles[cellIndex][1]);
+    connectivity.push_back(triangles[cellIndex][2]);
+  }
+
+  return vtkm::cont::DataSetBuilderExplicit().Create(
+        coords, shapes, numIndices, connectivity);
+}
+
+VTKM_CONT
+static void TryMeshReorder(const std::string &name,
+                           vtkm::cont::DataSet dataSet,
+                           vtkm::Id cacheBytes)
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id BYTES_PER_POINT = 12;
+
+  std::cout << "Reordering " << name << std::endl;
+
+  // Tag every point with its index so we can tell where it went.
+  vtkm::Id numPoints = dataSet.GetCellSet().GetNumberOfPoints();
+  vtkm::cont::ArrayHandle<vtkm::Id> pointIds;
+  vtkm::cont::DeviceAdapterAlgorithm<Device>::Copy(
+        vtkm::cont::ArrayHandleCounting<vtkm::Id>(0, 1, numPoints), pointIds);
+  vtkm::cont::DataSetFieldAdd::AddPointField(dataSet, "original_id", pointIds);
+
+  vtkm::cont::CellSetExplicit<> cellSet =
+      MeshReorder::GetExplicitCellSet(dataSet.GetCellSet(), Device());
+  vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > pointCoordinates;
+  dataSet.GetCoordinateSystem().GetData().CopyTo(pointCoordinates);
+  vtkm::cont::ArrayHandle<vtkm::Float32> angleSums =
+      GaussianCurvature::Run(cellSet, pointCoordinates, Device());
+  vtkm::cont::ArrayHandle<vtkm::Float32>::PortalConstControl angleSumPortal =
+      angleSums.GetPortalConstControl();
+
+  vtkm::Id originalMisses =
+      EstimateCacheMisses(cellSet, BYTES_PER_POINT, cacheBytes);
+  std::cout << "  original: " << originalMisses << " estimated misses"
+            << std::endl;
+
+  const MeshOrdering orderings[3] = { MESH_ORDERING_MORTON,
+                                      MESH_ORDERING_HILBERT,
+                                      MESH_ORDERING_REVERSE_CUTHILL_MCKEE };
+  const char *orderingNames[3] = { "Morton", "Hilbert", "RCM" };
+  for (int orderingIndex = 0; orderingIndex < 3; ++orderingIndex)
+  {
+    vtkm::cont::Timer<Device> timer;
+    vtkm::cont::DataSet reordered =
+        MeshReorder::Run(dataSet, orderings[orderingIndex], Device());
+    vtkm::Float64 reorderTime = timer.GetElapsedTime();
+
+    vtkm::cont::CellSetExplicit<> reorderedCellSet;
+    reordered.GetCellSet().CopyTo(reorderedCellSet);
+    VTKM_TEST_ASSERT(reorderedCellSet.GetNumberOfCells() ==
+                     cellSet.GetNumberOfCells(),
+                     "Reordering changed the number of cells.");
+
+    vtkm::Id misses =
+        EstimateCacheMisses(reorderedCellSet, BYTES_PER_POINT, cacheBytes);
+    std::cout << "  " << orderingNames[orderingIndex] << ": " << misses
+              << " estimated misses ("
+              << (100*(originalMisses - misses))/vtkm::Max(originalMisses, vtkm::Id(1))
+              << "% fewer), reordered in " << reorderTime << " s" << std::endl;
+
+    // The angle sum of every point must follow the point to its new index.
+    vtkm::cont::ArrayHandle<vtkm::Vec<vtkm::Float32,3> > reorderedCoordinates;
+    reordered.GetCoordinateSystem().GetData().CopyTo(reorderedCoordinates);
+    vtkm::cont::ArrayHandle<vtkm::Float32> reorderedAngleSums =
+        GaussianCurvature::Run(reorderedCellSet, reorderedCoordinates, Device());
+    vtkm::cont::ArrayHandle<vtkm::Id> originalIds;
+    reordered.GetField("original_id").GetData().CopyTo(originalIds);
+    vtkm::cont::ArrayHandle<vtkm::Float32>::PortalConstControl reorderedPortal =
+        reorderedAngleSums.GetPortalConstControl();
+    vtkm::cont::ArrayHandle<vtkm::Id>::PortalConstControl originalIdPortal =
+        originalIds.GetPortalConstControl();
+    for (vtkm::Id pointIndex = 0; pointIndex < numPoints; ++pointIndex)
+    {
+      VTKM_TEST_ASSERT(
+            test_equal(reorderedPortal.Get(pointIndex),
+                       angleSumPortal.Get(originalIdPortal.Get(pointIndex))),
+            "Reordered mesh has different angle sums.");
+    }
+
+    if (name == "shuffled grid")
+    {
+      VTKM_TEST_ASSERT(misses < originalMisses,
+                       "Reordering did not improve a shuffled mesh.");
+    }
+  }
+}
+
+VTKM_CONT
+static void TryMeshReorder()
+{
+  // The provided meshes fit in a typical L1 cache, so they are measured
+  // against a smaller cache to show the effect of the ordering.
+  TryMeshReorder("data/cow.vtk",
+                 vtkm::io::reader::VTKDataSetReader("data/cow.vtk").ReadDataSet(),
+                 4096);
+  TryMeshReorder("data/teapot.vtk",
+                 vtkm::io::reader::VTKDataSetReader("data/teapot.vtk").ReadDataSet(),
+                 4096);
+  TryMeshReorder("shuffled grid", MakeShuffledTriangleGrid(512), 32768);
+
+  std::cout << "Reordering a data set with two cell sets" << std::endl;
+  vtkm::cont::DataSet twoCellSets = MakeShuffledTriangleGrid(4);
+  twoCellSets.AddCellSet(twoCellSets.GetCellSet());
+  bool threw = false;
+  try
+  {
+    MeshReorder::Run(twoCellSets,
+                     MESH_ORDERING_MORTON,
+                     VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+  }
+  catch (vtkm::cont::ErrorBadValue &)
+  {
+    threw = true;
+  }
+  VTKM_TEST_ASSERT(threw, "Reordering with two cell sets did not throw.");
+}
+
+VTKM_CONT
+static void Test()
+{
+  TrySumOfAngles();
+  TryMeshReorder();
+}
+
 int SumOfAngles(int, char *[])
 {
-  return vtkm::cont::testing::Testing::Run(TrySumOfAngles);
+  return vtkm::cont::testing::Testing::Run(Test);
 }
@@ -153,6 +153,11 @@ public:
         GetTriangleQualityTable().PrepareForInput(DeviceAdapterTag());
   }
 
+  VTKM_CONT
+  TriangleQualityTable(const vtkm::cont::ArrayHandle<vtkm::Float32> &table)
+    : TablePortal(table.PrepareForInput(DeviceAdapterTag()))
+  {  }
+
   template<typename T>
   VTKM_EXEC
   vtkm::Float32 GetQuality(const vtkm::Vec<T,3> &point1,
@@ -224,10 +229,77 @@ RunTriangleQuality2(vtkm::cont::DataSet dataSet,
 //// END-EXAMPLE TriangleQualityExecObject.cxx
 ////
 
+////
+//// BEGIN-EXAMPLE TriangleQualityTableCache.cxx
+////
+// Holds on to one ArrayHandle for the triangle quality table so that the
+// table's execution copy outlives any single dispatch. The first preparation
+// for a device copies the table there. Later preparations find the execution
+// copy still valid and only return a portal to it. If the table is modified
+// in the control environment, the ArrayHandle invalidates its execution copy
+// and the next preparation copies the table again.
+class TriangleQualityTableCache
+{
+public:
+  VTKM_CONT
+  TriangleQualityTableCache() : Table(GetTriangleQualityTable()) {  }
+
+  // Use this array for WholeArrayIn arguments.
+  VTKM_CONT
+  vtkm::cont::ArrayHandle<vtkm::Float32> GetTable() const
+  {
+    return this->Table;
+  }
+
+  // Use this object for ExecObject arguments.
+  template<typename DeviceAdapterTag>
+  VTKM_CONT
+  TriangleQualityTable<DeviceAdapterTag>
+  GetExecutionObject(DeviceAdapterTag) const
+  {
+    return TriangleQualityTable<DeviceAdapterTag>(this->Table);
+  }
+
+  VTKM_CONT
+  void ReleaseResources()
+  {
+    this->Table.ReleaseResourcesExecution();
+  }
+
+private:
+  vtkm::cont::ArrayHandle<vtkm::Float32> Table;
+};
+
+template<typename DeviceAdapterTag>
+VTKM_CONT
+vtkm::cont::ArrayHandle<vtkm::Float32>
+RunTriangleQuality3(vtkm::cont::DataSet dataSet,
+                    const TriangleQualityTableCache &tableCache,
+                    DeviceAdapterTag)
+{
+  vtkm::cont::ArrayHandle<vtkm::Float32> triangleQualities;
+
+  vtkm::worklet::DispatcherMapTopology<TriangleQualityWorklet2,DeviceAdapterTag>
+      dispatcher;
+  dispatcher.Invoke(dataSet.GetCellSet(),
+                    dataSet.GetCoordinateSystem().GetData(),
+                    tableCache.GetExecutionObject(DeviceAdapterTag()),
+                    triangleQualities);
+
+  return triangleQualities;
+}
+////
+//// END-EXAMPLE TriangleQualityTableCache.cxx
+////
+
 } // namespace TriangleQualityNamespace
 
+#include "BenchmarkHelpers.h"
+#include "CellSetExplicitIndex32.h"
+
 #include <vtkm/cont/ArrayHandleUniformPointCoordinates.h>
 #include <vtkm/cont/DataSetBuilderExplicit.h>
+#include <vtkm/cont/Timer.h>
 
 #include <vtkm/worklet/DispatcherMapField.h>
 #include <vtkm/worklet/WorkletMapField.h>
@@ -381,6 +453,100 @@ void CheckQualityArray(vtkm::cont::ArrayHandle<vtkm::Float32> qualities)
                    "First quality not better than last.");
 }
 
+VTKM_CONT
+void TestTriangleQualityRepeated(const vtkm::cont::DataSet &dataSet,
+                                 const TriangleQualityTableCache &tableCache)
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id NUM_REPEATS = 100;
+
+  std::cout << "Timing " << NUM_REPEATS << " repeated dispatches."
+            << std::endl;
+
+  vtkm::cont::Timer<Device> timer;
+  for (vtkm::Id repeat = 0; repeat < NUM_REPEATS; repeat++)
+  {
+    RunTriangleQuality2(dataSet, Device());
+  }
+  vtkm::Float64 uncachedTime = timer.GetElapsedTime();
+
+  timer.Reset();
+  vtkm::cont::ArrayHandle<vtkm::Float32> qualities;
+  for (vtkm::Id repeat = 0; repeat < NUM_REPEATS; repeat++)
+  {
+    qualities = RunTriangleQuality3(dataSet, tableCache, Device());
+  }
+  vtkm::Float64 cachedTime = timer.GetElapsedTime();
+
+  std::cout << "  New table each dispatch: " << uncachedTime << " s"
+            << std::endl;
+  std::cout << "  Cached table: " << cachedTime << " s" << std::endl;
+
+  CheckQualityArray(qualities);
+}
+
+VTKM_CONT
+void TestTriangleQualityIndexWidth()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+  static const vtkm::Id GRID_DIMENSION = 512;
+
+  std::cout << "Comparing 64-bit and 32-bit connectivity on "
+            << 2*GRID_DIMENSION*GRID_DIMENSION << " triangles." << std::endl;
+
+  vtkm::cont::DataSet dataSet64 = benchmark::MakeTriangleGrid(GRID_DIMENSION);
+  vtkm::cont::DataSet dataSet32 =
+      vtkm::cont::ConvertToIndex32(dataSet64, Device());
+
+  vtkm::cont::CellSetSingleType<> cellSet64;
+  dataSet64.GetCellSet().CopyTo(cellSet64);
+  vtkm::cont::CellSetSingleTypeIndex32 cellSet32;
+  dataSet32.GetCellSet().CopyTo(cellSet32);
+
+  vtkm::cont::ArrayHandle<vtkm::Float32> triangleQualityTable =
+      GetTriangleQualityTable();
+  vtkm::worklet::DispatcherMapTopology<TriangleQualityWorklet,Device>
+      dispatcher;
+
+  vtkm::cont::ArrayHandle<vtkm::Float32> qualities64;
+  vtkm::Float64 time64 = benchmark::AverageTime(
+        [&]() {
+          dispatcher.Invoke(cellSet64,
+                            dataSet64.GetCoordinateSystem().GetData(),
+                            triangleQualityTable,
+                            qualities64);
+        },
+        Device());
+  vtkm::cont::ArrayHandle<vtkm::Float32> qualities32;
+  vtkm::Float64 time32 = benchmark::AverageTime(
+        [&]() {
+          dispatcher.Invoke(cellSet32,
+                            dataSet32.GetCoordinateSystem().GetData(),
+                            triangleQualityTable,
+                            qualities32);
+        },
+        Device());
+
+  std::cout << "  64-bit indices: " << time64 << " s" << std::endl;
+  std::cout << "  32-bit indices: " << time32 << " s" << std::endl;
+
+  VTKM_TEST_ASSERT(qualities32.GetNumberOfValues() ==
+                   qualities64.GetNumberOfValues(),
+                   "Index widths give different number of qualities.");
+  vtkm::cont::ArrayHandle<vtkm::Float32>::PortalConstControl portal64 =
+      qualities64.GetPortalConstControl();
+  vtkm::cont::ArrayHandle<vtkm::Float32>::PortalConstControl portal32 =
+      qualities32.GetPortalConstControl();
+  for (vtkm::Id cellIndex = 0;
+       cellIndex < qualities64.GetNumberOfValues();
+       cellIndex++)
+  {
+    VTKM_TEST_ASSERT(test_equal(portal32.Get(cellIndex),
+                                portal64.Get(cellIndex)),
+                     "Index widths give different qualities.");
+  }
+}
+
 VTKM_CONT
 void TestTriangleQuality()
 {
@@ -406,6 +572,18 @@ void TestTriangleQuality()
             << std::endl;
   qualities = RunTriangleQuality2(dataSet, VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
   CheckQualityArray(qualities);
+
+  std::cout << "Getting triangle quality using cached table." << std::endl;
+  TriangleQualityTableCache tableCache;
+  qualities = RunTriangleQuality3(dataSet,
+                                  tableCache,
+                                  VTKM_DEFAULT_DEVICE_ADAPTER_TAG());
+  CheckQualityArray(qualities);
+
+  TestTriangleQualityRepeated(dataSet, tableCache);
+  tableCache.ReleaseResources();
+
+  TestTriangleQualityIndexWidth();
 }
 
 } // namespace TriangleQualityNamespace
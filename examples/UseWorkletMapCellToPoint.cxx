@@ -140,6 +140,331 @@ ConvertCellFieldsToPointFields(const vtkm::cont::DataSet &inData)
 //// END-EXAMPLE UseWorkletMapCellToPoint.cxx
 ////
 
+#include <vtkm/cont/ArrayHandleCast.h>
+#include <vtkm/cont/ArrayHandleConstant.h>
+#include <vtkm/cont/ArrayHandleGroupVecVariable.h>
+#include <vtkm/cont/CellSetExplicit.h>
+#include <vtkm/cont/DeviceAdapter.h>
+
+#include <vtkm/exec/AtomicArray.h>
+#include <vtkm/exec/FunctorBase.h>
+
+#include <vtkm/worklet/DispatcherMapField.h>
+#include <vtkm/worklet/WorkletMapField.h>
+
+#include <algorithm>
+#include <vector>
+
+////
+//// BEGIN-EXAMPLE ReverseConnectivity.cxx
+////
+// The cells incident on each point, grouped by point.
+struct ReverseConnectivity
+{
+  vtkm::cont::ArrayHandle<vtkm::Id> NumberOfCells;
+  vtkm::cont::ArrayHandle<vtkm::Id> Offsets;
+  vtkm::cont::ArrayHandle<vtkm::Id> CellIds;
+
+  typedef vtkm::cont::ArrayHandleGroupVecVariable<
+      vtkm::cont::ArrayHandle<vtkm::Id>,
+      vtkm::cont::ArrayHandle<vtkm::Id> > IncidentCellsArrayType;
+
+  VTKM_CONT
+  IncidentCellsArrayType GetIncidentCells() const
+  {
+    return IncidentCellsArrayType(this->CellIds, this->Offsets);
+  }
+};
+
+template<typename ConnectivityPortalType,
+         typename OffsetPortalType,
+         typename NumIndicesPortalType,
+         typename Device>
+struct ReverseConnectivityScatter : public vtkm::exec::FunctorBase
+{
+  ConnectivityPortalType Connectivity;
+  OffsetPortalType CellOffsets;
+  NumIndicesPortalType NumIndices;
+  vtkm::exec::AtomicArray<vtkm::Id,Device> PointCounters;
+
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal CellIdPortalType;
+  CellIdPortalType CellIds;
+
+  VTKM_CONT
+  ReverseConnectivityScatter(const ConnectivityPortalType &connectivity,
+                             const OffsetPortalType &cellOffsets,
+                             const NumIndicesPortalType &numIndices,
+                             vtkm::cont::ArrayHandle<vtkm::Id> pointCounters,
+                             const CellIdPortalType &cellIds)
+    : Connectivity(connectivity),
+      CellOffsets(cellOffsets),
+      NumIndices(numIndices),
+      PointCounters(pointCounters),
+      CellIds(cellIds)
+  {  }
+
+  // When there are no cell ids to write, this just counts the cells incident
+  // on each point. Otherwise, the counters hold the next free slot for each
+  // point and the cell is written there.
+  VTKM_EXEC
+  void operator()(vtkm::Id cellIndex) const
+  {
+    vtkm::Id begin = this->CellOffsets.Get(cellIndex);
+    vtkm::Id end = begin + this->NumIndices.Get(cellIndex);
+    for (vtkm::Id index = begin; index < end; ++index)
+    {
+      vtkm::Id slot = this->PointCounters.Add(this->Connectivity.Get(index), 1);
+      if (this->CellIds.GetNumberOfValues() > 0)
+      {
+        this->CellIds.Set(slot, cellIndex);
+      }
+    }
+  }
+};
+
+// Threads write the cells of a point in any order. Sorting each (short) list
+// makes the result the same on every run.
+template<typename CountPortalType,
+         typename OffsetPortalType,
+         typename CellIdPortalType>
+struct SortIncidentCells : public vtkm::exec::FunctorBase
+{
+  CountPortalType Counts;
+  OffsetPortalType Offsets;
+  CellIdPortalType CellIds;
+
+  VTKM_CONT
+  SortIncidentCells(const CountPortalType &counts,
+                    const OffsetPortalType &offsets,
+                    const CellIdPortalType &cellIds)
+    : Counts(counts), Offsets(offsets), CellIds(cellIds)
+  {  }
+
+  VTKM_EXEC
+  void operator()(vtkm::Id pointIndex) const
+  {
+    vtkm::Id begin = this->Offsets.Get(pointIndex);
+    vtkm::Id end = begin + this->Counts.Get(pointIndex);
+    for (vtkm::Id index = begin + 1; index < end; ++index)
+    {
+      vtkm::Id cellId = this->CellIds.Get(index);
+      vtkm::Id insert = index;
+      while ((insert > begin) && (this->CellIds.Get(insert-1) > cellId))
+      {
+        this->CellIds.Set(insert, this->CellIds.Get(insert-1));
+        --insert;
+      }
+      this->CellIds.Set(insert, cellId);
+    }
+  }
+};
+
+// Builds the point to cell map with a counting sort on the point ids: count
+// the cells on each point, scan the counts to get offsets, and then place
+// each cell directly in its slot. Every step is parallel.
+template<typename CellSetType, typename Device>
+VTKM_CONT
+ReverseConnectivity BuildReverseConnectivity(const CellSetType &cellSet,
+                                             Device)
+{
+  typedef vtkm::cont::DeviceAdapterAlgorithm<Device> Algorithm;
+
+  vtkm::Id numPoints = cellSet.GetNumberOfPoints();
+  vtkm::Id numCells = cellSet.GetNumberOfCells();
+
+  typedef typename CellSetType::ConnectivityArrayType ConnectivityArrayType;
+  typedef typename CellSetType::NumIndicesArrayType NumIndicesArrayType;
+  const ConnectivityArrayType &connectivity =
+      cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                   vtkm::TopologyElementTagCell());
+  const NumIndicesArrayType &numIndices =
+      cellSet.GetNumIndicesArray(vtkm::TopologyElementTagPoint(),
+                                 vtkm::TopologyElementTagCell());
+
+  vtkm::cont::ArrayHandle<vtkm::Id> cellOffsets;
+  Algorithm::ScanExclusive(vtkm::cont::make_ArrayHandleCast<vtkm::Id>(
+                             numIndices),
+                           cellOffsets);
+
+  typedef ReverseConnectivityScatter<
+      typename ConnectivityArrayType::template ExecutionTypes<Device>::PortalConst,
+      typename vtkm::cont::ArrayHandle<vtkm::Id>::
+        template ExecutionTypes<Device>::PortalConst,
+      typename NumIndicesArrayType::template ExecutionTypes<Device>::PortalConst,
+      Device> ScatterFunctor;
+
+  ReverseConnectivity reverse;
+
+  // Count the cells incident on each point.
+  Algorithm::Copy(vtkm::cont::ArrayHandleConstant<vtkm::Id>(0, numPoints),
+                  reverse.NumberOfCells);
+  vtkm::cont::ArrayHandle<vtkm::Id> noCellIds;
+  ScatterFunctor countFunctor(connectivity.PrepareForInput(Device()),
+                              cellOffsets.PrepareForInput(Device()),
+                              numIndices.PrepareForInput(Device()),
+                              reverse.NumberOfCells,
+                              noCellIds.PrepareForOutput(0, Device()));
+  Algorithm::Schedule(countFunctor, numCells);
+
+  // The scan of the counts gives where the cells of each point start.
+  vtkm::Id numEntries =
+      Algorithm::ScanExclusive(reverse.NumberOfCells, reverse.Offsets);
+
+  // Place each cell in the next free slot of each of its points.
+  vtkm::cont::ArrayHandle<vtkm::Id> nextSlot;
+  Algorithm::Copy(reverse.Offsets, nextSlot);
+  ScatterFunctor fillFunctor(connectivity.PrepareForInput(Device()),
+                             cellOffsets.PrepareForInput(Device()),
+                             numIndices.PrepareForInput(Device()),
+                             nextSlot,
+                             reverse.CellIds.PrepareForOutput(numEntries,
+                                                              Device()));
+  Algorithm::Schedule(fillFunctor, numCells);
+
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::PortalConst IdPortalConstType;
+  typedef typename vtkm::cont::ArrayHandle<vtkm::Id>::
+      template ExecutionTypes<Device>::Portal IdPortalType;
+  SortIncidentCells<IdPortalConstType,IdPortalConstType,IdPortalType>
+      sortFunctor(reverse.NumberOfCells.PrepareForInput(Device()),
+                  reverse.Offsets.PrepareForInput(Device()),
+                  reverse.CellIds.PrepareForInPlace(Device()));
+  Algorithm::Schedule(sortFunctor, numPoints);
+
+  return reverse;
+}
+////
+//// END-EXAMPLE ReverseConnectivity.cxx
+////
+
+////
+//// BEGIN-EXAMPLE ReverseConnectivityCache.cxx
+////
+// Keeps reverse connectivity for the cell sets it has seen. Cell sets and
+// data sets that share a connectivity array share the entry. Filling a cell
+// set replaces its connectivity array, which makes the old entry unreachable,
+// so an entry never describes a different topology. Call Invalidate if a
+// connectivity array is modified in place.
+class ReverseConnectivityCache
+{
+public:
+  static const std::size_t MAX_ENTRIES = 8;
+
+  template<typename CellSetType, typename Device>
+  VTKM_CONT
+  ReverseConnectivity Get(const CellSetType &cellSet, Device)
+  {
+    std::vector<Entry>::iterator entry = this->Find(cellSet);
+    if (entry != this->Entries.end())
+    {
+      return entry->Reverse;
+    }
+
+    if (this->Entries.size() >= MAX_ENTRIES)
+    {
+      // Drop the oldest entry.
+      this->Entries.erase(this->Entries.begin());
+    }
+    Entry newEntry;
+    newEntry.Connectivity =
+        cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                     vtkm::TopologyElementTagCell());
+    newEntry.NumberOfPoints = cellSet.GetNumberOfPoints();
+    newEntry.Reverse = BuildReverseConnectivity(cellSet, Device());
+    this->Entries.push_back(newEntry);
+    return newEntry.Reverse;
+  }
+
+  template<typename CellSetType>
+  VTKM_CONT
+  void Invalidate(const CellSetType &cellSet)
+  {
+    std::vector<Entry>::iterator entry = this->Find(cellSet);
+    if (entry != this->Entries.end())
+    {
+      this->Entries.erase(entry);
+    }
+  }
+
+  VTKM_CONT
+  std::size_t GetNumberOfEntries() const { return this->Entries.size(); }
+
+private:
+  struct Entry
+  {
+    vtkm::cont::ArrayHandle<vtkm::Id> Connectivity;
+    vtkm::Id NumberOfPoints;
+    ReverseConnectivity Reverse;
+  };
+  std::vector<Entry> Entries;
+
+  template<typename CellSetType>
+  VTKM_CONT
+  std::vector<Entry>::iterator Find(const CellSetType &cellSet)
+  {
+    for (std::vector<Entry>::iterator entry = this->Entries.begin();
+         entry != this->Entries.end();
+         ++entry)
+    {
+      if ((entry->Connectivity ==
+           cellSet.GetConnectivityArray(vtkm::TopologyElementTagPoint(),
+                                        vtkm::TopologyElementTagCell())) &&
+          (entry->NumberOfPoints == cellSet.GetNumberOfPoints()))
+      {
+        return entry;
+      }
+    }
+    return this->Entries.end();
+  }
+};
+
+// Averages a cell field onto points using cached reverse connectivity.
+struct AverageIncidentCells : vtkm::worklet::WorkletMapField
+{
+  typedef void ControlSignature(FieldIn<> incidentCells,
+                                WholeArrayIn<> cellField,
+                                FieldOut<> pointField);
+  typedef void ExecutionSignature(_1, _2, _3);
+  typedef _1 InputDomain;
+
+  template<typename CellIdVecType,
+           typename CellFieldPortalType,
+           typename OutType>
+  VTKM_EXEC
+  void operator()(const CellIdVecType &incidentCells,
+                  const CellFieldPortalType &cellField,
+                  OutType &average) const
+  {
+    average = OutType(0);
+    vtkm::IdComponent numCells = incidentCells.GetNumberOfComponents();
+    for (vtkm::IdComponent index = 0; index < numCells; ++index)
+    {
+      average = average + cellField.Get(incidentCells[index]);
+    }
+    average = average/static_cast<OutType>(numCells);
+  }
+};
+
+template<typename CellSetType, typename T, typename Device>
+VTKM_CONT
+vtkm::cont::ArrayHandle<T>
+AverageCellFieldCached(ReverseConnectivityCache &cache,
+                       const CellSetType &cellSet,
+                       const vtkm::cont::ArrayHandle<T> &cellField,
+                       Device)
+{
+  ReverseConnectivity reverse = cache.Get(cellSet, Device());
+
+  vtkm::cont::ArrayHandle<T> pointField;
+  vtkm::worklet::DispatcherMapField<AverageIncidentCells,Device> dispatcher;
+  dispatcher.Invoke(reverse.GetIncidentCells(), cellField, pointField);
+  return pointField;
+}
+////
+//// END-EXAMPLE ReverseConnectivityCache.cxx
+////
+
 #include <vtkm/cont/testing/MakeTestDataSet.h>
 #include <vtkm/cont/testing/Testing.h>
 
@@ -184,9 +509,120 @@ void Test()
   }
 }
 
+void TestReverseConnectivityCache()
+{
+  typedef VTKM_DEFAULT_DEVICE_ADAPTER_TAG Device;
+
+  std::cout << "Building reverse connectivity with a counting sort."
+            << std::endl;
+  vtkm::cont::DataSet inDataSet =
+      vtkm::cont::testing::MakeTestDataSet().Make3DExplicitDataSet5();
+  vtkm::cont::CellSetExplicit<> cellSet;
+  inDataSet.GetCellSet().CopyTo(cellSet);
+
+  ReverseConnectivity reverse = BuildReverseConnectivity(cellSet, Device());
+
+  // Compare with the connectivity the cell set builds itself.
+  cellSet.BuildConnectivity(Device(),
+                            vtkm::TopologyElementTagCell(),
+                            vtkm::TopologyElementTagPoint());
+  vtkm::cont::ArrayHandle<vtkm::IdComponent> expectedNumCells =
+      cellSet.GetNumIndicesArray(vtkm::TopologyElementTagCell(),
+                                 vtkm::TopologyElementTagPoint());
+  vtkm::cont::ArrayHandle<vtkm::Id> expectedCellIds =
+      cellSet.GetConnectivityArray(vtkm::TopologyElementTagCell(),
+                                   vtkm::TopologyElementTagPoint());
+  vtkm::cont::ArrayHandle<vtkm::Id> expectedOffsets =
+      cellSet.GetIndexOffsetArray(vtkm::TopologyElementTagCell(),
+                                  vtkm::TopologyElementTagPoint());
+  VTKM_TEST_ASSERT(reverse.CellIds.GetNumberOfValues() ==
+                   expectedCellIds.GetNumberOfValues(),
+                   "Wrong number of incident cells.");
+  for (vtkm::Id pointIndex = 0;
+       pointIndex < cellSet.GetNumberOfPoints();
+       pointIndex++)
+  {
+    vtkm::Id numCells =
+        expectedNumCells.GetPortalConstControl().Get(pointIndex);
+    VTKM_TEST_ASSERT(
+          reverse.NumberOfCells.GetPortalConstControl().Get(pointIndex) ==
+          numCells,
+          "Wrong number of cells on point.");
+
+    // The cell set does not promise any order for the incident cells, so
+    // sort them before comparing.
+    vtkm::Id expectedOffset =
+        expectedOffsets.GetPortalConstControl().Get(pointIndex);
+    std::vector<vtkm::Id> expectedCells;
+    for (vtkm::Id index = 0; index < numCells; index++)
+    {
+      expectedCells.push_back(
+            expectedCellIds.GetPortalConstControl().Get(expectedOffset+index));
+    }
+    std::sort(expectedCells.begin(), expectedCells.end());
+
+    vtkm::Id offset = reverse.Offsets.GetPortalConstControl().Get(pointIndex);
+    for (vtkm::Id index = 0; index < numCells; index++)
+    {
+      VTKM_TEST_ASSERT(
+            reverse.CellIds.GetPortalConstControl().Get(offset+index) ==
+            expectedCells[static_cast<std::size_t>(index)],
+            "Wrong incident cell.");
+    }
+  }
+
+  std::cout << "Averaging with cached reverse connectivity." << std::endl;
+  vtkm::cont::ArrayHandle<vtkm::Float32> cellField;
+  inDataSet.GetField("cellvar").GetData().CopyTo(cellField);
+
+  ReverseConnectivityCache cache;
+  vtkm::cont::ArrayHandle<vtkm::Float32> cachedAverage =
+      AverageCellFieldCached(cache, cellSet, cellField, Device());
+  VTKM_TEST_ASSERT(cache.GetNumberOfEntries() == 1, "Entry not cached.");
+  ReverseConnectivity cachedReverse = cache.Get(cellSet, Device());
+  VTKM_TEST_ASSERT(cache.GetNumberOfEntries() == 1, "Entry not reused.");
+
+  vtkm::cont::ArrayHandle<vtkm::Float32> expectedAverage;
+  vtkm::worklet::DispatcherMapTopology<vtkm::worklet::AverageCellField,Device>
+      dispatcher;
+  dispatcher.Invoke(cellSet, cellField, expectedAverage);
+  for (vtkm::Id pointIndex = 0;
+       pointIndex < cellSet.GetNumberOfPoints();
+       pointIndex++)
+  {
+    VTKM_TEST_ASSERT(
+          test_equal(cachedAverage.GetPortalConstControl().Get(pointIndex),
+                     expectedAverage.GetPortalConstControl().Get(pointIndex)),
+          "Cached average is wrong.");
+  }
+
+  // A copy of the cell set (as held by another data set) shares the entry.
+  vtkm::cont::CellSetExplicit<> sharedCellSet = cellSet;
+  ReverseConnectivity sharedReverse = cache.Get(sharedCellSet, Device());
+  VTKM_TEST_ASSERT(cache.GetNumberOfEntries() == 1, "Shared topology missed.");
+  VTKM_TEST_ASSERT(sharedReverse.CellIds == cachedReverse.CellIds,
+                   "Shared topology got different connectivity.");
+
+  // New topology gets a new entry, and invalidating removes it.
+  vtkm::cont::DataSet otherDataSet =
+      vtkm::cont::testing::MakeTestDataSet().Make3DExplicitDataSet5();
+  vtkm::cont::CellSetExplicit<> otherCellSet;
+  otherDataSet.GetCellSet().CopyTo(otherCellSet);
+  cache.Get(otherCellSet, Device());
+  VTKM_TEST_ASSERT(cache.GetNumberOfEntries() == 2, "New topology not added.");
+  cache.Invalidate(otherCellSet);
+  VTKM_TEST_ASSERT(cache.GetNumberOfEntries() == 1, "Entry not invalidated.");
+}
+
+void Run()
+{
+  Test();
+  TestReverseConnectivityCache();
+}
+
 } // anonymous namespace
 
 int UseWorkletMapCellToPoint(int, char *[])
 {
-  return vtkm::cont::testing::Testing::Run(Test);
+  return vtkm::cont::testing::Testing::Run(Run);
 }